@@ -1,3 +1,4 @@
+#include "arena.h"
 #include "character.h"
 #include "computer.h"
 #include "forces.h"
@@ -20,6 +21,8 @@ const size_t SCREEN_WIDTH = 1000;
 const size_t SCREEN_HEIGHT = 500;
 const double SPACING_BOUNDS = 50;
 const double ELASTICITY = 0;
+// The arena is wide and short, which suits sorting bodies along x
+const broadphase_t GAME_BROADPHASE = BROADPHASE_SWEEP_AND_PRUNE;
 
 const size_t ENEMY_WIDTH = 30;
 const size_t ENEMY_HEIGHT = 30;
@@ -189,21 +192,14 @@ void add_enemies_to_scene(state_t *state, bool is_boss, size_t init_size) {
         (rand() % ((MAX_HEIGHT - ENEMY_HEIGHT) - ENEMY_HEIGHT + 1)) +
             ENEMY_HEIGHT}; // placeholder, will add function that does
                            // not spawn enemies too close
-    list_t *vertices =
+    polygon_t *vertices =
         create_four_sided_shape(rand_center, ENEMY_WIDTH, ENEMY_HEIGHT);
-    computer_info_t *enemy_info = malloc(sizeof(computer_info_t));
-    *enemy_info = ENEMY;
     style_info_t enemy_style =
         !is_boss ? (rand() + i) % 4 + 1 : get_boss(state->wave_count);
     computer_t *enemy =
-        computer_init(state->game_scene, is_boss, enemy_style, enemy_info,
+        computer_init(state->game_scene, is_boss, enemy_style, ENEMY,
                       vertices); // CHANGE
     list_add(state->computers, enemy);
-    for (size_t j = 0; j < list_size(state->obstacles); j++) {
-      create_physics_collision(state->game_scene, ELASTICITY,
-                               get_comp_body(enemy),
-                               list_get(state->obstacles, j));
-    }
   }
 }
 
@@ -226,41 +222,37 @@ double max_enemy_to_distance(style_info_t style) {
   return max_distance;
 }
 
-void create_boundaries(scene_t *game_scene, body_t *user) {
-  // we add two tiles of infinite mass to the sides of the the demo and create a
-  // physics collision with the ball.
-  computer_info_t *info_left = malloc(sizeof(computer_info_t));
-  *info_left = OBSTACLE;
-  body_t *left_boundary =
-      body_init_with_info(create_four_sided_shape((vector_t){0, MAX_HEIGHT / 2},
-                                                  SPACING_BOUNDS, MAX_HEIGHT),
-                          INFINITY, switch_color(9), info_left, free);
-  computer_info_t *info_right = malloc(sizeof(computer_info_t));
-  *info_right = OBSTACLE;
-  body_t *right_boundary = body_init_with_info(
+void create_boundaries(scene_t *game_scene) {
+  // we add two tiles of infinite mass to the sides of the the demo, which
+  // collide with everything on the obstacle layer.
+  body_t *left_boundary = body_init_from_polygon(
+      create_four_sided_shape((vector_t){0, MAX_HEIGHT / 2}, SPACING_BOUNDS,
+                              MAX_HEIGHT),
+      INFINITY, switch_color(9), NULL, NULL);
+  body_t *right_boundary = body_init_from_polygon(
       create_four_sided_shape((vector_t){MAX_WIDTH, MAX_HEIGHT / 2},
                               SPACING_BOUNDS, MAX_HEIGHT),
-      INFINITY, switch_color(9), info_right, free);
-  computer_info_t *info_top = malloc(sizeof(computer_info_t));
-  *info_top = OBSTACLE;
-  body_t *top_boundary = body_init_with_info(
+      INFINITY, switch_color(9), NULL, NULL);
+  body_t *top_boundary = body_init_from_polygon(
       create_four_sided_shape((vector_t){MAX_WIDTH / 2, MAX_HEIGHT}, MAX_WIDTH,
                               SPACING_BOUNDS),
-      INFINITY, switch_color(9), info_top, free);
-  computer_info_t *info_bottom = malloc(sizeof(computer_info_t));
-  *info_bottom = OBSTACLE;
-  body_t *bottom_boundary =
-      body_init_with_info(create_four_sided_shape((vector_t){MAX_WIDTH / 2, 0},
-                                                  MAX_WIDTH, SPACING_BOUNDS),
-                          INFINITY, switch_color(9), info_bottom, free);
+      INFINITY, switch_color(9), NULL, NULL);
+  body_t *bottom_boundary = body_init_from_polygon(
+      create_four_sided_shape((vector_t){MAX_WIDTH / 2, 0}, MAX_WIDTH,
+                              SPACING_BOUNDS),
+      INFINITY, switch_color(9), NULL, NULL);
+  body_set_tag(left_boundary, comp_info_tag(OBSTACLE));
+  body_set_collision_layer(left_boundary, BOUNDARY_LAYER);
+  body_set_tag(right_boundary, comp_info_tag(OBSTACLE));
+  body_set_collision_layer(right_boundary, BOUNDARY_LAYER);
+  body_set_tag(top_boundary, comp_info_tag(OBSTACLE));
+  body_set_collision_layer(top_boundary, BOUNDARY_LAYER);
+  body_set_tag(bottom_boundary, comp_info_tag(OBSTACLE));
+  body_set_collision_layer(bottom_boundary, BOUNDARY_LAYER);
   scene_add_body(game_scene, left_boundary);
   scene_add_body(game_scene, right_boundary);
   scene_add_body(game_scene, top_boundary);
   scene_add_body(game_scene, bottom_boundary);
-  create_physics_collision(game_scene, ELASTICITY, user, left_boundary);
-  create_physics_collision(game_scene, ELASTICITY, user, right_boundary);
-  create_physics_collision(game_scene, ELASTICITY, user, top_boundary);
-  create_physics_collision(game_scene, ELASTICITY, user, bottom_boundary);
 }
 
 list_t *obstacle_get_corner_centroid(size_t corner) {
@@ -302,23 +294,23 @@ list_t *obstacle_get_corner_centroid(size_t corner) {
 }
 
 void build_scene_plus(state_t *state, vector_t center) {
-  computer_info_t *vertical_info = malloc(sizeof(computer_info_t));
-  *vertical_info = OBSTACLE;
-  computer_info_t *horizontal_info = malloc(sizeof(computer_info_t));
-  *horizontal_info = OBSTACLE;
   body_t *vertical =
-      body_init_with_info(create_four_sided_shape(center, 50, 150), INFINITY,
-                          switch_color(9), vertical_info, free);
+      body_init_from_polygon(create_four_sided_shape(center, 50, 150),
+                             INFINITY, switch_color(9), NULL, NULL);
   body_t *horizontal =
-      body_init_with_info(create_four_sided_shape(center, 150, 50), INFINITY,
-                          switch_color(9), horizontal_info, free);
+      body_init_from_polygon(create_four_sided_shape(center, 150, 50),
+                             INFINITY, switch_color(9), NULL, NULL);
+  body_set_tag(vertical, comp_info_tag(OBSTACLE));
+  body_set_collision_layer(vertical, OBSTACLE_LAYER);
+  body_set_tag(horizontal, comp_info_tag(OBSTACLE));
+  body_set_collision_layer(horizontal, OBSTACLE_LAYER);
   scene_add_body(state->game_scene, vertical);
   scene_add_body(state->game_scene, horizontal);
   list_add(state->obstacles, vertical);
   list_add(state->obstacles, horizontal);
 }
 
-void add_obstacles(state_t *state, body_t *user) {
+void add_obstacles(state_t *state) {
   size_t num_obstacles = 14; // abstract later
   // NULL freer below since scene frees bodies
   state->obstacles = list_init(num_obstacles, NULL);
@@ -326,19 +318,19 @@ void add_obstacles(state_t *state, body_t *user) {
   for (size_t i = 0; i < 4; i++) {
     list_t *centers = obstacle_get_corner_centroid(i);
     for (size_t i = 0; i < list_size(centers); i++) {
-      computer_info_t *corner_info = malloc(sizeof(computer_info_t));
-      *corner_info = OBSTACLE;
       vector_t *center = (vector_t *)list_get(centers, i);
       body_t *obstacle;
       if (i == 0) {
         obstacle =
-            body_init_with_info(create_four_sided_shape(*center, 200, 50),
-                                INFINITY, switch_color(9), corner_info, free);
+            body_init_from_polygon(create_four_sided_shape(*center, 200, 50),
+                                   INFINITY, switch_color(9), NULL, NULL);
       } else {
         obstacle =
-            body_init_with_info(create_four_sided_shape(*center, 50, 200),
-                                INFINITY, switch_color(9), corner_info, free);
+            body_init_from_polygon(create_four_sided_shape(*center, 50, 200),
+                                   INFINITY, switch_color(9), NULL, NULL);
       }
+      body_set_tag(obstacle, comp_info_tag(OBSTACLE));
+      body_set_collision_layer(obstacle, OBSTACLE_LAYER);
       scene_add_body(state->game_scene, obstacle);
       list_add(state->obstacles, obstacle);
     }
@@ -348,51 +340,72 @@ void add_obstacles(state_t *state, body_t *user) {
   build_scene_plus(state, (vector_t){550, 500});
   build_scene_plus(state, (vector_t){1450, 500});
   // BUILD TOP AND BOTTOM BOXES
-  computer_info_t *top_info = malloc(sizeof(computer_info_t));
-  *top_info = OBSTACLE;
-  computer_info_t *bottom_info = malloc(sizeof(computer_info_t));
-  *bottom_info = OBSTACLE;
-  body_t *top = body_init_with_info(
+  body_t *top = body_init_from_polygon(
       create_four_sided_shape((vector_t){1000, 800}, 200, 200), INFINITY,
-      switch_color(9), top_info, free);
-  body_t *bottom = body_init_with_info(
+      switch_color(9), NULL, NULL);
+  body_t *bottom = body_init_from_polygon(
       create_four_sided_shape((vector_t){1000, 200}, 200, 200), INFINITY,
-      switch_color(9), bottom_info, free);
+      switch_color(9), NULL, NULL);
+  body_set_tag(top, comp_info_tag(OBSTACLE));
+  body_set_collision_layer(top, OBSTACLE_LAYER);
+  body_set_tag(bottom, comp_info_tag(OBSTACLE));
+  body_set_collision_layer(bottom, OBSTACLE_LAYER);
   scene_add_body(state->game_scene, top);
   scene_add_body(state->game_scene, bottom);
   list_add(state->obstacles, top);
   list_add(state->obstacles, bottom);
-  for (size_t i = 0; i < list_size(state->obstacles); i++) {
-    create_physics_collision(state->game_scene, ELASTICITY, user,
-                             list_get(state->obstacles, i));
-  }
+}
+
+/**
+ * Registers every collision in the game scene once, by collision layer, so
+ * that bodies only need to be placed on the right layer when they are added.
+ */
+void add_layer_collisions(scene_t *game_scene) {
+  create_layer_physics_collision(game_scene, ELASTICITY, CHARACTER_LAYER,
+                                 OBSTACLE_LAYER);
+  create_layer_physics_collision(game_scene, ELASTICITY, ENEMY_LAYER,
+                                 OBSTACLE_LAYER);
+  // Enemies are kept inside the arena by computer_keep_within_boundaries()
+  create_layer_physics_collision(game_scene, ELASTICITY, CHARACTER_LAYER,
+                                 BOUNDARY_LAYER);
+  create_layer_solo_destructive_collision(game_scene, OBSTACLE_LAYER,
+                                          PLAYER_BULLET_LAYER);
+  create_layer_solo_destructive_collision(game_scene, OBSTACLE_LAYER,
+                                          ENEMY_BULLET_LAYER);
+  create_layer_solo_destructive_collision(game_scene, BOUNDARY_LAYER,
+                                          PLAYER_BULLET_LAYER);
+  create_layer_solo_destructive_collision(game_scene, BOUNDARY_LAYER,
+                                          ENEMY_BULLET_LAYER);
+  create_layer_damaging_collision(game_scene, ENEMY_LAYER, PLAYER_BULLET_LAYER);
+  create_layer_damaging_collision(game_scene, CHARACTER_LAYER,
+                                  ENEMY_BULLET_LAYER);
+  create_shield_collisions(game_scene);
 }
 
 void game_scene_init(state_t *output) {
-  output->game_scene = scene_init();
-  computer_info_t *background_info = malloc(sizeof(computer_info_t));
-  *background_info = BACKGROUND;
-  body_t *background = body_init_with_info(
+  output->game_scene = scene_init_with_broadphase(GAME_BROADPHASE);
+  body_t *background = body_init_from_polygon(
       create_four_sided_shape(INIT_CENTER, MAX_WIDTH + SCREEN_WIDTH,
                               MAX_HEIGHT + SCREEN_HEIGHT),
-      1.0, switch_color(9), background_info, free);
+      1.0, switch_color(9), NULL, NULL);
+  body_set_tag(background, comp_info_tag(BACKGROUND));
   scene_add_body(output->game_scene, background);
-  computer_info_t *floor_info = malloc(sizeof(computer_info_t));
-  *floor_info = FLOOR;
-  body_t *floor = body_init_with_info(
+  body_t *floor = body_init_from_polygon(
       create_four_sided_shape(INIT_CENTER, MAX_WIDTH, MAX_HEIGHT), 1.0,
-      INTERNAL_BODY_COLOR, floor_info, free);
+      INTERNAL_BODY_COLOR, NULL, NULL);
+  body_set_tag(floor, comp_info_tag(FLOOR));
   scene_add_body(output->game_scene, floor);
-  computer_info_t *comp_info = malloc(sizeof(computer_info_t));
-  *comp_info = CHARACTER;
   output->user = character_init(
       output->game_scene,
-      create_four_sided_shape(INIT_CENTER, USER_WIDTH, USER_HEIGHT), comp_info,
+      create_four_sided_shape(INIT_CENTER, USER_WIDTH, USER_HEIGHT), CHARACTER,
       output->user_style); // CHARACTER
   create_drag(output->game_scene, DRAG_FACTOR,
               character_get_body(output->user));
-  create_boundaries(output->game_scene, character_get_body(output->user));
-  add_obstacles(output, character_get_body(output->user));
+  create_boundaries(output->game_scene);
+  add_obstacles(output);
+  add_layer_collisions(output->game_scene);
+  // The arena never moves, so it only needs to be indexed once
+  scene_build_static_tree(output->game_scene);
   output->wave_count = 0;
   output->wave_dmg_multiplier = 1;
   output->current_xp = 0;
@@ -401,9 +414,10 @@ void game_scene_init(state_t *output) {
 
 void pause_scene_init(state_t *output) {
   scene_t *pause_scene = scene_init();
-  list_t *background_points = create_four_sided_shape(
+  polygon_t *background_points = create_four_sided_shape(
       vec_multiply(0.5, (vector_t)INIT_CENTER), SCREEN_WIDTH, SCREEN_HEIGHT);
-  body_t *background = body_init(background_points, INFINITY, START_COLOR);
+  body_t *background = body_init_from_polygon(background_points, INFINITY,
+                                              START_COLOR, NULL, NULL);
   scene_add_body(pause_scene, background);
   output->pause_scene = pause_scene;
   output->pause_background = background;
@@ -411,9 +425,10 @@ void pause_scene_init(state_t *output) {
 
 void start_scene_init(state_t *output) {
   scene_t *start_scene = scene_init();
-  list_t *background_points = create_four_sided_shape(
+  polygon_t *background_points = create_four_sided_shape(
       vec_multiply(0.5, (vector_t)INIT_CENTER), SCREEN_WIDTH, SCREEN_HEIGHT);
-  body_t *background = body_init(background_points, INFINITY, START_COLOR);
+  body_t *background = body_init_from_polygon(background_points, INFINITY,
+                                              START_COLOR, NULL, NULL);
   scene_add_body(start_scene, background);
   output->start_scene = start_scene;
   output->start_background = background;
@@ -544,34 +559,30 @@ void game_key(char key, key_event_type_t type, double held_time,
       character_set_velocity(state->user,
                              VEC_ZERO); // SET PLAYER VELOCITY TO ZERO
       // SET BULLET VELOCITIES TO ZERO
-      list_t *pistol_bullets =
+      body_view_t pistol_bullets =
           scene_bodies_with_bullet_info(state->game_scene, PISTOL_BULLET);
-      list_t *shotgun_bullets =
+      body_view_t shotgun_bullets =
           scene_bodies_with_bullet_info(state->game_scene, SHOTGUN_BULLET);
-      list_t *assault_bullets = scene_bodies_with_bullet_info(
+      body_view_t assault_bullets = scene_bodies_with_bullet_info(
           state->game_scene, ASSAULT_RIFLE_BULLET);
-      list_t *sniper_bullets =
+      body_view_t sniper_bullets =
           scene_bodies_with_bullet_info(state->game_scene, SNIPER_BULLET);
-      for (size_t i = 0; i < list_size(pistol_bullets); i++) {
-        body_t *bullet = list_get(pistol_bullets, i);
+      for (size_t i = 0; i < pistol_bullets.size; i++) {
+        body_t *bullet = pistol_bullets.bodies[i];
         body_set_velocity(bullet, VEC_ZERO);
       }
-      for (size_t i = 0; i < list_size(shotgun_bullets); i++) {
-        body_t *bullet = list_get(shotgun_bullets, i);
+      for (size_t i = 0; i < shotgun_bullets.size; i++) {
+        body_t *bullet = shotgun_bullets.bodies[i];
         body_set_velocity(bullet, VEC_ZERO);
       }
-      for (size_t i = 0; i < list_size(assault_bullets); i++) {
-        body_t *bullet = list_get(assault_bullets, i);
+      for (size_t i = 0; i < assault_bullets.size; i++) {
+        body_t *bullet = assault_bullets.bodies[i];
         body_set_velocity(bullet, VEC_ZERO);
       }
-      for (size_t i = 0; i < list_size(sniper_bullets); i++) {
-        body_t *bullet = list_get(sniper_bullets, i);
+      for (size_t i = 0; i < sniper_bullets.size; i++) {
+        body_t *bullet = sniper_bullets.bodies[i];
         body_set_velocity(bullet, VEC_ZERO);
       }
-      list_free(pistol_bullets);
-      list_free(shotgun_bullets);
-      list_free(assault_bullets);
-      list_free(sniper_bullets);
       // SET COMPUTER VELOCITIES TO ZERO
       for (size_t i = 0; i < list_size(state->computers); i++) {
         computer_t *ai = list_get(state->computers, i);
@@ -692,40 +703,40 @@ void start_key(char key, key_event_type_t type, double held_time,
 }
 
 void process_bullet_life(state_t *current) {
-  list_t *pistol_bullets =
+  body_view_t pistol_bullets =
       scene_bodies_with_bullet_info(current->game_scene, PISTOL_BULLET);
-  list_t *shotgun_bullets =
+  body_view_t shotgun_bullets =
       scene_bodies_with_bullet_info(current->game_scene, SHOTGUN_BULLET);
-  list_t *assault_bullets =
+  body_view_t assault_bullets =
       scene_bodies_with_bullet_info(current->game_scene, ASSAULT_RIFLE_BULLET);
-  list_t *sniper_bullets =
+  body_view_t sniper_bullets =
       scene_bodies_with_bullet_info(current->game_scene, SNIPER_BULLET);
-  for (size_t i = 0; i < list_size(pistol_bullets); i++) {
-    body_t *bullet = list_get(pistol_bullets, i);
+  for (size_t i = 0; i < pistol_bullets.size; i++) {
+    body_t *bullet = pistol_bullets.bodies[i];
     vector_t bullet_velocity = body_get_velocity(bullet);
     double magnitude = vec_scalar(bullet_velocity);
     if (magnitude < BULLET_DELETE_SPEED) {
       body_remove(bullet);
     }
   }
-  for (size_t i = 0; i < list_size(shotgun_bullets); i++) {
-    body_t *bullet = list_get(shotgun_bullets, i);
+  for (size_t i = 0; i < shotgun_bullets.size; i++) {
+    body_t *bullet = shotgun_bullets.bodies[i];
     vector_t bullet_velocity = body_get_velocity(bullet);
     double magnitude = vec_scalar(bullet_velocity);
     if (magnitude < BULLET_DELETE_SPEED) {
       body_remove(bullet);
     }
   }
-  for (size_t i = 0; i < list_size(assault_bullets); i++) {
-    body_t *bullet = list_get(assault_bullets, i);
+  for (size_t i = 0; i < assault_bullets.size; i++) {
+    body_t *bullet = assault_bullets.bodies[i];
     vector_t bullet_velocity = body_get_velocity(bullet);
     double magnitude = vec_scalar(bullet_velocity);
     if (magnitude < BULLET_DELETE_SPEED) {
       body_remove(bullet);
     }
   }
-  for (size_t i = 0; i < list_size(sniper_bullets); i++) {
-    body_t *bullet = list_get(sniper_bullets, i);
+  for (size_t i = 0; i < sniper_bullets.size; i++) {
+    body_t *bullet = sniper_bullets.bodies[i];
     vector_t bullet_velocity = body_get_velocity(bullet);
     double magnitude = vec_scalar(bullet_velocity);
     if (magnitude < BULLET_DELETE_SPEED &&
@@ -735,10 +746,6 @@ void process_bullet_life(state_t *current) {
       body_remove(bullet);
     }
   }
-  list_free(pistol_bullets);
-  list_free(shotgun_bullets);
-  list_free(assault_bullets);
-  list_free(sniper_bullets);
 }
 
 void process_damages(state_t *current) {
@@ -762,15 +769,15 @@ void process_damages(state_t *current) {
       i--;
     }
   }
-  list_t *shields = scene_bodies_with_comp_info(current->game_scene, SHIELD);
-  for (size_t i = 0; i < list_size(shields); i++) {
-    body_t *shield = list_get(shields, i);
+  body_view_t shields =
+      scene_bodies_with_comp_info(current->game_scene, SHIELD);
+  for (size_t i = 0; i < shields.size; i++) {
+    body_t *shield = shields.bodies[i];
     double shield_damage = body_damage_collisions(shield);
     if (shield_damage > SHIELD_HEALTH) {
       body_remove(shield);
     }
   }
-  list_free(shields);
 }
 
 void process_gameplay(state_t *current, double tick_time) {
@@ -1118,6 +1125,7 @@ state_t *emscripten_init() {
 }
 
 void emscripten_main(state_t *current) {
+  frame_arena_reset();
   double time = time_since_last_tick(); // Should tick even while paused so
                                         // enemies don't "teleport"
   switch (current->current_scene) {
@@ -1135,8 +1143,8 @@ void emscripten_main(state_t *current) {
       process_bullet_life(current);
       scene_tick(current->game_scene, time);
       // PRINTING STATS AND TITLE
-      list_t *game_print_objects_list =
-          list_init(6, (free_func_t)SDL_print_object_free);
+      list_t *game_print_objects_list = list_init_in_arena(
+          frame_arena(), 6, (free_func_t)SDL_print_object_free);
       print_game_scene(current, game_print_objects_list);
       // RENDER SCENE
       sdl_render_scene(current->game_scene, game_print_objects_list,
@@ -1148,8 +1156,8 @@ void emscripten_main(state_t *current) {
 
   case PAUSE_SCENE: { // check order of lines here
     sdl_on_key((key_handler_t)pause_key);
-    list_t *print_objects_list =
-        list_init(10, (free_func_t)SDL_print_object_free);
+    list_t *print_objects_list = list_init_in_arena(
+        frame_arena(), 10, (free_func_t)SDL_print_object_free);
     print_pause_scene(current, print_objects_list);
     print_controls(print_objects_list);
     sdl_render_scene(current->pause_scene, print_objects_list, NULL, NULL,
@@ -1160,8 +1168,8 @@ void emscripten_main(state_t *current) {
 
   case START_SCENE: {
     sdl_on_key((key_handler_t)start_key);
-    list_t *print_objects_list =
-        list_init(3, (free_func_t)SDL_print_object_free);
+    list_t *print_objects_list = list_init_in_arena(
+        frame_arena(), 3, (free_func_t)SDL_print_object_free);
     print_start_scene(print_objects_list);
     print_controls(print_objects_list);
     sdl_render_scene(current->start_scene, print_objects_list, NULL, NULL,
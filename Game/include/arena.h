@@ -0,0 +1,72 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+/**
+ * A linear (bump) allocator.
+ * Allocating from an arena just advances a cursor, and everything allocated
+ * from it is released at once by arena_reset(). Individual allocations are
+ * never freed.
+ */
+typedef struct arena arena_t;
+
+/**
+ * Allocates memory for an empty arena.
+ * Asserts that the required memory was allocated.
+ *
+ * @param capacity the number of bytes the arena can hold before it grows
+ * @return a pointer to the newly allocated arena
+ */
+arena_t *arena_init(size_t capacity);
+
+/**
+ * Releases an arena and everything allocated from it.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_free(arena_t *arena);
+
+/**
+ * Allocates memory from an arena, suitably aligned for any type.
+ * If the arena is full, it grows by allocating another block.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param size the number of bytes to allocate
+ * @return a pointer to the allocated memory, valid until the next
+ *   arena_reset() or arena_free()
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * Releases everything allocated from an arena.
+ * If the arena had to grow since the last reset, its blocks are merged into
+ * one block large enough to hold all of them, so that a steady workload
+ * settles into a single block.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * Gets the number of bytes allocated from an arena since it was last reset.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the number of bytes in use, including alignment padding
+ */
+size_t arena_used(arena_t *arena);
+
+/**
+ * Gets the arena for temporaries that only live until the end of the
+ * current frame. It is reset at the start of every emscripten_main().
+ *
+ * @return the frame arena
+ */
+arena_t *frame_arena(void);
+
+/**
+ * Releases everything allocated from the frame arena.
+ */
+void frame_arena_reset(void);
+
+#endif // #ifndef __ARENA_H__
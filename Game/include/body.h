@@ -1,10 +1,14 @@
 #ifndef __BODY_H__
 #define __BODY_H__
 
+#include "arena.h"
 #include "color.h"
 #include "list.h"
+#include "polygon.h"
+#include "pool.h"
 #include "vector.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * A rigid body constrained to the plane.
@@ -14,6 +18,116 @@
  */
 typedef struct body body_t;
 
+/**
+ * A stable reference to a body stored in a scene.
+ * The index names a slot in the scene and the generation is bumped every time
+ * that slot is reused, so a handle to a freed body never resolves to the body
+ * that replaced it. See scene_get_body_by_handle().
+ */
+typedef struct {
+  uint32_t index;
+  uint32_t generation;
+} body_handle_t;
+
+/**
+ * The kinds of shape a body can have. Circles collide exactly, but still
+ * carry a polygon outline for code that reads their vertices.
+ */
+typedef enum {
+  SHAPE_POLYGON,
+  SHAPE_CIRCLE,
+} shape_kind_t;
+
+/**
+ * A read-only view of the distinct edge normals of a body's shape.
+ * Like polygon_view_t, it borrows an array owned by the body.
+ */
+typedef struct {
+  const vector_t *normals;
+  size_t size;
+} normal_view_t;
+
+/**
+ * An axis-aligned bounding box.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
+/**
+ * Checks whether two axis-aligned bounding boxes overlap.
+ * Boxes that only touch along an edge count as overlapping.
+ *
+ * @param box1 the first box
+ * @param box2 the second box
+ * @return whether the boxes share any point
+ */
+bool aabb_overlaps(aabb_t box1, aabb_t box2);
+
+/**
+ * Finds where a segment first enters an axis-aligned bounding box.
+ * The segment runs from start to start + delta, and positions along it are
+ * given as fractions of delta.
+ *
+ * @param box the box
+ * @param start the start of the segment
+ * @param delta the offset from the start of the segment to its end
+ * @param max_fraction how far along the segment to look
+ * @return the fraction at which the segment enters the box, 0 if it starts
+ *   inside it, or INFINITY if it misses the box before max_fraction
+ */
+double aabb_segment_entry(aabb_t box, vector_t start, vector_t delta,
+                          double max_fraction);
+
+/**
+ * A compact description of what a body stands for, stored inline in the
+ * body so that finding bodies of a type compares two bytes instead of
+ * following each body's info pointer.
+ * What kinds and subtypes mean is up to the game; kind 0 means untagged.
+ */
+typedef struct {
+  uint8_t kind;
+  uint8_t subtype;
+} body_tag_t;
+
+/**
+ * The tag bodies start with.
+ */
+extern const body_tag_t BODY_TAG_NONE;
+
+/**
+ * Checks whether two body tags are the same.
+ *
+ * @param tag1 the first tag
+ * @param tag2 the second tag
+ * @return whether the tags have the same kind and subtype
+ */
+bool body_tag_equals(body_tag_t tag1, body_tag_t tag2);
+
+/**
+ * The handle of a body that has not been added to a scene.
+ * No scene slot ever has generation 0.
+ */
+extern const body_handle_t BODY_HANDLE_NONE;
+
+/**
+ * The number of collision layers a body can be placed on.
+ * See scene_add_layer_force_creator().
+ */
+#define MAX_COLLISION_LAYERS 32
+
+/**
+ * The collision layer bodies start on, which no layer force creator acts on.
+ */
+#define COLLISION_LAYER_NONE 0
+
+/**
+ * The number of vertices in the polygon outline of a circular body.
+ * Small enough for the outline to be stored inside the polygon.
+ */
+#define BODY_CIRCLE_OUTLINE_VERTICES 8
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
@@ -36,6 +150,40 @@ body_t *body_init(list_t *shape, double mass, rgb_color_t color);
 body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer);
 
+/**
+ * Allocates memory for a circular body.
+ * Its shape is a regular polygon with BODY_CIRCLE_OUTLINE_VERTICES vertices
+ * inscribed in the circle, while its collisions and bounds use the circle.
+ * Otherwise acts like body_init_from_polygon().
+ *
+ * @param center the initial centroid of the body
+ * @param radius the radius of the circle
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_circle(vector_t center, double radius, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer);
+
+/**
+ * Allocates memory for a body whose shape is already a polygon_t.
+ * Acts like body_init_with_info(), but takes ownership of the polygon
+ * instead of copying a vertex list, so no per-vertex allocations are made.
+ *
+ * @param shape a polygon describing the initial shape of the body
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_from_polygon(polygon_t *shape, double mass,
+                               rgb_color_t color, void *info,
+                               free_func_t info_freer);
+
 /**
  * Releases the memory allocated for a body.
  *
@@ -43,6 +191,13 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
  */
 void body_free(body_t *body);
 
+/**
+ * Gets the statistics of the pool that all bodies are allocated from.
+ *
+ * @return the body pool's current statistics
+ */
+pool_stats_t body_get_pool_stats(void);
+
 /**
  * Gets the current shape of a body.
  * Returns a newly allocated vector list, which must be list_free()d.
@@ -52,6 +207,69 @@ void body_free(body_t *body);
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets the current shape of a body as a vector list allocated from an arena,
+ * such as frame_arena() for a copy that only lives until the end of the
+ * frame. The list is only valid until the arena is reset or freed, and
+ * freeing it with list_free() is optional.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param arena the arena to allocate the list and its vectors from
+ * @return the polygon describing the body's current position
+ */
+list_t *body_get_shape_in_arena(body_t *body, arena_t *arena);
+
+/**
+ * Gets a read-only view of the current shape of a body without copying it.
+ * The view is only valid until the body is moved, rotated or freed,
+ * so it should not be kept across ticks.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a view of the polygon describing the body's current position
+ */
+polygon_view_t body_get_shape_view(body_t *body);
+
+/**
+ * Gets the distinct edge normals of a body's current shape, for separating
+ * axis tests. Parallel edges share one normal, so a rectangle has two.
+ * The normals are computed once and only re-rotated when the body rotates.
+ * The view is only valid until the body is rotated or freed.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a view of the body's unit edge normals
+ */
+normal_view_t body_get_normals(body_t *body);
+
+/**
+ * Gets the current shape of a body as a contiguous polygon.
+ * Returns a newly allocated polygon, which must be polygon_free()d.
+ * Prefer body_get_shape_view() unless the copy is going to be modified.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the polygon describing the body's current position
+ */
+polygon_t *body_get_polygon(body_t *body);
+
+/**
+ * Gets an axis-aligned box that contains a body's current shape.
+ * The box is maintained as the body moves and rotates, so this is O(1).
+ * It is exact while the body is unrotated and may be slightly larger
+ * otherwise.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a box containing every vertex of the body
+ */
+aabb_t body_get_aabb(body_t *body);
+
+/**
+ * Gets the radius of the smallest circle around a body's centroid
+ * that contains its shape. This does not change as the body rotates.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the largest distance from the centroid to a vertex
+ */
+double body_get_bounding_radius(body_t *body);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -185,6 +403,118 @@ void body_remove(body_t *body);
  */
 bool body_is_removed(body_t *body);
 
+/**
+ * Gets the handle the scene assigned to a body when it was added.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's handle, or BODY_HANDLE_NONE if it is not in a scene
+ */
+body_handle_t body_get_handle(body_t *body);
+
+/**
+ * Records the handle a scene assigned to a body.
+ * Only the scene should call this, from scene_add_body().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param handle the slot the body occupies in its scene
+ */
+void body_set_handle(body_t *body, body_handle_t handle);
+
+/**
+ * Gets the kind of shape a body has.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return SHAPE_CIRCLE if the body came from body_init_circle(),
+ *   and SHAPE_POLYGON otherwise
+ */
+shape_kind_t body_get_shape_kind(body_t *body);
+
+/**
+ * Gets the radius of a circular body.
+ *
+ * @param body a pointer to a body returned from body_init_circle()
+ * @return the body's radius, or 0 if it is not a circle
+ */
+double body_get_radius(body_t *body);
+
+/**
+ * Gets the collision layer a body is on.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's layer, or COLLISION_LAYER_NONE if it was never set
+ */
+size_t body_get_collision_layer(body_t *body);
+
+/**
+ * Places a body on a collision layer, so that the layer force creators
+ * registered for that layer act on it.
+ * Asserts that the layer is less than MAX_COLLISION_LAYERS.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param layer the layer to place the body on
+ */
+void body_set_collision_layer(body_t *body, size_t layer);
+
+/**
+ * Gets the tag describing what a body stands for.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's tag, or BODY_TAG_NONE if it was never set
+ */
+body_tag_t body_get_tag(body_t *body);
+
+/**
+ * Tags a body with what it stands for. This should be done as the body is
+ * created: a scene files its bodies by tag when they are added
+ * (see scene_bodies_with_tag()), so changing the tag afterwards has no
+ * effect on the scene.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param tag the body's new tag
+ */
+void body_set_tag(body_t *body, body_tag_t tag);
+
+/**
+ * Returns whether a body is swept along its path each tick, rather than
+ * only tested where it ends up. See body_set_continuous().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether body_set_continuous() last marked the body continuous
+ */
+bool body_is_continuous(body_t *body);
+
+/**
+ * Marks a body as a fast mover. A continuous body is tested for collisions
+ * along the whole path its last body_tick() moved it, so it cannot pass
+ * through thin bodies between ticks. This costs more than a normal test,
+ * so it should be kept for small, fast bodies such as bullets.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param continuous whether to sweep the body along its path
+ */
+void body_set_continuous(body_t *body, bool continuous);
+
+/**
+ * Gets how far the last body_tick() moved a body.
+ * Moving the body any other way, such as with body_set_centroid(),
+ * resets this to VEC_ZERO.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the change in the body's centroid over its last tick
+ */
+vector_t body_get_motion(body_t *body);
+
+/**
+ * Gets an axis-aligned box that contains a body over its last tick.
+ * For a continuous body, this also covers every position the body passed
+ * through since its last body_tick() started; otherwise it is the same as
+ * body_get_aabb().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a box containing the body's path over its last tick
+ */
+aabb_t body_get_swept_aabb(body_t *body);
+
 /**
  * Returns amount of damage applied to a body
  *
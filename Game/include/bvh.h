@@ -0,0 +1,103 @@
+#ifndef __BVH_H__
+#define __BVH_H__
+
+#include "body.h"
+#include <stddef.h>
+
+/**
+ * A bounding volume hierarchy over boxes that do not move.
+ * Boxes are inserted with an id and the tree is then built once, after
+ * which each query only visits the branches whose bounds it overlaps, so
+ * it takes time logarithmic in the number of boxes.
+ */
+typedef struct bvh bvh_t;
+
+/**
+ * A function called with each box in a tree that overlaps a query box.
+ *
+ * @param id the id the box was inserted with
+ * @param aux the auxiliary value passed to bvh_query()
+ */
+typedef void (*bvh_hit_handler_t)(size_t id, void *aux);
+
+/**
+ * Allocates memory for an empty tree.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated tree
+ */
+bvh_t *bvh_init(void);
+
+/**
+ * Releases the memory allocated for a tree.
+ *
+ * @param bvh a pointer to a tree returned from bvh_init()
+ */
+void bvh_free(bvh_t *bvh);
+
+/**
+ * Adds a box to a tree. It is not found by queries until bvh_build() is
+ * called again.
+ *
+ * @param bvh a pointer to a tree returned from bvh_init()
+ * @param id an id to report the box by
+ * @param box the box to add
+ */
+void bvh_insert(bvh_t *bvh, size_t id, aabb_t box);
+
+/**
+ * Builds the tree over every box inserted so far, splitting each branch at
+ * the median box along its longer side.
+ *
+ * @param bvh a pointer to a tree returned from bvh_init()
+ */
+void bvh_build(bvh_t *bvh);
+
+/**
+ * Gets the number of boxes in a tree.
+ *
+ * @param bvh a pointer to a tree returned from bvh_init()
+ * @return the number of boxes added with bvh_insert()
+ */
+size_t bvh_size(bvh_t *bvh);
+
+/**
+ * Calls a handler once for every box in a tree that overlaps a given box.
+ * Asserts that the tree has been built since the last box was inserted.
+ *
+ * @param bvh a pointer to a tree returned from bvh_init()
+ * @param box the box to look for overlaps with
+ * @param handler the function to call with each overlapping box's id
+ * @param aux an auxiliary value to pass to the handler
+ */
+void bvh_query(bvh_t *bvh, aabb_t box, bvh_hit_handler_t handler, void *aux);
+
+/**
+ * A function called with each box a segment passes through.
+ * Returns how far along the segment is still worth searching, so that a
+ * search for the closest hit can skip every box beyond its best hit so far.
+ *
+ * @param id the id of the box
+ * @param max_fraction how far along the segment the search reaches so far
+ * @param aux the auxiliary value passed to bvh_query_segment()
+ * @return the new reach of the search, at most max_fraction
+ */
+typedef double (*bvh_segment_handler_t)(size_t id, double max_fraction,
+                                        void *aux);
+
+/**
+ * Calls a handler for boxes in a tree that a segment passes through, nearer
+ * subtrees first. Boxes the segment only enters beyond the reach the handler
+ * last returned are skipped (see aabb_segment_entry()).
+ * Asserts that the tree has been built since the last box was inserted.
+ *
+ * @param bvh a pointer to a tree returned from bvh_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param handler the function to call with each box's id
+ * @param aux an auxiliary value to pass to the handler
+ */
+void bvh_query_segment(bvh_t *bvh, vector_t start, vector_t end,
+                       bvh_segment_handler_t handler, void *aux);
+
+#endif // #ifndef __BVH_H__
@@ -49,12 +49,12 @@ extern const double USER_SPEED;
  *
  * @param scene to add character body to
  * @param vertices used to make the character body
- * @param char_info info to make character body
+ * @param char_info the type to tag the character body with
  * @param style in which character fights
  * @return character_t* (a new character pointer)
  */
-character_t *character_init(scene_t *scene, list_t *vertices,
-                            computer_info_t *char_info, style_info_t style);
+character_t *character_init(scene_t *scene, polygon_t *vertices,
+                            computer_info_t char_info, style_info_t style);
 
 /**
  * Frees the character and the character's weapon
@@ -64,10 +64,12 @@ character_t *character_init(scene_t *scene, list_t *vertices,
 void character_free(character_t *character);
 
 /**
- * Returns the character's body
+ * Returns the character's body, looked up through the handle the character
+ * keeps into its scene
  *
  * @param character to get body of
- * @return body_t* that is the body pointer for the character
+ * @return body_t* that is the body pointer for the character; asserts that
+ * the body is still in the scene, so the character must not outlive it
  */
 body_t *character_get_body(character_t *character);
 
@@ -221,6 +223,14 @@ style_info_t character_style(character_t *player);
  */
 void create_shield(scene_t *scene, character_t *player);
 
+/**
+ * @brief Registers the collisions of every shield in a scene with enemies
+ * and their bullets. Called once per scene.
+ *
+ * @param scene that shields are added to
+ */
+void create_shield_collisions(scene_t *scene);
+
 /**
  * @brief Returns the weapon a character is currently holding
  *
@@ -1,9 +1,12 @@
 #ifndef __COLLISION_H__
 #define __COLLISION_H__
 
+#include "body.h"
 #include "list.h"
+#include "polygon.h"
 #include "vector.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * Represents the status of a collision between two shapes.
@@ -23,15 +26,222 @@ typedef struct {
 
 /**
  * Computes the status of the collision between two convex polygons.
- * The shapes are given as lists of vertices in counterclockwise order.
+ * The shapes are given as polygons with vertices in counterclockwise order.
  * There is an edge between each pair of consecutive vertices,
  * and one between the first vertex and the last vertex.
  *
+ * Both shapes are freed before returning.
+ *
  * @param shape1 the first shape
  * @param shape2 the second shape
  * @return whether the shapes are colliding, and if so, the collision axis.
  * The axis should be a unit vector pointing from shape1 towards shape2.
  */
-collision_info_t find_collision(list_t *shape1, list_t *shape2);
+collision_info_t find_collision(polygon_t *shape1, polygon_t *shape2);
+
+/**
+ * Computes the status of the collision between two convex polygons.
+ * Acts like find_collision(), but reads the shapes through views and does not
+ * free anything, so bodies' shapes can be tested without copying them.
+ * Edge normals are computed as they are tested, so this allocates nothing
+ * and works on polygons with any number of vertices.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @return whether the shapes are colliding, and if so, the collision axis.
+ * The axis should be a unit vector pointing from shape1 towards shape2.
+ */
+collision_info_t find_collision_views(polygon_view_t shape1,
+                                      polygon_view_t shape2);
+
+/**
+ * Computes the status of the collision between two convex polygons whose
+ * distinct edge normals are already known, such as bodies' shapes (see
+ * body_get_normals()). Acts like find_collision_views(), but only tests each
+ * direction once, so two rectangles take four axes instead of eight.
+ *
+ * @param shape1 the first shape
+ * @param normals1 the edge normals of the first shape
+ * @param shape2 the second shape
+ * @param normals2 the edge normals of the second shape
+ * @return whether the shapes are colliding, and if so, the collision axis
+ */
+collision_info_t find_collision_normals(polygon_view_t shape1,
+                                        normal_view_t normals1,
+                                        polygon_view_t shape2,
+                                        normal_view_t normals2);
+
+/**
+ * Computes the status of the collision between two circles, in closed form.
+ *
+ * @param center1 the center of the first circle
+ * @param radius1 the radius of the first circle
+ * @param center2 the center of the second circle
+ * @param radius2 the radius of the second circle
+ * @return whether the circles are colliding, and if so, the collision axis,
+ *   pointing from the first circle towards the second
+ */
+collision_info_t find_circle_collision(vector_t center1, double radius1,
+                                       vector_t center2, double radius2);
+
+/**
+ * Computes the status of the collision between a circle and a convex
+ * polygon. Only the polygon's edge normals and the direction from the circle
+ * to the polygon's nearest vertex are tested, and nothing is allocated.
+ *
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @param shape the polygon
+ * @return whether the shapes are colliding, and if so, the collision axis,
+ *   pointing from the circle towards the polygon
+ */
+collision_info_t find_circle_polygon_collision(vector_t center, double radius,
+                                               polygon_view_t shape);
+
+/**
+ * Computes the status of the collision between two bodies, using the test
+ * that matches their shape kinds (see body_get_shape_kind()).
+ * Polygons are tested with SAT, unless they have so many edges between them
+ * that GJK is cheaper (see gjk_find_collision()).
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether the bodies are colliding, and if so, the collision axis
+ */
+collision_info_t find_body_collision(body_t *body1, body_t *body2);
+
+/**
+ * Finds when a continuous body first touched another body during its last
+ * tick (see body_set_continuous()), by sweeping it back along the path
+ * body_get_motion() gives. The other body is taken to be where it is now.
+ * Polygons are swept exactly; a moving circle is swept as the capsule it
+ * traces, so it may be found to touch a polygon's corner slightly early.
+ *
+ * @param body1 the moving body
+ * @param body2 the body it may have hit
+ * @return the fraction of body1's last motion it had travelled when the
+ *   bodies first touched, from 0 to 1, or INFINITY if they never touched
+ */
+double find_body_time_of_impact(body_t *body1, body_t *body2);
+
+/**
+ * Checks whether a body's shape overlaps a circle.
+ *
+ * @param body the body
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @return whether the body and the circle share any point
+ */
+bool find_body_circle_overlap(body_t *body, vector_t center, double radius);
+
+/**
+ * Finds where a segment first enters a body's shape.
+ * The segment runs from start to start + delta, and positions along it are
+ * given as fractions of delta. A segment that starts inside the body does
+ * not hit it, so rays cast from inside a body see past it.
+ *
+ * @param body the body
+ * @param start the start of the segment
+ * @param delta the offset from the start of the segment to its end
+ * @param max_fraction how far along the segment to look
+ * @param normal where to store the unit normal of the body's surface where
+ *   the segment enters it
+ * @return the fraction at which the segment enters the body,
+ *   or INFINITY if it does not before max_fraction
+ */
+double find_body_segment_hit(body_t *body, vector_t start, vector_t delta,
+                             double max_fraction, vector_t *normal);
+
+/** The most points a contact manifold can hold */
+#define MAX_CONTACT_POINTS 2
+
+/**
+ * The contact between two colliding shapes, for a solver to resolve.
+ * Two shapes resting edge to edge touch along a segment, which is described
+ * by its two ends; otherwise they touch at a single point.
+ */
+typedef struct {
+  /** The unit normal of the contact, pointing from the first shape to the
+   * second */
+  vector_t normal;
+  /** How far the shapes must move apart along the normal to separate */
+  double depth;
+  /** The number of points in points, from 1 to MAX_CONTACT_POINTS */
+  size_t point_count;
+  /** Where the shapes touch, halfway through their overlap */
+  vector_t points[MAX_CONTACT_POINTS];
+  /**
+   * Identifies the edges each point came from, so a solver can match points
+   * from tick to tick. A point keeps its id while the same edges touch.
+   */
+  uint32_t features[MAX_CONTACT_POINTS];
+} contact_manifold_t;
+
+/**
+ * Computes the status of the collision between two bodies, like
+ * find_body_collision(), and if they are colliding, their contact manifold.
+ * Polygons are clipped edge against edge, so boxes resting flat on each
+ * other get two contact points.
+ * A search direction can be kept for each pair of bodies between calls, so
+ * that pairs tested with GJK which stay apart are usually ruled out at once.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param direction the pair's search direction, VEC_ZERO before the first
+ *   call; updated in place, or NULL if it is not kept
+ * @param manifold where to store the contact manifold if the bodies are
+ *   colliding, or NULL if it is not needed
+ * @return whether the bodies are colliding, and if so, the collision axis
+ */
+collision_info_t find_body_manifold(body_t *body1, body_t *body2,
+                                    vector_t *direction,
+                                    contact_manifold_t *manifold);
+
+/**
+ * The most candidate boxes find_collision_batch() can test at once,
+ * one for each bit of the mask it returns.
+ */
+#define COLLISION_BATCH_MAX 32
+
+/**
+ * A rectangle in world space, given by its center, the unit direction of
+ * its first edge, and half the lengths of its sides.
+ * This is all find_collision_batch() needs to project a box onto an axis,
+ * so boxes are tested without reading their vertices.
+ */
+typedef struct {
+  vector_t center;
+  vector_t direction;
+  double half_width;
+  double half_height;
+} collision_box_t;
+
+/**
+ * Describes a body's shape as a box, if it is a rectangle.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param box where to store the body's box
+ * @return whether the body's shape is a rectangle; if not, box is unchanged
+ */
+bool collision_box_from_body(body_t *body, collision_box_t *box);
+
+/**
+ * Tests one convex polygon against several boxes at once.
+ * Each box gives the same result as find_collision_normals() with the
+ * polygon first and the box's rectangle second, but the boxes are tested
+ * side by side, two at a time with SSE2 where the compiler targets it.
+ * The polygon's projections onto its own normals are computed only once.
+ *
+ * @param shape the polygon
+ * @param normals the edge normals of the polygon (see body_get_normals())
+ * @param boxes the candidate boxes
+ * @param count the number of boxes, at most COLLISION_BATCH_MAX
+ * @param axes an array of count axes; the collision axis of each box that
+ *   collides with the shape is stored at its index
+ * @return a mask with bit i set if boxes[i] collides with the shape
+ */
+uint32_t find_collision_batch(polygon_view_t shape, normal_view_t normals,
+                              const collision_box_t *boxes, size_t count,
+                              vector_t *axes);
 
 #endif // #ifndef __COLLISION_H__
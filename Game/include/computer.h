@@ -47,12 +47,12 @@ extern const double STANDARD_BULLET_MASS;
  * @param is_boss bool denoting whether the computer is to be initialized as a
  * boss
  * @param style specific type of enemy that will be spawned into scene.
- * @param type_of_comp will be set to ENEMY for enemy AI.
+ * @param type_of_comp the type to tag the body with; ENEMY for enemy AI.
  * @param vertices vertices of the computer that will be used for generation
  * @return computer_t*
  */
 computer_t *computer_init(scene_t *scene, bool is_boss, style_info_t style,
-                          computer_info_t *type_of_comp, list_t *vertices);
+                          computer_info_t type_of_comp, polygon_t *vertices);
 
 /**
  * @brief Checks whether an enemy is a boss
@@ -113,7 +113,8 @@ vector_t computer_vector_facing(computer_t *ai);
  * body
  *
  * @param ai comouter that has the body
- * @return body_t*
+ * @return body_t* looked up through the computer's handle; asserts that the
+ * body is still in the scene, so the computer must be freed along with it
  */
 body_t *get_comp_body(computer_t *ai);
 
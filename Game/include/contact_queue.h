@@ -0,0 +1,51 @@
+#ifndef __CONTACT_QUEUE_H__
+#define __CONTACT_QUEUE_H__
+
+#include "body.h"
+#include "collision.h"
+#include <stddef.h>
+
+/**
+ * A queue of contacts the narrowphase found, waiting to be separated.
+ * Every contact of a tick is found before any of them is separated, so
+ * the result does not depend on which pair was tested first.
+ */
+typedef struct contact_queue contact_queue_t;
+
+/**
+ * Allocates memory for an empty contact queue.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated queue
+ */
+contact_queue_t *contact_queue_init(void);
+
+/**
+ * Releases the memory allocated for a contact queue.
+ *
+ * @param queue a pointer to a queue returned from contact_queue_init()
+ */
+void contact_queue_free(contact_queue_t *queue);
+
+/**
+ * Queues the separation of two overlapping bodies.
+ *
+ * @param queue a pointer to a queue returned from contact_queue_init()
+ * @param body1 the body the contact normal points away from
+ * @param body2 the body the contact normal points towards
+ * @param manifold the bodies' contact (see find_body_manifold())
+ */
+void contact_queue_add(contact_queue_t *queue, body_t *body1, body_t *body2,
+                       const contact_manifold_t *manifold);
+
+/**
+ * Moves the bodies of each queued contact apart until they just touch, in
+ * the order the contacts were queued, and empties the queue.
+ * Each body moves along the contact normal in inverse proportion to its
+ * mass, so bodies of infinite mass never move.
+ *
+ * @param queue a pointer to a queue returned from contact_queue_init()
+ */
+void contact_queue_resolve(contact_queue_t *queue);
+
+#endif // #ifndef __CONTACT_QUEUE_H__
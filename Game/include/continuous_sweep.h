@@ -0,0 +1,43 @@
+#ifndef __CONTINUOUS_SWEEP_H__
+#define __CONTINUOUS_SWEEP_H__
+
+#include "body.h"
+#include "layer_table.h"
+
+/**
+ * Finds where each continuous body (see body_set_continuous()) first
+ * touched the bodies it is paired with along its last motion, and moves it
+ * back there. A fast body therefore hits the first body in its path,
+ * instead of passing through bodies thinner than the distance it moves.
+ * Bodies are tracked by the index of their handle, so they must be in a
+ * scene.
+ */
+typedef struct continuous_sweep continuous_sweep_t;
+
+/**
+ * Allocates memory for a continuous sweep.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated sweep
+ */
+continuous_sweep_t *continuous_sweep_init(void);
+
+/**
+ * Releases the memory allocated for a continuous sweep.
+ *
+ * @param sweep a pointer to a sweep returned from continuous_sweep_init()
+ */
+void continuous_sweep_free(continuous_sweep_t *sweep);
+
+/**
+ * Moves each continuous body in a set of pairs back along its last motion
+ * to where it first touched the other body of any of its pairs, just past
+ * the point of contact. The pairs should come from the bodies' swept boxes
+ * (see body_get_swept_aabb()), so that no impact along the way is missed.
+ *
+ * @param sweep a pointer to a sweep returned from continuous_sweep_init()
+ * @param pairs the pairs of bodies to look for impacts between
+ */
+void continuous_sweep_run(continuous_sweep_t *sweep, body_pair_view_t pairs);
+
+#endif // #ifndef __CONTINUOUS_SWEEP_H__
@@ -0,0 +1,61 @@
+#ifndef __EVENT_QUEUE_H__
+#define __EVENT_QUEUE_H__
+
+#include "body.h"
+#include <stddef.h>
+
+/**
+ * A function which responds to an event between two bodies, such as a
+ * collision. See scene_queue_event().
+ */
+typedef void (*event_handler_t)(body_t *body1, body_t *body2, vector_t axis,
+                                void *aux);
+
+/**
+ * A queue of events waiting to be dispatched to their handlers.
+ * Events run in batches by handler, so each handler's code and data stay
+ * in cache while it runs.
+ */
+typedef struct event_queue event_queue_t;
+
+/**
+ * Allocates memory for an empty event queue.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated queue
+ */
+event_queue_t *event_queue_init(void);
+
+/**
+ * Releases the memory allocated for an event queue.
+ * Events still queued are dropped without running.
+ *
+ * @param queue a pointer to a queue returned from event_queue_init()
+ */
+void event_queue_free(event_queue_t *queue);
+
+/**
+ * Queues an event.
+ *
+ * @param queue a pointer to a queue returned from event_queue_init()
+ * @param handler the function to respond to the event with
+ * @param body1 the first body to pass to handler
+ * @param body2 the second body to pass to handler
+ * @param axis the axis to pass to handler
+ * @param aux an auxiliary value to pass to handler
+ */
+void event_queue_add(event_queue_t *queue, event_handler_t handler,
+                     body_t *body1, body_t *body2, vector_t axis, void *aux);
+
+/**
+ * Runs every queued event and empties the queue.
+ * Events run in batches by handler, in the order each handler was first
+ * queued, and in the order they were queued within a batch. Handlers may
+ * queue more events, which are sorted and run as a further round once the
+ * current events are done.
+ *
+ * @param queue a pointer to a queue returned from event_queue_init()
+ */
+void event_queue_dispatch(event_queue_t *queue);
+
+#endif // #ifndef __EVENT_QUEUE_H__
@@ -5,14 +5,15 @@
 
 /**
  * A function called when a collision occurs.
+ * Collision handlers are queued as scene events, so they run after every
+ * collision on the tick has been detected (see scene_queue_event()).
  * @param body1 the first body passed to create_collision()
  * @param body2 the second body passed to create_collision()
  * @param axis a unit vector pointing from body1 towards body2
  *   that defines the direction the two bodies are colliding in
  * @param aux the auxiliary value passed to create_collision()
  */
-typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
-                                    void *aux);
+typedef event_handler_t collision_handler_t;
 
 /**
  * Adds a force creator to a scene that applies gravity between two bodies.
@@ -100,7 +101,8 @@ void create_solo_destructive_collision(scene_t *scene, body_t *retained,
                                        body_t *removed);
 
 /**
- * Adds a force creator that damages a body based on the removed body's power
+ * Adds a force creator that damages a body based on the removed body's power,
+ * which is the bullet_info_t in its tag (see bullet_info_tag())
  * (Used for brawlhub game)
  *
  * @param scene to add force creator
@@ -130,4 +132,76 @@ void create_damaging_collision(scene_t *scene, body_t *damaged,
 void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
                               body_t *body2);
 
+/**
+ * Adds a layer force creator to a scene that calls a handler whenever a body
+ * on one collision layer starts colliding with a body on another.
+ * Acts like create_collision() on every such pair of bodies, including
+ * bodies added later, without registering anything per pair.
+ *
+ * @param scene the scene containing the bodies
+ * @param layer1 the layer of the bodies passed to handler as body1
+ * @param layer2 the layer of the bodies passed to handler as body2
+ * @param handler a function to call whenever the bodies collide
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void create_layer_collision(scene_t *scene, size_t layer1, size_t layer2,
+                            collision_handler_t handler, void *aux,
+                            free_func_t freer);
+
+/**
+ * Acts like create_solo_destructive_collision() on every pair of bodies on
+ * two collision layers.
+ *
+ * @param scene the scene containing the bodies
+ * @param retained_layer the layer of the bodies that survive the collision
+ * @param removed_layer the layer of the bodies removed by the collision
+ */
+void create_layer_solo_destructive_collision(scene_t *scene,
+                                             size_t retained_layer,
+                                             size_t removed_layer);
+
+/**
+ * Acts like create_damaging_collision() on every pair of bodies on two
+ * collision layers. The damage is read from the removed body's tag when
+ * the bodies collide.
+ *
+ * @param scene the scene containing the bodies
+ * @param damaged_layer the layer of the bodies to damage
+ * @param removed_layer the layer of the bodies that cause damage
+ */
+void create_layer_damaging_collision(scene_t *scene, size_t damaged_layer,
+                                     size_t removed_layer);
+
+/**
+ * Acts like create_physics_collision() on every pair of bodies on two
+ * collision layers.
+ *
+ * @param scene the scene containing the bodies
+ * @param elasticity the "coefficient of restitution" of the collisions
+ * @param layer1 the layer of the first bodies
+ * @param layer2 the layer of the second bodies
+ */
+void create_layer_physics_collision(scene_t *scene, double elasticity,
+                                    size_t layer1, size_t layer2);
+
+/**
+ * Cheaply checks whether two bodies could be touching, using their bounding
+ * circles and bounding boxes. If this returns false, the bodies are certainly
+ * not colliding; if it returns true, they may or may not be.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return false if the bodies' bounds are disjoint
+ */
+bool bodies_may_collide(body_t *body1, body_t *body2);
+
+/**
+ * Gets the statistics of the pool that the aux values of every force creator
+ * in this file are allocated from.
+ *
+ * @return the force aux pool's current statistics
+ */
+pool_stats_t forces_get_aux_pool_stats(void);
+
 #endif // #ifndef __FORCES_H__
@@ -0,0 +1,30 @@
+#ifndef __GJK_H__
+#define __GJK_H__
+
+#include "polygon.h"
+#include "vector.h"
+#include <stdbool.h>
+
+/**
+ * Tests two convex polygons for intersection with GJK, and if they
+ * intersect, finds how far they overlap with EPA.
+ * GJK walks the Minkowski difference of the shapes towards the origin using
+ * only their support points, so each iteration takes time linear in their
+ * vertex counts, however many edges they have.
+ *
+ * A direction can be kept for a pair of shapes from call to call: if the
+ * shapes were apart last time and have not moved much, the direction that
+ * separated them usually still does, and the test ends after one step.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @param direction a direction to search along first, updated to the last
+ *   direction searched; VEC_ZERO or NULL to start from the shapes' centers
+ * @param axis where to store the collision axis if the shapes intersect:
+ *   the shortest translation of shape2 away from shape1 that separates them
+ * @return whether the shapes intersect
+ */
+bool gjk_find_collision(polygon_view_t shape1, polygon_view_t shape2,
+                        vector_t *direction, vector_t *axis);
+
+#endif // #ifndef __GJK_H__
@@ -56,6 +56,31 @@ typedef enum {
   SHIELD = 6,     // REPRESENTS SHIELD TYPE
 } computer_info_t;
 
+/**
+ * Represent the kinds of body tags BRAWLHUB uses; a tag's subtype is the
+ * value of the enum its kind names (see body_set_tag())
+ *
+ */
+typedef enum {
+  COMPUTER_TAG = 1, // SUBTYPE IS A computer_info_t
+  BULLET_TAG = 2,   // SUBTYPE IS A bullet_info_t
+} tag_kind_info_t;
+
+/**
+ * Represent the collision layers of BRAWLHUB bodies; the collisions between
+ * them are registered once per scene with the create_layer_*() forces
+ *
+ */
+typedef enum {
+  CHARACTER_LAYER = 1,     // THE PLAYER'S CHARACTER
+  ENEMY_LAYER = 2,         // ENEMY COMPUTERS
+  OBSTACLE_LAYER = 3,      // OBSTACLES INSIDE THE ARENA
+  SHIELD_LAYER = 4,        // THE PLAYER'S SHIELD
+  PLAYER_BULLET_LAYER = 5, // BULLETS FIRED BY THE PLAYER
+  ENEMY_BULLET_LAYER = 6,  // BULLETS FIRED BY ENEMIES
+  BOUNDARY_LAYER = 7,      // ARENA BOUNDARIES, WHICH ENEMIES PASS THROUGH
+} collision_layer_info_t;
+
 /**
  * Represent enemy dmg multipliers
  *
@@ -0,0 +1,51 @@
+#ifndef __LAYER_BATCH_H__
+#define __LAYER_BATCH_H__
+
+#include "body.h"
+#include "layer_table.h"
+#include "pair_cache.h"
+#include <stddef.h>
+
+/**
+ * Runs the pairs of polygons a scene's broadphase reported on a tick, at
+ * least one of them a rectangle, through find_collision_batch(), grouped
+ * under whichever polygon takes part in more such pairs.
+ * A bullet paired with several enemies or obstacles is then tested against
+ * all of them at once, and only the pairs that touch reach the per-pair
+ * manifold step.
+ * Bodies are tracked by the index of their handle, so they must be in a
+ * scene.
+ */
+typedef struct layer_batch layer_batch_t;
+
+/**
+ * Allocates memory for a layer batch.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated batch
+ */
+layer_batch_t *layer_batch_init(void);
+
+/**
+ * Releases the memory allocated for a layer batch.
+ *
+ * @param batch a pointer to a batch returned from layer_batch_init()
+ */
+void layer_batch_free(layer_batch_t *batch);
+
+/**
+ * Tests each polygon paired with two or more rectangles against all of them
+ * at once, and marks the pairs it does not touch as checked and apart in a
+ * pair cache, so the force creators acting on them skip their narrowphase.
+ * A polygon with a single rectangle gains nothing from batching, so its
+ * pair is left for the force creators to test.
+ *
+ * @param batch a pointer to a batch returned from layer_batch_init()
+ * @param pairs the pairs of bodies reported this tick
+ * @param cache the pair cache to mark pairs in (see pair_cache_visit())
+ * @param tick the current tick
+ */
+void layer_batch_run(layer_batch_t *batch, body_pair_view_t pairs,
+                     pair_cache_t *cache, size_t tick);
+
+#endif // #ifndef __LAYER_BATCH_H__
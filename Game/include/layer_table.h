@@ -0,0 +1,124 @@
+#ifndef __LAYER_TABLE_H__
+#define __LAYER_TABLE_H__
+
+#include "body.h"
+#include "list.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A function which adds forces or impulses to a pair of bodies on two
+ * collision layers. See scene_add_layer_force_creator().
+ */
+typedef void (*layer_force_creator_t)(body_t *body1, body_t *body2,
+                                      void *aux);
+
+/**
+ * The layer force creators of a scene, and the pairs of bodies on their
+ * layers that the broadphase reported on the current tick.
+ * A mask per layer records which layers some force creator pairs it with,
+ * so the broadphase can skip bodies and pairs no force creator acts on.
+ */
+typedef struct layer_table layer_table_t;
+
+/**
+ * Two bodies the broadphase reported as overlapping.
+ */
+typedef struct {
+  body_t *body1;
+  body_t *body2;
+} body_pair_t;
+
+/**
+ * A read-only view of the pairs in a layer table.
+ * It is only valid until a pair is added or the pairs are cleared.
+ */
+typedef struct {
+  const body_pair_t *pairs;
+  size_t size;
+} body_pair_view_t;
+
+/**
+ * Allocates memory for a layer table with no force creators.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated table
+ */
+layer_table_t *layer_table_init(void);
+
+/**
+ * Releases the memory allocated for a layer table, and frees each force
+ * creator's auxiliary value with its freer.
+ *
+ * @param table a pointer to a table returned from layer_table_init()
+ */
+void layer_table_free(layer_table_t *table);
+
+/**
+ * Adds a force creator that acts on every pair of bodies on two layers.
+ * Asserts that both layers are valid collision layers.
+ *
+ * @param table a pointer to a table returned from layer_table_init()
+ * @param layer1 the layer of the first body passed to forcer
+ * @param layer2 the layer of the second body passed to forcer
+ * @param forcer the force creator
+ * @param aux an auxiliary value to pass to forcer
+ * @param freer if non-NULL, a function to call to free aux
+ */
+void layer_table_add_force(layer_table_t *table, size_t layer1,
+                           size_t layer2, layer_force_creator_t forcer,
+                           void *aux, free_func_t freer);
+
+/**
+ * Gets whether some force creator acts on bodies on a layer.
+ *
+ * @param table a pointer to a table returned from layer_table_init()
+ * @param layer the layer
+ * @return whether the layer is paired with any layer
+ */
+bool layer_table_has_layer(layer_table_t *table, size_t layer);
+
+/**
+ * Gets whether some force creator acts on the layers of two bodies.
+ *
+ * @param table a pointer to a table returned from layer_table_init()
+ * @param body1 one body
+ * @param body2 the other body
+ * @return whether the bodies' layers are paired
+ */
+bool layer_table_pairs_bodies(layer_table_t *table, body_t *body1,
+                              body_t *body2);
+
+/**
+ * Adds a pair of bodies for the force creators to act on this tick.
+ *
+ * @param table a pointer to a table returned from layer_table_init()
+ * @param body1 one body
+ * @param body2 the other body
+ */
+void layer_table_add_pair(layer_table_t *table, body_t *body1, body_t *body2);
+
+/**
+ * Removes every pair of bodies from a table, keeping its force creators.
+ *
+ * @param table a pointer to a table returned from layer_table_init()
+ */
+void layer_table_clear_pairs(layer_table_t *table);
+
+/**
+ * Gets the pairs of bodies in a table, in the order they were added.
+ *
+ * @param table a pointer to a table returned from layer_table_init()
+ * @return a view of the pairs
+ */
+body_pair_view_t layer_table_get_pairs(layer_table_t *table);
+
+/**
+ * Runs each force creator, in the order they were added, on every pair of
+ * bodies on its two layers, with the body on its first layer first.
+ *
+ * @param table a pointer to a table returned from layer_table_init()
+ */
+void layer_table_run(layer_table_t *table);
+
+#endif // #ifndef __LAYER_TABLE_H__
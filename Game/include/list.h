@@ -1,13 +1,22 @@
 #ifndef __LIST_H__
 #define __LIST_H__
 
+#include "arena.h"
+#include "pool.h"
 #include <stdbool.h>
 #include <stddef.h>
 
+/**
+ * The number of elements a list stores inline before it needs a separate
+ * heap array. This covers the body lists of every force creator.
+ */
+#define LIST_INLINE_CAPACITY 4
+
 /**
  * A growable array of pointers.
  * Can store values of any pointer type (e.g. vector_t*, body_t*).
  * The list automatically grows its internal array when more capacity is needed.
+ * Lists themselves are allocated from a pool.
  */
 typedef struct list list_t;
 
@@ -29,13 +38,36 @@ typedef void (*free_func_t)(void *);
  */
 list_t *list_init(size_t initial_size, free_func_t freer);
 
+/**
+ * Allocates a list and its elements array from an arena.
+ * Acts like list_init(), except the list is only valid until the arena is
+ * reset, and growing it leaves its old array behind in the arena.
+ *
+ * @param arena the arena to allocate the list from
+ * @param initial_size the number of elements to allocate space for
+ * @param freer if non-NULL, a function to call on elements in the list
+ *   in list_free()
+ * @return a pointer to the newly allocated list
+ */
+list_t *list_init_in_arena(arena_t *arena, size_t initial_size,
+                           free_func_t freer);
+
 /**
  * Releases the memory allocated for a list.
+ * For a list from list_init_in_arena(), this only calls the freer on its
+ * elements; the arena releases the list itself.
  *
  * @param list a pointer to a list returned from list_init()
  */
 void list_free(list_t *list);
 
+/**
+ * Gets the statistics of the pool that all lists are allocated from.
+ *
+ * @return the list pool's current statistics
+ */
+pool_stats_t list_get_pool_stats(void);
+
 /**
  * Gets the size of a list (the number of occupied elements).
  * Note that this is NOT the list's capacity.
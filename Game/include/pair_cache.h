@@ -0,0 +1,152 @@
+#ifndef __PAIR_CACHE_H__
+#define __PAIR_CACHE_H__
+
+#include "body.h"
+#include "collision.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A hash table of the pairs of bodies a scene's broadphase has reported,
+ * keyed by the pair's body handles in either order.
+ * Each entry remembers how the narrowphase found the pair on the last tick
+ * it was checked, so collisions can tell when pairs start and stop touching
+ * and pick up cached narrowphase data, without a force per pair of bodies.
+ * Entries live in one open-addressing array, so looking a pair up touches
+ * a single cache line in the common case.
+ */
+typedef struct pair_cache pair_cache_t;
+
+/**
+ * How a pair's contact changed on the tick it was last checked.
+ */
+typedef enum {
+  PAIR_APART,
+  PAIR_ENTER,
+  PAIR_STAY,
+  PAIR_EXIT,
+} pair_state_t;
+
+/**
+ * What a pair cache knows about a pair of bodies.
+ * The manifold and direction are relative to handle1's body first.
+ */
+typedef struct {
+  /** The handles of the pair's bodies, in the order the pair was added */
+  body_handle_t handle1;
+  body_handle_t handle2;
+  /** The last tick the pair was visited on */
+  size_t tick;
+  /** Whether the narrowphase has run on the pair this tick */
+  bool checked;
+  /** Whether the pair was touching when the narrowphase last ran on it */
+  bool touching;
+  /** Whether the pair was touching on the tick before */
+  bool was_touching;
+  /** The narrowphase's search direction (see find_body_manifold()) */
+  vector_t direction;
+  /** The pair's contact, if it is touching */
+  contact_manifold_t manifold;
+} pair_entry_t;
+
+/**
+ * A function called with each entry of a pair cache.
+ *
+ * @param entry the entry
+ * @param aux the auxiliary value passed to pair_cache_for_each()
+ */
+typedef void (*pair_visitor_t)(pair_entry_t *entry, void *aux);
+
+/**
+ * Allocates memory for an empty pair cache.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated cache
+ */
+pair_cache_t *pair_cache_init(void);
+
+/**
+ * Releases the memory allocated for a pair cache.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ */
+void pair_cache_free(pair_cache_t *cache);
+
+/**
+ * Gets the number of pairs in a cache.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @return the number of pairs
+ */
+size_t pair_cache_size(pair_cache_t *cache);
+
+/**
+ * Looks up a pair of bodies, in either order.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @param handle1 the handle of one body
+ * @param handle2 the handle of the other body
+ * @return the pair's entry, or NULL if the pair is not in the cache
+ */
+pair_entry_t *pair_cache_find(pair_cache_t *cache, body_handle_t handle1,
+                              body_handle_t handle2);
+
+/**
+ * Looks up a pair of bodies, adding it if it is new, and brings its entry
+ * up to the given tick. The first visit on a tick moves touching into
+ * was_touching, if the pair was visited on the tick before, and clears
+ * checked and touching for the narrowphase to fill in.
+ * Adding a pair can move every entry, so entry pointers are only valid
+ * until the next visit or pair_cache_remove_stale().
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @param handle1 the handle of one body
+ * @param handle2 the handle of the other body
+ * @param tick the current tick
+ * @return the pair's entry
+ */
+pair_entry_t *pair_cache_visit(pair_cache_t *cache, body_handle_t handle1,
+                               body_handle_t handle2, size_t tick);
+
+/**
+ * Brings an entry already in a cache up to the given tick, exactly as
+ * pair_cache_visit() would, without looking it up. It never adds or moves
+ * entries, so it may be called from pair_cache_for_each().
+ * Asserts that the entry is in the cache.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @param entry an entry of the cache
+ * @param tick the current tick
+ */
+void pair_cache_touch(pair_cache_t *cache, pair_entry_t *entry, size_t tick);
+
+/**
+ * Removes every pair that was not visited on the given tick.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @param tick the current tick
+ */
+void pair_cache_remove_stale(pair_cache_t *cache, size_t tick);
+
+/**
+ * Calls a function with every entry of a cache. The function may update
+ * entries with pair_cache_touch(), but must not visit any pairs, since a
+ * visit can add a pair and move every entry.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @param visitor the function to call with each entry
+ * @param aux an auxiliary value to pass to the function
+ */
+void pair_cache_for_each(pair_cache_t *cache, pair_visitor_t visitor,
+                         void *aux);
+
+/**
+ * Gets how a pair's contact changed on the tick it was last checked.
+ *
+ * @param entry an entry returned from pair_cache_visit()
+ * @return PAIR_ENTER or PAIR_EXIT if the pair started or stopped touching,
+ *   otherwise PAIR_STAY or PAIR_APART
+ */
+pair_state_t pair_entry_get_state(const pair_entry_t *entry);
+
+#endif // #ifndef __PAIR_CACHE_H__
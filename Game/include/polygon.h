@@ -2,35 +2,150 @@
 #define __POLYGON_H__
 
 #include "list.h"
+#include "pool.h"
 #include "vector.h"
 
+/**
+ * The number of vertices a polygon stores inline before it needs a separate
+ * heap array. Every rectangle, triangle and star point in the game fits.
+ */
+#define POLYGON_INLINE_CAPACITY 8
+
+/**
+ * A convex polygon whose vertices are stored contiguously by value.
+ * Polygons with at most POLYGON_INLINE_CAPACITY vertices keep them inside the
+ * polygon itself, so creating one costs a single allocation from the
+ * polygon pool.
+ * Vertices are listed in counterclockwise order.
+ */
 typedef struct polygon polygon_t;
 
-polygon_t *polygon_init();
+/**
+ * A read-only view of a polygon's vertices.
+ * vector_t is passed by value, and so is this: it only borrows the vertices,
+ * which stay owned by the polygon it was taken from.
+ */
+typedef struct {
+  const vector_t *vertices;
+  size_t size;
+} polygon_view_t;
+
+/**
+ * Allocates memory for an empty polygon with room for the given number of
+ * vertices. Asserts that the required memory was allocated.
+ *
+ * @param capacity the number of vertices to allocate space for
+ * @return a pointer to the newly allocated polygon
+ */
+polygon_t *polygon_init(size_t capacity);
 
+/**
+ * Releases the memory allocated for a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ */
 void polygon_free(polygon_t *polygon);
 
-vector_t polygon_get_velocity(polygon_t *polygon);
+/**
+ * Gets the statistics of the pool that all polygons are allocated from.
+ *
+ * @return the polygon pool's current statistics
+ */
+pool_stats_t polygon_get_pool_stats(void);
+
+/**
+ * Allocates a polygon holding the same vertices as another polygon.
+ *
+ * @param polygon the polygon to copy
+ * @return a newly allocated polygon, which must be polygon_free()d
+ */
+polygon_t *polygon_copy(polygon_t *polygon);
 
-list_t *polygon_get_vertices(polygon_t *polygon);
+/**
+ * Allocates a polygon holding the vertices of a list of vector_t pointers.
+ * Does not free the list.
+ *
+ * @param shape the list of vertices to copy
+ * @return a newly allocated polygon, which must be polygon_free()d
+ */
+polygon_t *polygon_from_list(list_t *shape);
+
+/**
+ * Allocates a list of individually allocated vector_t copies of the polygon's
+ * vertices, for callers that still work with vertex lists.
+ *
+ * @param polygon the polygon to copy
+ * @return a newly allocated vector list, which must be list_free()d
+ */
+list_t *polygon_to_list(polygon_t *polygon);
 
-float polygon_get_R(polygon_t *polygon);
+/**
+ * Gets the number of vertices in a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the number of vertices
+ */
+size_t polygon_size(polygon_t *polygon);
 
-float polygon_get_G(polygon_t *polygon);
+/**
+ * Gets the polygon's contiguous vertex array.
+ * The array is owned by the polygon and is invalidated by polygon_add().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a pointer to the first of polygon_size() vertices
+ */
+vector_t *polygon_vertices(polygon_t *polygon);
 
-float polygon_get_B(polygon_t *polygon);
+/**
+ * Gets a read-only view of a polygon's vertices without copying them.
+ * The view is invalidated by polygon_add() and polygon_free().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a view of the polygon's vertices
+ */
+polygon_view_t polygon_get_view(polygon_t *polygon);
 
-void polygon_set_velocity(polygon_t *polygon, vector_t velocity);
+/**
+ * Gets the vertex at a given index in a polygon.
+ * Asserts that the index is valid.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param index an index in the polygon (the first vertex is at 0)
+ * @return the vertex at the given index
+ */
+vector_t polygon_get(polygon_t *polygon, size_t index);
 
-void *polygon_set_vertices(polygon_t *polygon, list_t *shape);
+/**
+ * Appends a vertex to a polygon, growing its storage if needed.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param vertex the vertex to add after the current last vertex
+ */
+void polygon_add(polygon_t *polygon, vector_t vertex);
 
-void polygon_set_R(polygon_t *polygon, float R);
+/**
+ * Computes the area of a polygon.
+ * Acts like polygon_area() on the polygon's vertices.
+ */
+double polygon_get_area(polygon_t *polygon);
 
-void polygon_set_G(polygon_t *polygon, float G);
+/**
+ * Computes the center of mass of a polygon.
+ * Acts like polygon_centroid() on the polygon's vertices.
+ */
+vector_t polygon_get_centroid(polygon_t *polygon);
 
-void polygon_set_B(polygon_t *polygon, float B);
+/**
+ * Translates all vertices in a polygon by a given vector.
+ * Acts like polygon_translate() on the polygon's vertices.
+ */
+void polygon_translate_vertices(polygon_t *polygon, vector_t translation);
 
-void polygon_change_velocity(polygon_t *polygon, vector_t delta_v);
+/**
+ * Rotates all vertices in a polygon by a given angle about a given point.
+ * Acts like polygon_rotate() on the polygon's vertices.
+ */
+void polygon_rotate_vertices(polygon_t *polygon, double angle, vector_t point);
 
 /**
  * Computes the area of a polygon.
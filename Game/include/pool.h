@@ -0,0 +1,75 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+
+/**
+ * The alignment, in bytes, of every slab a pool allocates.
+ * Object strides are chosen so that no object straddles a cache line
+ * unless it is larger than one.
+ */
+#define POOL_CACHE_LINE 64
+
+/**
+ * A fixed-size object allocator.
+ * Objects are carved out of cache-line aligned slabs and released objects are
+ * kept on a free list, so once a pool has grown to its working size,
+ * allocating and releasing objects never touches the heap.
+ */
+typedef struct pool pool_t;
+
+/**
+ * Counts describing how much of a pool is in use.
+ */
+typedef struct {
+  size_t live;
+  size_t peak;
+  size_t capacity;
+  size_t slabs;
+} pool_stats_t;
+
+/**
+ * Allocates memory for an empty pool. No slabs are allocated until the first
+ * call to pool_alloc(). Asserts that the required memory was allocated.
+ *
+ * @param object_size the size of every object the pool hands out
+ * @param objects_per_slab how many objects each slab holds
+ * @return a pointer to the newly allocated pool
+ */
+pool_t *pool_init(size_t object_size, size_t objects_per_slab);
+
+/**
+ * Releases a pool and all of its slabs.
+ * Any objects still allocated from the pool become invalid.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ */
+void pool_free(pool_t *pool);
+
+/**
+ * Takes an object from a pool, allocating a new slab if every object is in
+ * use. The object's contents are unspecified.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return a pointer to an object of the pool's object size
+ */
+void *pool_alloc(pool_t *pool);
+
+/**
+ * Returns an object to the pool it was allocated from.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @param object a pointer returned from pool_alloc() on the same pool
+ */
+void pool_release(pool_t *pool, void *object);
+
+/**
+ * Gets the number of live objects in a pool, the most that have been live at
+ * once, and how many objects and slabs the pool has allocated.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the pool's current statistics
+ */
+pool_stats_t pool_get_stats(pool_t *pool);
+
+#endif // #ifndef __POOL_H__
@@ -0,0 +1,161 @@
+#ifndef __QUERY_INDEX_H__
+#define __QUERY_INDEX_H__
+
+#include "body.h"
+#include "bvh.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The broadphases a scene can use to find which bodies are close enough for
+ * pair and layer force creators to act on.
+ * A grid suits bodies spread over a large area. Sweep and prune sorts
+ * bodies along the x axis and re-sorts them incrementally every tick, which
+ * suits wide scenes where bodies move a little each tick.
+ */
+typedef enum {
+  BROADPHASE_GRID,
+  BROADPHASE_SWEEP_AND_PRUNE,
+} broadphase_t;
+
+/**
+ * The first body a ray or segment query hit.
+ */
+typedef struct {
+  /** The body hit, or NULL if nothing was */
+  body_t *body;
+  /** How far from the start of the query the body was hit */
+  double distance;
+  /** Where the body was hit */
+  vector_t point;
+  /** The unit normal of the body's surface at point */
+  vector_t normal;
+} ray_hit_t;
+
+/**
+ * A function called with each body a spatial query finds.
+ * See scene_query_radius() and scene_query_aabb().
+ */
+typedef void (*body_visitor_t)(body_t *body, void *aux);
+
+/**
+ * A function which looks up the static body a static tree reports by id,
+ * returning NULL if that body is gone. See query_index_set_statics().
+ */
+typedef body_t *(*static_lookup_t)(size_t id, void *aux);
+
+/**
+ * The index a scene answers spatial queries from.
+ * Moving bodies' current boxes are kept in the same kind of structure as
+ * the scene's broadphase, under the index of each body's handle, and are
+ * refilled by the first query after they go stale. Static bodies are found
+ * through the scene's static tree.
+ */
+typedef struct query_index query_index_t;
+
+/**
+ * Allocates memory for an empty, stale query index.
+ * Asserts that the required memory was allocated.
+ *
+ * @param broadphase the kind of structure to keep moving bodies' boxes in
+ * @return a pointer to the newly allocated index
+ */
+query_index_t *query_index_init(broadphase_t broadphase);
+
+/**
+ * Releases the memory allocated for a query index.
+ * Does not free the bodies or the static tree it refers to.
+ *
+ * @param index a pointer to an index returned from query_index_init()
+ */
+void query_index_free(query_index_t *index);
+
+/**
+ * Records that moving bodies have moved or been added or removed, so the
+ * index must be refilled before its next query.
+ *
+ * @param index a pointer to an index returned from query_index_init()
+ */
+void query_index_mark_stale(query_index_t *index);
+
+/**
+ * Gets whether the index must be refilled before its next query.
+ *
+ * @param index a pointer to an index returned from query_index_init()
+ * @return whether query_index_mark_stale() was called since the index was
+ *   last filled
+ */
+bool query_index_is_stale(query_index_t *index);
+
+/**
+ * Starts refilling the index. Every moving body must then be inserted
+ * again, before query_index_commit() ends the refill.
+ *
+ * @param index a pointer to an index returned from query_index_init()
+ */
+void query_index_clear(query_index_t *index);
+
+/**
+ * Adds a moving body's current box to the index.
+ * The body must be in a scene, and stay there until the index goes stale.
+ *
+ * @param index a pointer to an index returned from query_index_init()
+ * @param body the body to add
+ */
+void query_index_insert(query_index_t *index, body_t *body);
+
+/**
+ * Ends a refill, so the index is no longer stale.
+ *
+ * @param index a pointer to an index returned from query_index_init()
+ */
+void query_index_commit(query_index_t *index);
+
+/**
+ * Sets the static tree to search for static bodies, and how to look up the
+ * body for each id it reports.
+ *
+ * @param index a pointer to an index returned from query_index_init()
+ * @param tree the static tree, or NULL if there is none
+ * @param lookup the function to look up static bodies with
+ * @param aux an auxiliary value to pass to lookup
+ */
+void query_index_set_statics(query_index_t *index, bvh_t *tree,
+                             static_lookup_t lookup, void *aux);
+
+/**
+ * Finds the first body that a segment passes into, among the bodies on a set
+ * of collision layers, like scene_segment_query().
+ * The index must not be stale.
+ *
+ * @param index a pointer to an index returned from query_index_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param layers a mask of the collision layers to hit bodies on
+ * @param hit where to store the first body hit and where it was hit
+ * @return whether any body was hit
+ */
+bool query_index_segment(query_index_t *index, vector_t start, vector_t end,
+                         uint32_t layers, ray_hit_t *hit);
+
+/**
+ * Calls a visitor once for every body on a set of collision layers whose
+ * bounding box overlaps a box and, if radius is positive, whose shape
+ * overlaps a circle, like scene_query_radius().
+ * The index must not be stale.
+ *
+ * @param index a pointer to an index returned from query_index_init()
+ * @param box the box to look for bodies in
+ * @param center the center of the circle
+ * @param radius the radius of the circle, or 0 to only check boxes
+ * @param layers a mask of the collision layers to find bodies on
+ * @param visitor the function to call with each body found
+ * @param aux an auxiliary value to pass to the visitor
+ * @return the number of bodies found
+ */
+size_t query_index_region(query_index_t *index, aabb_t box, vector_t center,
+                          double radius, uint32_t layers,
+                          body_visitor_t visitor, void *aux);
+
+#endif // #ifndef __QUERY_INDEX_H__
@@ -2,8 +2,14 @@
 #define __SCENE_H__
 
 #include "body.h"
+#include "event_queue.h"
 #include "info_types.h"
+#include "layer_table.h"
 #include "list.h"
+#include "pair_cache.h"
+#include "pool.h"
+#include "query_index.h"
+#include "tag_index.h"
 
 /**
  * A collection of bodies and force creators.
@@ -20,7 +26,7 @@ typedef struct scene scene_t;
 typedef void (*force_creator_t)(void *aux);
 
 /**
- * Allocates memory for an empty scene.
+ * Allocates memory for an empty scene that uses a grid broadphase.
  * Makes a reasonable guess of the number of bodies to allocate space for.
  * Asserts that the required memory is successfully allocated.
  *
@@ -28,6 +34,15 @@ typedef void (*force_creator_t)(void *aux);
  */
 scene_t *scene_init(void);
 
+/**
+ * Allocates memory for an empty scene that uses a given broadphase.
+ * Acts like scene_init() otherwise.
+ *
+ * @param broadphase the broadphase to find nearby bodies with
+ * @return the new scene
+ */
+scene_t *scene_init_with_broadphase(broadphase_t broadphase);
+
 /**
  * Releases memory allocated for a given scene
  * and all the bodies and force creators it contains.
@@ -36,6 +51,14 @@ scene_t *scene_init(void);
  */
 void scene_free(scene_t *scene);
 
+/**
+ * Gets the statistics of the pool that every scene's force creators are
+ * allocated from.
+ *
+ * @return the force pool's current statistics
+ */
+pool_stats_t scene_get_force_pool_stats(void);
+
 /**
  * Gets the number of bodies in a given scene.
  *
@@ -44,6 +67,29 @@ void scene_free(scene_t *scene);
  */
 size_t scene_bodies(scene_t *scene);
 
+/**
+ * Gets the number of times scene_tick() has been called on a scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of ticks so far
+ */
+size_t scene_get_ticks(scene_t *scene);
+
+/**
+ * Gets the scene's record of a pair of bodies for the current tick, adding
+ * the pair if it is new. See pair_cache_visit() for how long the entry
+ * stays valid. The scene adds every pair the broadphase reports on layers
+ * some layer force creator acts on, and keeps pairs that were touching on
+ * the last tick until they are checked again, so their separation is seen.
+ * Pairs that are not visited on a tick are dropped at its end.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 a body in the scene
+ * @param body2 another body in the scene
+ * @return the pair's entry, or NULL if either body is not in the scene
+ */
+pair_entry_t *scene_get_pair(scene_t *scene, body_t *body1, body_t *body2);
+
 /**
  * Gets the body at a given index in a scene.
  * Asserts that the index is valid.
@@ -54,8 +100,20 @@ size_t scene_bodies(scene_t *scene);
  */
 body_t *scene_get_body(scene_t *scene, size_t index);
 
+/**
+ * Looks up a body by the handle it was given when added to a scene.
+ * Handles stay valid while bodies are added and removed around them,
+ * and stop resolving once their body has been freed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handle a handle returned from body_get_handle()
+ * @return the body the handle refers to, or NULL if it has been freed
+ */
+body_t *scene_get_body_by_handle(scene_t *scene, body_handle_t handle);
+
 /**
  * Adds a body to a scene.
+ * The body is assigned a handle, available from body_get_handle().
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param body a pointer to the body to add to the scene
@@ -99,12 +157,107 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Adds a force creator to a scene that only acts on a pair of bodies while
+ * they are close together, such as a collision.
+ * Each tick, the scene's broadphase finds the bodies whose bounding
+ * boxes overlap, and the force creator is only invoked on ticks where its
+ * bodies are among them, plus the first tick after they separate.
+ * It must therefore have no effect while the bodies' boxes are disjoint.
+ * Like scene_add_bodies_force_creator(), it is removed along with either body.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param body1 the first body the force creator acts on
+ * @param body2 the second body the force creator acts on
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_pair_force_creator(scene_t *scene, force_creator_t forcer,
+                                  void *aux, body_t *body1, body_t *body2,
+                                  free_func_t freer);
+
+/**
+ * Adds a force creator to a scene that acts on every pair of bodies where
+ * one is on layer1 and the other on layer2 (see body_set_collision_layer()),
+ * including bodies added to the scene later.
+ * Each tick it is invoked on the pairs whose bounding boxes the broadphase
+ * reports as overlapping, with the body on layer1 first, so it must have no
+ * effect while the bodies' boxes are disjoint.
+ * Layer force creators run after all the others, in the order they were
+ * added, and are only freed along with the scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param layer1 the layer of the first body passed to forcer
+ * @param layer2 the layer of the second body passed to forcer
+ * @param forcer a layer force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_layer_force_creator(scene_t *scene, size_t layer1,
+                                   size_t layer2, layer_force_creator_t forcer,
+                                   void *aux, free_func_t freer);
+
+/**
+ * Queues a response to an event between two bodies, to be run once every
+ * force creator has run this tick, so that force creators only detect
+ * events and never see bodies changed by another event's response.
+ * Queued events run in batches by handler, in the order each handler was
+ * first queued this tick, and in the order they were queued within a batch.
+ * Events queued by a handler run after the current batches.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handler the function to respond to the event with
+ * @param body1 the first body to pass to handler
+ * @param body2 the second body to pass to handler
+ * @param axis the axis to pass to handler
+ * @param aux an auxiliary value to pass to handler, which must stay valid
+ *   until the end of the tick
+ */
+void scene_queue_event(scene_t *scene, event_handler_t handler, body_t *body1,
+                       body_t *body2, vector_t axis, void *aux);
+
+/**
+ * Queues the separation of two bodies the narrowphase found overlapping, to
+ * be applied once every force creator has run this tick and before any
+ * queued event runs, so that detection never moves bodies while other pairs
+ * are still being tested. Each body moves along the contact normal in
+ * inverse proportion to its mass, so bodies of infinite mass never move.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the body the contact normal points away from
+ * @param body2 the body the contact normal points towards
+ * @param manifold the bodies' contact (see find_body_manifold())
+ */
+void scene_queue_contact(scene_t *scene, body_t *body1, body_t *body2,
+                         const contact_manifold_t *manifold);
+
+/**
+ * Moves every body currently in a scene with infinite mass out of the
+ * broadphase and into a bounding volume hierarchy built once, so each
+ * moving body finds the static bodies near it in logarithmic time.
+ * Those bodies must not move afterwards, and force creators acting only on
+ * two of them never run. Calling this again rebuilds the tree.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_build_static_tree(scene_t *scene);
+
 /**
  * Executes a tick of a given scene over a small time interval.
  * This requires executing all the force creators
  * and then ticking each body (see body_tick()).
+ * Force creators run in the order they were added, except that pair force
+ * creators run after all the others, followed by layer force creators.
+ * Before the pair and layer force creators run, each continuous body (see
+ * body_set_continuous()) is moved back to where its last tick's path first
+ * touched a body it shares a layer force creator with.
+ * The contacts they queue are then separated (see scene_queue_contact()),
+ * and the events they queue run next (see scene_queue_event()).
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
+ * Removal moves the last body into the removed body's index, so indices are
+ * not stable across ticks; hold a body_handle_t instead.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
@@ -112,23 +265,129 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
 void scene_tick(scene_t *scene, double dt);
 
 /**
- * @brief returns a list of bodies with the passed in compurter info name
+ * Finds the first body that a segment passes into, among the bodies on a set
+ * of collision layers. Bodies the segment starts inside are ignored, so a
+ * body can look out from its own centroid.
+ * Static bodies are found through the static tree (see
+ * scene_build_static_tree()), and the rest by walking the cells or intervals
+ * of the scene's query index that the segment crosses, like
+ * scene_query_radius(). Both searches stop at the closest hit found so far,
+ * and only bodies whose boxes the segment enters have their shapes tested.
+ * Nothing is allocated.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param layers a mask with bit i set to hit bodies on collision layer i,
+ *   or UINT32_MAX to hit bodies on any layer
+ * @param hit where to store the first body hit and where it was hit
+ * @return whether any body was hit
+ */
+bool scene_segment_query(scene_t *scene, vector_t start, vector_t end,
+                         uint32_t layers, ray_hit_t *hit);
+
+/**
+ * Finds the first body a ray hits within some distance, like
+ * scene_segment_query().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param origin where the ray starts
+ * @param direction the direction of the ray, which must not be VEC_ZERO
+ * @param max_distance how far along the ray to look
+ * @param layers a mask of the collision layers to hit bodies on
+ * @param hit where to store the first body hit and where it was hit
+ * @return whether any body was hit
+ */
+bool scene_raycast(scene_t *scene, vector_t origin, vector_t direction,
+                   double max_distance, uint32_t layers, ray_hit_t *hit);
+
+/**
+ * Calls a visitor once for every body on a set of collision layers whose
+ * shape overlaps a circle, in no particular order.
+ * Static bodies are found through the static tree (see
+ * scene_build_static_tree()), and the rest through an index of their
+ * bounding boxes kept in the same kind of structure as the scene's
+ * broadphase. The index is refilled by the first query after bodies move or
+ * are added, so a query only compares the bodies near the circle, and only
+ * tests the shapes of those whose boxes overlap it.
+ * Bodies moved by hand since the last tick, such as with
+ * body_set_centroid(), may be found where they were before they moved.
+ * The visitor must not add bodies to the scene; it may remove them.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @param layers a mask with bit i set to find bodies on collision layer i,
+ *   or UINT32_MAX to find bodies on any layer
+ * @param visitor the function to call with each body found
+ * @param aux an auxiliary value to pass to the visitor
+ * @return the number of bodies found
+ */
+size_t scene_query_radius(scene_t *scene, vector_t center, double radius,
+                          uint32_t layers, body_visitor_t visitor, void *aux);
+
+/**
+ * Calls a visitor once for every body on a set of collision layers whose
+ * bounding box (see body_get_aabb()) overlaps a box, in no particular
+ * order, like scene_query_radius().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param box the box to look for bodies in
+ * @param layers a mask of the collision layers to find bodies on
+ * @param visitor the function to call with each body found
+ * @param aux an auxiliary value to pass to the visitor
+ * @return the number of bodies found
+ */
+size_t scene_query_aabb(scene_t *scene, aabb_t box, uint32_t layers,
+                        body_visitor_t visitor, void *aux);
+
+/**
+ * Gets the bodies in a scene with a given tag, in no particular order.
+ * A body's tag is read when it is added to the scene (see body_set_tag()).
+ * The scene keeps a bucket of bodies for each tag up to date as bodies are
+ * added and released, so this is O(1) and allocates nothing.
+ * Bodies marked for removal stay in their bucket until the next tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param tag the tag of the bodies we want, which must not be BODY_TAG_NONE
+ * @return a view of the bodies with that tag
+ */
+body_view_t scene_bodies_with_tag(scene_t *scene, body_tag_t tag);
+
+/**
+ * Makes the body tag for a kind of BRAWLHUB element.
+ *
+ * @param info the element's computer_info_t
+ * @return a COMPUTER_TAG with info as its subtype
+ */
+body_tag_t comp_info_tag(computer_info_t info);
+
+/**
+ * Makes the body tag for a kind of bullet.
+ *
+ * @param info the bullet's bullet_info_t
+ * @return a BULLET_TAG with info as its subtype
+ */
+body_tag_t bullet_info_tag(bullet_info_t info);
+
+/**
+ * @brief returns the bodies with the passed in computer info name
  *
- * @param scene the scen holding the bodies
+ * @param scene the scene holding the bodies
  * @param info the info of the bodies we want as a computer_info_t
- * @return a list of bodies
+ * @return a view of the bodies, as in scene_bodies_with_tag()
  *
  */
-list_t *scene_bodies_with_comp_info(scene_t *scene, computer_info_t info);
+body_view_t scene_bodies_with_comp_info(scene_t *scene, computer_info_t info);
 
 /**
- * @brief returns a list of bodies with the passed in info name
+ * @brief returns the bodies with the passed in info name
  *
- * @param scene the scen holding the bodies
+ * @param scene the scene holding the bodies
  * @param info the info of the bodies we want as a bullet_info_t
- * @return a list of bodies
+ * @return a view of the bodies, as in scene_bodies_with_tag()
  *
  */
-list_t *scene_bodies_with_bullet_info(scene_t *scene, bullet_info_t info);
+body_view_t scene_bodies_with_bullet_info(scene_t *scene, bullet_info_t info);
 
 #endif // #ifndef __SCENE_H__
@@ -5,6 +5,7 @@
 #include "color.h"
 #include "computer.h"
 #include "list.h"
+#include "polygon.h"
 #include "scene.h"
 #include "state.h"
 #include "vector.h"
@@ -76,7 +77,8 @@ typedef struct SDL_print_object SDL_print_object_t;
  * @param rectangle_dms location of text
  * @param color color of the text
  * @param message_freer frees the message
- * @return SDL_print_object_t that was initialized
+ * @return SDL_print_object_t that was initialized, allocated from the frame
+ * arena
  */
 SDL_print_object_t *
 SDL_print_object_init(print_handler_t print_handler, void *message,
@@ -84,7 +86,8 @@ SDL_print_object_init(print_handler_t print_handler, void *message,
                       SDL_Color color, free_func_t message_freer);
 
 /**
- * @brief Frees SDL print objects
+ * @brief Frees SDL print objects' messages; the frame arena releases the
+ * objects themselves
  *
  * @param print_object Object to free.
  */
@@ -161,12 +164,21 @@ bool sdl_is_done(state_t *current);
 void sdl_clear(void);
 
 /**
- * Draws a polygon from the given list of vertices and a color.
+ * Draws a polygon from the given vertices and a color.
  *
- * @param points the list of vertices of the polygon
+ * @param points a view of the polygon to draw
  * @param color the color used to fill in the polygon
  */
-void sdl_draw_polygon(list_t *points, rgb_color_t color);
+void sdl_draw_polygon(polygon_view_t points, rgb_color_t color);
+
+/**
+ * Draws a filled circle with a single primitive.
+ *
+ * @param center the center of the circle, in scene coordinates
+ * @param radius the radius of the circle, in scene units
+ * @param color the color used to fill in the circle
+ */
+void sdl_draw_circle(vector_t center, double radius, rgb_color_t color);
 
 /**
  * Displays the rendered frame on the SDL window.
@@ -16,7 +16,8 @@
  * @param color the color of the sector
  * @return a body
  */
-list_t *create_sector(double radius, vector_t *center, double angle, bool gap);
+polygon_t *create_sector(double radius, vector_t center, double angle,
+                         bool gap);
 
 /**
  * Makes an oval
@@ -26,7 +27,7 @@ list_t *create_sector(double radius, vector_t *center, double angle, bool gap);
  * @param center the center of the sector.
  * @return a body
  */
-list_t *create_oval(double width, double height, vector_t *center);
+polygon_t *create_oval(double width, double height, vector_t center);
 
 /**
  * Makes a rectangle
@@ -36,9 +37,10 @@ list_t *create_oval(double width, double height, vector_t *center);
  * @param height height of the rectangle
  * @param mass the mass of the object to be drawn
  * @param color the color of the sector
- * @return list_t*
+ * @return polygon_t*
  */
-list_t *create_four_sided_shape(vector_t center, double width, double height);
+polygon_t *create_four_sided_shape(vector_t center, double width,
+                                   double height);
 
 /**
  * Makes variations of star objects
@@ -51,7 +53,7 @@ list_t *create_four_sided_shape(vector_t center, double width, double height);
  * @param color the color of the star
  * @return a star body
  */
-list_t *create_star(double outer_radius, double inner_radius,
-                    size_t number_corners, vector_t center);
+polygon_t *create_star(double outer_radius, double inner_radius,
+                       size_t number_corners, vector_t center);
 
 #endif // #ifndef __SHAPES_H__
\ No newline at end of file
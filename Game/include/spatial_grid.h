@@ -0,0 +1,118 @@
+#ifndef __SPATIAL_GRID_H__
+#define __SPATIAL_GRID_H__
+
+#include "body.h"
+#include <stddef.h>
+
+/**
+ * A uniform grid over the plane, stored as a hash table of occupied cells.
+ * Boxes are inserted with an id, and the grid reports every pair of ids
+ * whose boxes overlap while only comparing boxes that share a cell.
+ * The grid is meant to be cleared and refilled every tick.
+ */
+typedef struct spatial_grid spatial_grid_t;
+
+/**
+ * A function called with each pair of overlapping boxes found in a grid.
+ *
+ * @param id1 the id of the first box
+ * @param id2 the id of the second box
+ * @param aux the auxiliary value passed to spatial_grid_find_pairs()
+ */
+typedef void (*grid_pair_handler_t)(size_t id1, size_t id2, void *aux);
+
+/**
+ * A function called with each box a grid query finds.
+ *
+ * @param id the id the box was inserted with
+ * @param aux the auxiliary value passed to the query
+ */
+typedef void (*grid_hit_handler_t)(size_t id, void *aux);
+
+/**
+ * A function called with each box a segment passes through.
+ * Returns how far along the segment is still worth searching, like
+ * bvh_segment_handler_t.
+ *
+ * @param id the id the box was inserted with
+ * @param max_fraction how far along the segment the search reaches so far
+ * @param aux the auxiliary value passed to spatial_grid_query_segment()
+ * @return the new reach of the search, at most max_fraction
+ */
+typedef double (*grid_segment_handler_t)(size_t id, double max_fraction,
+                                         void *aux);
+
+/**
+ * Allocates memory for an empty grid.
+ * Asserts that the required memory was allocated.
+ *
+ * @param cell_size the width and height of each grid cell.
+ *   Works best when it is a little larger than a typical box.
+ * @return a pointer to the newly allocated grid
+ */
+spatial_grid_t *spatial_grid_init(double cell_size);
+
+/**
+ * Releases the memory allocated for a grid.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ */
+void spatial_grid_free(spatial_grid_t *grid);
+
+/**
+ * Removes every box from a grid, keeping its memory for reuse.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ */
+void spatial_grid_clear(spatial_grid_t *grid);
+
+/**
+ * Adds a box to every grid cell it touches.
+ * Boxes that would cover too many cells are instead tested against every
+ * other box.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param id an id to report the box by
+ * @param box the box to add
+ */
+void spatial_grid_insert(spatial_grid_t *grid, size_t id, aabb_t box);
+
+/**
+ * Calls a handler once for every pair of overlapping boxes in a grid.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param handler the function to call with each pair's ids
+ * @param aux an auxiliary value to pass to the handler
+ */
+void spatial_grid_find_pairs(spatial_grid_t *grid, grid_pair_handler_t handler,
+                             void *aux);
+
+/**
+ * Calls a handler once for every box in a grid that overlaps a given box,
+ * only looking in the cells the box touches.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param box the box to look for overlapping boxes with
+ * @param handler the function to call with each overlapping box's id
+ * @param aux an auxiliary value to pass to the handler
+ */
+void spatial_grid_query(spatial_grid_t *grid, aabb_t box,
+                        grid_hit_handler_t handler, void *aux);
+
+/**
+ * Calls a handler once for every box in a grid that a segment passes
+ * through, walking the cells the segment crosses from its start.
+ * The walk stops at the reach the handler last returned, and boxes the
+ * segment only enters beyond it are skipped (see aabb_segment_entry()).
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param handler the function to call with each box's id
+ * @param aux an auxiliary value to pass to the handler
+ */
+void spatial_grid_query_segment(spatial_grid_t *grid, vector_t start,
+                                vector_t end, grid_segment_handler_t handler,
+                                void *aux);
+
+#endif // #ifndef __SPATIAL_GRID_H__
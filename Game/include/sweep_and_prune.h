@@ -0,0 +1,126 @@
+#ifndef __SWEEP_AND_PRUNE_H__
+#define __SWEEP_AND_PRUNE_H__
+
+#include "body.h"
+#include <stddef.h>
+
+/**
+ * A sort-and-sweep broadphase along the x axis.
+ * Boxes are kept sorted by their left edge between rounds, so when they
+ * only move a little each round, re-sorting them takes close to linear time.
+ * Each round, every box still present is inserted again under the same id;
+ * boxes that are not are dropped at the next sweep_and_prune_find_pairs().
+ * Ids index a table inside the structure, so they should be small, such as
+ * the slot indices of body handles.
+ */
+typedef struct sweep_and_prune sweep_and_prune_t;
+
+/**
+ * A function called with each pair of overlapping boxes found.
+ *
+ * @param id1 the id of the box further left
+ * @param id2 the id of the other box
+ * @param aux the auxiliary value passed to sweep_and_prune_find_pairs()
+ */
+typedef void (*sweep_pair_handler_t)(size_t id1, size_t id2, void *aux);
+
+/**
+ * A function called with each box a query finds.
+ *
+ * @param id the id the box was inserted with
+ * @param aux the auxiliary value passed to the query
+ */
+typedef void (*sweep_hit_handler_t)(size_t id, void *aux);
+
+/**
+ * A function called with each box a segment passes through.
+ * Returns how far along the segment is still worth searching, like
+ * bvh_segment_handler_t.
+ *
+ * @param id the id the box was inserted with
+ * @param max_fraction how far along the segment the search reaches so far
+ * @param aux the auxiliary value passed to sweep_and_prune_query_segment()
+ * @return the new reach of the search, at most max_fraction
+ */
+typedef double (*sweep_segment_handler_t)(size_t id, double max_fraction,
+                                          void *aux);
+
+/**
+ * Allocates memory for an empty broadphase.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated broadphase
+ */
+sweep_and_prune_t *sweep_and_prune_init(void);
+
+/**
+ * Releases the memory allocated for a broadphase.
+ *
+ * @param sap a pointer to a broadphase returned from sweep_and_prune_init()
+ */
+void sweep_and_prune_free(sweep_and_prune_t *sap);
+
+/**
+ * Adds a box for this round, or moves the box already added with its id.
+ *
+ * @param sap a pointer to a broadphase returned from sweep_and_prune_init()
+ * @param id an id to report the box by, kept from round to round
+ * @param box the box's bounds this round
+ */
+void sweep_and_prune_insert(sweep_and_prune_t *sap, size_t id, aabb_t box);
+
+/**
+ * Drops the boxes that were not inserted this round, re-sorts the rest, and
+ * calls a handler once for every pair of overlapping boxes.
+ * Ends the round, so every box must be inserted again before the next call.
+ *
+ * @param sap a pointer to a broadphase returned from sweep_and_prune_init()
+ * @param handler the function to call with each pair's ids
+ * @param aux an auxiliary value to pass to the handler
+ */
+void sweep_and_prune_find_pairs(sweep_and_prune_t *sap,
+                                sweep_pair_handler_t handler, void *aux);
+
+/**
+ * Drops the boxes that were not inserted this round and re-sorts the rest,
+ * like sweep_and_prune_find_pairs(), but without looking for pairs.
+ * Ends the round, so every box must be inserted again before the next call.
+ *
+ * @param sap a pointer to a broadphase returned from sweep_and_prune_init()
+ */
+void sweep_and_prune_commit(sweep_and_prune_t *sap);
+
+/**
+ * Calls a handler once for every box that overlaps a given box, among the
+ * boxes as they were when the last round ended; boxes inserted since then
+ * may be missed. Only the boxes whose left edges lie in a window around the
+ * given box are compared, so the query takes logarithmic time plus the
+ * number of boxes in the window.
+ *
+ * @param sap a pointer to a broadphase returned from sweep_and_prune_init()
+ * @param box the box to look for overlapping boxes with
+ * @param handler the function to call with each overlapping box's id
+ * @param aux an auxiliary value to pass to the handler
+ */
+void sweep_and_prune_query(sweep_and_prune_t *sap, aabb_t box,
+                           sweep_hit_handler_t handler, void *aux);
+
+/**
+ * Calls a handler once for every box a segment passes through, among the
+ * boxes as they were when the last round ended, like sweep_and_prune_query().
+ * Boxes are visited in the order their left edges lie along the segment's x
+ * direction, and the search stops once their left edges pass the reach the
+ * handler last returned. Boxes the segment only enters beyond the reach are
+ * skipped (see aabb_segment_entry()).
+ *
+ * @param sap a pointer to a broadphase returned from sweep_and_prune_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param handler the function to call with each box's id
+ * @param aux an auxiliary value to pass to the handler
+ */
+void sweep_and_prune_query_segment(sweep_and_prune_t *sap, vector_t start,
+                                   vector_t end,
+                                   sweep_segment_handler_t handler, void *aux);
+
+#endif // #ifndef __SWEEP_AND_PRUNE_H__
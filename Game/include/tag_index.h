@@ -0,0 +1,71 @@
+#ifndef __TAG_INDEX_H__
+#define __TAG_INDEX_H__
+
+#include "body.h"
+#include <stddef.h>
+
+/**
+ * A read-only view of an array of bodies owned by a scene.
+ * It is only valid until a body is added to the scene or the scene ticks,
+ * since either can move or release the bodies it holds.
+ */
+typedef struct {
+  body_t *const *bodies;
+  size_t size;
+} body_view_t;
+
+/**
+ * The bodies of a scene grouped by tag (see body_set_tag()).
+ * There is one bucket for each distinct tag the index has held, so there
+ * are only ever a handful of them and they are searched linearly.
+ * Each body's place in its bucket is kept under the index of its handle, so
+ * bodies must be in a scene.
+ */
+typedef struct tag_index tag_index_t;
+
+/**
+ * Allocates memory for an empty tag index.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated index
+ */
+tag_index_t *tag_index_init(void);
+
+/**
+ * Releases the memory allocated for a tag index.
+ * Does not free the bodies it holds.
+ *
+ * @param index a pointer to an index returned from tag_index_init()
+ */
+void tag_index_free(tag_index_t *index);
+
+/**
+ * Adds a body to the bucket for its current tag, creating the bucket if
+ * needed. Untagged bodies are not put in any bucket.
+ *
+ * @param index a pointer to an index returned from tag_index_init()
+ * @param body the body to add, which must not already be in the index
+ */
+void tag_index_add(tag_index_t *index, body_t *body);
+
+/**
+ * Removes a body from its bucket by moving the bucket's last body into its
+ * place, so removal takes constant time.
+ *
+ * @param index a pointer to an index returned from tag_index_init()
+ * @param body a body added with tag_index_add(), whose handle has not
+ *   changed since
+ */
+void tag_index_remove(tag_index_t *index, body_t *body);
+
+/**
+ * Gets the bodies in the index with a given tag, in no particular order.
+ *
+ * @param index a pointer to an index returned from tag_index_init()
+ * @param tag the tag of the bodies we want
+ * @return a view of the bodies with that tag, which is only valid until a
+ *   body is added to or removed from the index
+ */
+body_view_t tag_index_get(tag_index_t *index, body_tag_t tag);
+
+#endif // #ifndef __TAG_INDEX_H__
@@ -7,6 +7,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "body.h"
+#include "polygon.h"
 #include "vector.h"
 
 /**
@@ -51,6 +53,120 @@ bool vec_within(double epsilon, vector_t v1, vector_t v2);
  */
 void read_testname(char *filename, char *testname, size_t testname_size);
 
+/**
+ * Returns a width by height rectangle centered at center,
+ * counterclockwise from its bottom left corner.
+ */
+polygon_t *make_box(vector_t center, double width, double height);
+
+/**
+ * Returns a body with the shape make_box() returns and the given mass.
+ */
+body_t *make_box_body(vector_t center, double width, double height,
+                      double mass);
+
+/**
+ * Returns the 2 by 2 square around the origin as a list of heap-allocated
+ * vectors, counterclockwise from (-1, -1), in the form body_init() takes.
+ */
+list_t *make_shape(void);
+
+/**
+ * Returns a uniformly random double between min and max, drawn with rand().
+ */
+double random_between(double min, double max);
+
+/** The most boxes the broadphase fixtures below can track. */
+#define TEST_MAX_BOXES 300
+
+/**
+ * Fills boxes with count random boxes whose min corners lie in area,
+ * with sides between 1 and max_size.
+ * Every 40th box is 1500 wide, so structures also see boxes much larger
+ * than the rest.
+ */
+void random_boxes(aabb_t *boxes, size_t count, aabb_t area, double max_size);
+
+/** How many times each pair of box ids has been reported. */
+typedef struct {
+  int counts[TEST_MAX_BOXES][TEST_MAX_BOXES];
+} pair_counts_t;
+
+/**
+ * Records a pair a broadphase reported. Cast to the structure's pair handler.
+ */
+void count_pair(size_t id1, size_t id2, pair_counts_t *counts);
+
+/**
+ * Asserts that counts holds each overlapping pair of boxes exactly once,
+ * and no other pairs.
+ *
+ * @param present NULL if every box was inserted, otherwise whether each was
+ */
+void check_pair_counts(pair_counts_t *counts, aabb_t *boxes, bool *present,
+                       size_t count);
+
+/** How many times each box id has been reported. */
+typedef struct {
+  int hits[TEST_MAX_BOXES];
+} hit_counts_t;
+
+/**
+ * Records a box a query reported. Cast to the structure's hit handler.
+ */
+void count_hit(size_t id, hit_counts_t *counts);
+
+/**
+ * Runs a box query on a broadphase structure, passing each box it reports
+ * to count_hit().
+ */
+typedef void (*box_query_t)(void *index, aabb_t box, hit_counts_t *counts);
+
+/**
+ * Runs random box queries on a structure holding each of boxes under its
+ * index, and asserts each reports exactly the boxes it overlaps, once.
+ * Every 10th query covers the whole area.
+ *
+ * @param area the area the query boxes' min corners are drawn from
+ */
+void check_box_queries(void *index, box_query_t query, aabb_t *boxes,
+                       size_t count, aabb_t area, size_t queries);
+
+/** The boxes a segment query reported, see count_segment_hit(). */
+typedef struct {
+  aabb_t *boxes;
+  vector_t start;
+  vector_t delta;
+  hit_counts_t counts;
+  bool closest;
+} segment_hits_t;
+
+/**
+ * Records a box a segment query reported. Cast to the structure's segment
+ * handler. When searching for the closest box, shortens the segment to
+ * where it enters the box, so the query only goes on to nearer ones.
+ */
+double count_segment_hit(size_t id, double max_fraction,
+                         segment_hits_t *hits);
+
+/**
+ * Runs a segment query on a broadphase structure, passing each box it
+ * reports to count_segment_hit().
+ */
+typedef void (*segment_query_t)(void *index, vector_t start, vector_t end,
+                                segment_hits_t *hits);
+
+/**
+ * Runs random segment queries on a structure holding each of boxes under its
+ * index. Queries alternate between keeping the whole segment, which must
+ * report every box it enters once, and searching for the closest box, which
+ * may skip boxes but must still report the nearest.
+ *
+ * @param area the area the segments' endpoints are drawn from
+ */
+void check_segment_queries(void *index, segment_query_t query, aabb_t *boxes,
+                           size_t count, aabb_t area, size_t queries);
+
 /*
  * This macro checks whether to run the test function (which will be true
  * if the test is called without command-line arguments).
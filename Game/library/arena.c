@@ -0,0 +1,95 @@
+#include "arena.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdlib.h>
+
+typedef struct arena_block {
+  struct arena_block *previous;
+  size_t capacity;
+  size_t used;
+  alignas(max_align_t) char data[];
+} arena_block_t;
+
+typedef struct arena {
+  arena_block_t *current;
+  size_t used;
+} arena_t;
+
+const size_t FRAME_ARENA_CAPACITY = 64 * 1024;
+
+arena_t *frame_arena_instance = NULL;
+
+arena_block_t *arena_block_init(size_t capacity, arena_block_t *previous) {
+  arena_block_t *block = malloc(sizeof(arena_block_t) + capacity);
+  assert(block != NULL);
+  block->previous = previous;
+  block->capacity = capacity;
+  block->used = 0;
+  return block;
+}
+
+arena_t *arena_init(size_t capacity) {
+  arena_t *arena = malloc(sizeof(arena_t));
+  assert(arena != NULL);
+  arena->current = arena_block_init(capacity, NULL);
+  arena->used = 0;
+  return arena;
+}
+
+/**
+ * Frees every block in a chain and returns their total capacity.
+ */
+size_t arena_free_blocks(arena_block_t *block) {
+  size_t capacity = 0;
+  while (block != NULL) {
+    arena_block_t *previous = block->previous;
+    capacity += block->capacity;
+    free(block);
+    block = previous;
+  }
+  return capacity;
+}
+
+void arena_free(arena_t *arena) {
+  arena_free_blocks(arena->current);
+  free(arena);
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+  size_t align = alignof(max_align_t);
+  size = (size + align - 1) / align * align;
+  arena_block_t *block = arena->current;
+  if (block->used + size > block->capacity) {
+    size_t capacity = block->capacity * 2;
+    if (capacity < size) {
+      capacity = size;
+    }
+    block = arena_block_init(capacity, block);
+    arena->current = block;
+  }
+  void *memory = block->data + block->used;
+  block->used += size;
+  arena->used += size;
+  return memory;
+}
+
+void arena_reset(arena_t *arena) {
+  arena_block_t *block = arena->current;
+  if (block->previous != NULL) {
+    arena->current = arena_block_init(arena_free_blocks(block), NULL);
+  } else {
+    block->used = 0;
+  }
+  arena->used = 0;
+}
+
+size_t arena_used(arena_t *arena) { return arena->used; }
+
+arena_t *frame_arena(void) {
+  if (frame_arena_instance == NULL) {
+    frame_arena_instance = arena_init(FRAME_ARENA_CAPACITY);
+  }
+  return frame_arena_instance;
+}
+
+void frame_arena_reset(void) { arena_reset(frame_arena()); }
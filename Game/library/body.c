@@ -1,12 +1,36 @@
 #include "body.h"
+#include "arena.h"
 #include "polygon.h"
+#include "pool.h"
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+/**
+ * A body's shape is stored once in local space, relative to its centroid and
+ * unrotated. Moving or rotating the body only updates centroid and
+ * angle_facing and marks world_shape stale; the world-space vertices are
+ * rebuilt from local_shape the next time something reads them.
+ * local_bounds is the unrotated box around local_shape and rotated_bounds
+ * is a box around it at the current angle, so aabb is just rotated_bounds
+ * offset by the centroid.
+ * local_normals holds the distinct directions of local_shape's edge normals,
+ * with parallel edges sharing one, and world_normals holds them rotated to
+ * angle_facing. They only go stale when the body rotates. Shapes with at
+ * most POLYGON_INLINE_CAPACITY edges keep both arrays in inline_normals.
+ * motion is how far the last body_tick() moved the centroid. It is cleared
+ * whenever the body is moved any other way, so a continuous body is only
+ * swept along the path it actually travelled.
+ */
 typedef struct body {
-  list_t *shape;
+  polygon_t *local_shape;
+  polygon_t *world_shape;
+  bool world_dirty;
+  aabb_t local_bounds;
+  aabb_t rotated_bounds;
+  aabb_t aabb;
+  double bounding_radius;
   double mass;
   rgb_color_t color;
   vector_t centroid;
@@ -18,17 +42,192 @@ typedef struct body {
   bool is_removed;
   double damage_collisions;
   double angle_facing;
+  body_handle_t handle;
+  size_t collision_layer;
+  body_tag_t tag;
+  shape_kind_t shape_kind;
+  double radius;
+  vector_t *local_normals;
+  vector_t *world_normals;
+  size_t normal_count;
+  bool normals_dirty;
+  vector_t inline_normals[2 * POLYGON_INLINE_CAPACITY];
+  bool continuous;
+  vector_t motion;
 } body_t;
 
-body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
-                            void *info, free_func_t info_freer) {
+const body_handle_t BODY_HANDLE_NONE = {.index = 0, .generation = 0};
+const body_tag_t BODY_TAG_NONE = {.kind = 0, .subtype = 0};
+const size_t BODY_POOL_SLAB = 64;
+const double PARALLEL_TOLERANCE = 1e-9;
+
+pool_t *body_pool = NULL;
+
+pool_t *body_get_pool(void) {
+  if (body_pool == NULL) {
+    body_pool = pool_init(sizeof(body_t), BODY_POOL_SLAB);
+  }
+  return body_pool;
+}
+
+pool_stats_t body_get_pool_stats(void) {
+  return pool_get_stats(body_get_pool());
+}
+
+bool body_tag_equals(body_tag_t tag1, body_tag_t tag2) {
+  return tag1.kind == tag2.kind && tag1.subtype == tag2.subtype;
+}
+
+bool aabb_overlaps(aabb_t box1, aabb_t box2) {
+  return box1.min.x <= box2.max.x && box2.min.x <= box1.max.x &&
+         box1.min.y <= box2.max.y && box2.min.y <= box1.max.y;
+}
+
+/**
+ * Narrows [*enter, *exit] to the fractions of a segment that lie between
+ * min and max along one axis. Returns false once the span is empty.
+ */
+bool clip_segment_slab(double start, double delta, double min, double max,
+                       double *enter, double *exit) {
+  if (delta == 0) {
+    return start >= min && start <= max;
+  }
+  double to_min = (min - start) / delta;
+  double to_max = (max - start) / delta;
+  *enter = fmax(*enter, fmin(to_min, to_max));
+  *exit = fmin(*exit, fmax(to_min, to_max));
+  return *enter <= *exit;
+}
+
+double aabb_segment_entry(aabb_t box, vector_t start, vector_t delta,
+                          double max_fraction) {
+  double enter = 0;
+  double exit = max_fraction;
+  if (!clip_segment_slab(start.x, delta.x, box.min.x, box.max.x, &enter,
+                         &exit) ||
+      !clip_segment_slab(start.y, delta.y, box.min.y, box.max.y, &enter,
+                         &exit)) {
+    return INFINITY;
+  }
+  return enter;
+}
+
+/**
+ * Computes the bounding box and bounding radius of a body's local shape.
+ */
+void body_init_bounds(body_t *body) {
+  size_t n = polygon_size(body->local_shape);
+  vector_t *local = polygon_vertices(body->local_shape);
+  aabb_t bounds = {.min = local[0], .max = local[0]};
+  double radius_squared = 0;
+  for (size_t i = 0; i < n; i++) {
+    bounds.min.x = fmin(bounds.min.x, local[i].x);
+    bounds.min.y = fmin(bounds.min.y, local[i].y);
+    bounds.max.x = fmax(bounds.max.x, local[i].x);
+    bounds.max.y = fmax(bounds.max.y, local[i].y);
+    radius_squared = fmax(radius_squared, vec_dot(local[i], local[i]));
+  }
+  body->local_bounds = bounds;
+  body->rotated_bounds = bounds;
+  body->bounding_radius = sqrt(radius_squared);
+}
+
+/**
+ * Computes the unit normals of a body's local edges, keeping only one of
+ * each set of parallel edges. A box therefore has two normals, not four.
+ */
+void body_init_normals(body_t *body) {
+  size_t n = polygon_size(body->local_shape);
+  vector_t *local = polygon_vertices(body->local_shape);
+  if (n <= POLYGON_INLINE_CAPACITY) {
+    body->local_normals = body->inline_normals;
+  } else {
+    body->local_normals = malloc(2 * n * sizeof(vector_t));
+    assert(body->local_normals != NULL);
+  }
+  body->world_normals = body->local_normals + n;
+  body->normal_count = 0;
+  for (size_t i = 0; i < n; i++) {
+    vector_t edge = vec_subtract(local[i], local[i + 1 == n ? 0 : i + 1]);
+    double magnitude = sqrt(vec_dot(edge, edge));
+    if (magnitude == 0) {
+      continue;
+    }
+    vector_t normal = vec_multiply(1 / magnitude, (vector_t){edge.y, -edge.x});
+    bool parallel = false;
+    for (size_t j = 0; j < body->normal_count && !parallel; j++) {
+      parallel =
+          fabs(vec_cross(normal, body->local_normals[j])) < PARALLEL_TOLERANCE;
+    }
+    if (!parallel) {
+      body->local_normals[body->normal_count++] = normal;
+    }
+  }
+  for (size_t i = 0; i < body->normal_count; i++) {
+    body->world_normals[i] = body->local_normals[i];
+  }
+  body->normals_dirty = false;
+}
+
+void body_update_aabb(body_t *body) {
+  aabb_t rotated = body->rotated_bounds;
+  body->aabb = (aabb_t){.min = vec_add(body->centroid, rotated.min),
+                        .max = vec_add(body->centroid, rotated.max)};
+}
+
+/**
+ * Replaces a circular body's bounds, which were computed from its inscribed
+ * outline, with the bounds of the circle itself.
+ */
+void body_init_circle_bounds(body_t *body) {
+  double radius = body->radius;
+  aabb_t bounds = {.min = {-radius, -radius}, .max = {radius, radius}};
+  body->local_bounds = bounds;
+  body->rotated_bounds = bounds;
+  body->bounding_radius = radius;
+  body_update_aabb(body);
+}
+
+/**
+ * Recomputes rotated_bounds as the box around the local box's four corners
+ * at the body's current angle, which contains the rotated shape.
+ */
+void body_rotate_bounds(body_t *body) {
+  if (body->shape_kind == SHAPE_CIRCLE) {
+    return;
+  }
+  aabb_t local = body->local_bounds;
+  vector_t corners[] = {local.min,
+                        {local.max.x, local.min.y},
+                        local.max,
+                        {local.min.x, local.max.y}};
+  vector_t first = vec_rotate(corners[0], body->angle_facing);
+  aabb_t rotated = {.min = first, .max = first};
+  for (size_t i = 1; i < 4; i++) {
+    vector_t corner = vec_rotate(corners[i], body->angle_facing);
+    rotated.min.x = fmin(rotated.min.x, corner.x);
+    rotated.min.y = fmin(rotated.min.y, corner.y);
+    rotated.max.x = fmax(rotated.max.x, corner.x);
+    rotated.max.y = fmax(rotated.max.y, corner.y);
+  }
+  body->rotated_bounds = rotated;
+}
+
+body_t *body_init_from_polygon(polygon_t *shape, double mass,
+                               rgb_color_t color, void *info,
+                               free_func_t info_freer) {
   assert(mass >= 0);
-  body_t *body = malloc(sizeof(body_t));
-  assert(body != NULL);
-  body->shape = shape;
+  body_t *body = pool_alloc(body_get_pool());
+  body->centroid = polygon_get_centroid(shape);
+  body->world_shape = polygon_copy(shape);
+  body->world_dirty = false;
+  polygon_translate_vertices(shape, vec_negate(body->centroid));
+  body->local_shape = shape;
+  body_init_bounds(body);
+  body_update_aabb(body);
+  body_init_normals(body);
   body->mass = mass;
   body->color = color;
-  body->centroid = polygon_centroid(shape);
   body->velocity = VEC_ZERO;
   body->impulse = VEC_ZERO;
   body->force = VEC_ZERO;
@@ -37,6 +236,38 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
   body->is_removed = false;
   body->damage_collisions = 0;
   body->angle_facing = 0;
+  body->handle = BODY_HANDLE_NONE;
+  body->collision_layer = COLLISION_LAYER_NONE;
+  body->tag = BODY_TAG_NONE;
+  body->shape_kind = SHAPE_POLYGON;
+  body->radius = 0;
+  body->continuous = false;
+  body->motion = VEC_ZERO;
+  return body;
+}
+
+body_t *body_init_circle(vector_t center, double radius, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer) {
+  assert(radius > 0);
+  polygon_t *outline = polygon_init(BODY_CIRCLE_OUTLINE_VERTICES);
+  for (size_t i = 0; i < BODY_CIRCLE_OUTLINE_VERTICES; i++) {
+    double angle = 2 * M_PI * i / BODY_CIRCLE_OUTLINE_VERTICES;
+    vector_t offset = {radius * cos(angle), radius * sin(angle)};
+    polygon_add(outline, vec_add(center, offset));
+  }
+  body_t *body = body_init_from_polygon(outline, mass, color, info, info_freer);
+  body->shape_kind = SHAPE_CIRCLE;
+  body->radius = radius;
+  body_init_circle_bounds(body);
+  return body;
+}
+
+body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
+                            void *info, free_func_t info_freer) {
+  body_t *body = body_init_from_polygon(polygon_from_list(shape), mass, color,
+                                        info, info_freer);
+  list_free(shape);
   return body;
 }
 
@@ -49,20 +280,92 @@ void body_free(body_t *body) {
   if (body->info_freer != NULL) {
     body->info_freer(body->info);
   }
-  list_free(body->shape);
-  free(body);
+  polygon_free(body->local_shape);
+  polygon_free(body->world_shape);
+  if (body->local_normals != body->inline_normals) {
+    free(body->local_normals);
+  }
+  pool_release(body_get_pool(), body);
+}
+
+/**
+ * Rebuilds the world-space vertices if the body has moved or rotated since
+ * they were last read.
+ */
+void body_update_world_shape(body_t *body) {
+  if (!body->world_dirty) {
+    return;
+  }
+  size_t n = polygon_size(body->local_shape);
+  vector_t *local = polygon_vertices(body->local_shape);
+  vector_t *world = polygon_vertices(body->world_shape);
+  double cos_angle = cos(body->angle_facing);
+  double sin_angle = sin(body->angle_facing);
+  for (size_t i = 0; i < n; i++) {
+    world[i] = (vector_t){
+        body->centroid.x + local[i].x * cos_angle - local[i].y * sin_angle,
+        body->centroid.y + local[i].x * sin_angle + local[i].y * cos_angle};
+  }
+  body->world_dirty = false;
+}
+
+normal_view_t body_get_normals(body_t *body) {
+  if (body->normals_dirty) {
+    double cos_angle = cos(body->angle_facing);
+    double sin_angle = sin(body->angle_facing);
+    for (size_t i = 0; i < body->normal_count; i++) {
+      vector_t normal = body->local_normals[i];
+      body->world_normals[i] =
+          (vector_t){normal.x * cos_angle - normal.y * sin_angle,
+                     normal.x * sin_angle + normal.y * cos_angle};
+    }
+    body->normals_dirty = false;
+  }
+  return (normal_view_t){.normals = body->world_normals,
+                         .size = body->normal_count};
 }
 
 list_t *body_get_shape(body_t *body) {
-  list_t *current_shape = list_init(list_size(body->shape), (free_func_t)free);
-  for (size_t i = 0; i < list_size(body->shape); i++) {
+  body_update_world_shape(body);
+  size_t n = polygon_size(body->world_shape);
+  vector_t *vertices = polygon_vertices(body->world_shape);
+  list_t *shape = list_init(n, (free_func_t)free);
+  for (size_t i = 0; i < n; i++) {
     vector_t *point = malloc(sizeof(vector_t));
-    *point = *((vector_t *)list_get(body->shape, i));
-    list_add(current_shape, point);
+    assert(point != NULL);
+    *point = vertices[i];
+    list_add(shape, point);
+  }
+  return shape;
+}
+
+list_t *body_get_shape_in_arena(body_t *body, arena_t *arena) {
+  body_update_world_shape(body);
+  size_t n = polygon_size(body->world_shape);
+  vector_t *vertices = polygon_vertices(body->world_shape);
+  list_t *shape = list_init_in_arena(arena, n, NULL);
+  vector_t *copies = arena_alloc(arena, n * sizeof(vector_t));
+  for (size_t i = 0; i < n; i++) {
+    copies[i] = vertices[i];
+    list_add(shape, &copies[i]);
   }
-  return current_shape;
+  return shape;
 }
 
+polygon_view_t body_get_shape_view(body_t *body) {
+  body_update_world_shape(body);
+  return polygon_get_view(body->world_shape);
+}
+
+polygon_t *body_get_polygon(body_t *body) {
+  body_update_world_shape(body);
+  return polygon_copy(body->world_shape);
+}
+
+aabb_t body_get_aabb(body_t *body) { return body->aabb; }
+
+double body_get_bounding_radius(body_t *body) { return body->bounding_radius; }
+
 vector_t body_get_centroid(body_t *body) { return body->centroid; }
 
 vector_t body_get_velocity(body_t *body) { return body->velocity; }
@@ -72,16 +375,20 @@ rgb_color_t body_get_color(body_t *body) { return body->color; }
 double body_get_rotation(body_t *body) { return body->angle_facing; }
 
 void body_set_centroid(body_t *body, vector_t x) {
-  polygon_translate(body->shape, vec_subtract(x, body->centroid));
-  body->centroid = polygon_centroid(body->shape);
+  body->centroid = x;
+  body->world_dirty = true;
+  body->motion = VEC_ZERO;
+  body_update_aabb(body);
 }
 
 void body_set_velocity(body_t *body, vector_t v) { body->velocity = v; }
 
 void body_set_rotation(body_t *body, double angle) {
-  polygon_rotate(body->shape, -(body->angle_facing), body->centroid);
-  polygon_rotate(body->shape, angle, body->centroid);
   body->angle_facing = angle;
+  body->world_dirty = true;
+  body->normals_dirty = true;
+  body_rotate_bounds(body);
+  body_update_aabb(body);
 }
 
 void body_add_force(body_t *body, vector_t force) {
@@ -106,7 +413,9 @@ void body_tick(body_t *body, double dt) {
   vector_t new_v = vec_add(dv, body->velocity);
   body->velocity = new_v;
   vector_t averageV = vec_multiply(0.5, vec_add(old_v, new_v));
-  body_set_centroid(body, vec_add(body->centroid, vec_multiply(dt, averageV)));
+  vector_t motion = vec_multiply(dt, averageV);
+  body_set_centroid(body, vec_add(body->centroid, motion));
+  body->motion = motion;
   body->impulse = VEC_ZERO;
   body->force = VEC_ZERO;
 }
@@ -121,4 +430,46 @@ double body_damage_collisions(body_t *body) { return body->damage_collisions; }
 
 void body_add_damage(body_t *body, double damage) {
   body->damage_collisions += damage;
-}
\ No newline at end of file
+}
+
+body_handle_t body_get_handle(body_t *body) { return body->handle; }
+
+void body_set_handle(body_t *body, body_handle_t handle) {
+  body->handle = handle;
+}
+
+shape_kind_t body_get_shape_kind(body_t *body) { return body->shape_kind; }
+
+double body_get_radius(body_t *body) { return body->radius; }
+
+size_t body_get_collision_layer(body_t *body) { return body->collision_layer; }
+
+body_tag_t body_get_tag(body_t *body) { return body->tag; }
+
+void body_set_tag(body_t *body, body_tag_t tag) { body->tag = tag; }
+
+bool body_is_continuous(body_t *body) { return body->continuous; }
+
+void body_set_continuous(body_t *body, bool continuous) {
+  body->continuous = continuous;
+}
+
+vector_t body_get_motion(body_t *body) { return body->motion; }
+
+aabb_t body_get_swept_aabb(body_t *body) {
+  aabb_t box = body->aabb;
+  if (!body->continuous) {
+    return box;
+  }
+  vector_t motion = body->motion;
+  box.min.x -= fmax(motion.x, 0);
+  box.min.y -= fmax(motion.y, 0);
+  box.max.x -= fmin(motion.x, 0);
+  box.max.y -= fmin(motion.y, 0);
+  return box;
+}
+
+void body_set_collision_layer(body_t *body, size_t layer) {
+  assert(layer < MAX_COLLISION_LAYERS);
+  body->collision_layer = layer;
+}
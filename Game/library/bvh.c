@@ -0,0 +1,193 @@
+#include "bvh.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define BVH_STACK_SIZE 64
+
+typedef struct bvh_item {
+  size_t id;
+  aabb_t box;
+} bvh_item_t;
+
+/**
+ * A node in the tree, covering the boxes of every item below it.
+ * Leaves hold the items [first, first + count); branches have a count of 0,
+ * with their left child directly after them and their right child at right.
+ */
+typedef struct bvh_node {
+  aabb_t bounds;
+  size_t first;
+  size_t count;
+  size_t right;
+} bvh_node_t;
+
+typedef struct bvh {
+  bvh_item_t *items;
+  size_t item_count;
+  size_t item_capacity;
+  bvh_node_t *nodes;
+  size_t node_count;
+  bool built;
+} bvh_t;
+
+const size_t BVH_INITIAL_SIZE = 16;
+const size_t BVH_LEAF_SIZE = 2;
+
+bvh_t *bvh_init(void) {
+  bvh_t *bvh = malloc(sizeof(bvh_t));
+  assert(bvh != NULL);
+  bvh->items = NULL;
+  bvh->item_count = 0;
+  bvh->item_capacity = 0;
+  bvh->nodes = NULL;
+  bvh->node_count = 0;
+  bvh->built = true;
+  return bvh;
+}
+
+void bvh_free(bvh_t *bvh) {
+  free(bvh->items);
+  free(bvh->nodes);
+  free(bvh);
+}
+
+void bvh_insert(bvh_t *bvh, size_t id, aabb_t box) {
+  if (bvh->item_count == bvh->item_capacity) {
+    bvh->item_capacity =
+        bvh->item_capacity == 0 ? BVH_INITIAL_SIZE : bvh->item_capacity * 2;
+    bvh->items = realloc(bvh->items, bvh->item_capacity * sizeof(bvh_item_t));
+    assert(bvh->items != NULL);
+  }
+  bvh->items[bvh->item_count++] = (bvh_item_t){.id = id, .box = box};
+  bvh->built = false;
+}
+
+size_t bvh_size(bvh_t *bvh) { return bvh->item_count; }
+
+aabb_t bvh_box_union(aabb_t box1, aabb_t box2) {
+  return (aabb_t){.min = {fmin(box1.min.x, box2.min.x),
+                          fmin(box1.min.y, box2.min.y)},
+                  .max = {fmax(box1.max.x, box2.max.x),
+                          fmax(box1.max.y, box2.max.y)}};
+}
+
+int compare_item_x(const void *item1, const void *item2) {
+  const aabb_t *box1 = &((const bvh_item_t *)item1)->box;
+  const aabb_t *box2 = &((const bvh_item_t *)item2)->box;
+  double center1 = box1->min.x + box1->max.x;
+  double center2 = box2->min.x + box2->max.x;
+  return (center1 > center2) - (center1 < center2);
+}
+
+int compare_item_y(const void *item1, const void *item2) {
+  const aabb_t *box1 = &((const bvh_item_t *)item1)->box;
+  const aabb_t *box2 = &((const bvh_item_t *)item2)->box;
+  double center1 = box1->min.y + box1->max.y;
+  double center2 = box2->min.y + box2->max.y;
+  return (center1 > center2) - (center1 < center2);
+}
+
+/**
+ * Builds the subtree over count items starting at first, and returns the
+ * index of its root. Splitting at the median keeps the tree balanced, so
+ * its depth is at most log2 of the number of items.
+ */
+size_t bvh_build_node(bvh_t *bvh, size_t first, size_t count) {
+  size_t index = bvh->node_count++;
+  aabb_t bounds = bvh->items[first].box;
+  for (size_t i = first + 1; i < first + count; i++) {
+    bounds = bvh_box_union(bounds, bvh->items[i].box);
+  }
+  bvh->nodes[index] =
+      (bvh_node_t){.bounds = bounds, .first = first, .count = count};
+  if (count <= BVH_LEAF_SIZE) {
+    return index;
+  }
+
+  bool split_x = bounds.max.x - bounds.min.x >= bounds.max.y - bounds.min.y;
+  qsort(&bvh->items[first], count, sizeof(bvh_item_t),
+        split_x ? compare_item_x : compare_item_y);
+  size_t half = count / 2;
+  bvh->nodes[index].count = 0;
+  bvh_build_node(bvh, first, half);
+  bvh->nodes[index].right = bvh_build_node(bvh, first + half, count - half);
+  return index;
+}
+
+void bvh_build(bvh_t *bvh) {
+  free(bvh->nodes);
+  bvh->nodes = NULL;
+  bvh->node_count = 0;
+  if (bvh->item_count > 0) {
+    // A binary tree with leaves of at least one item has under 2n nodes
+    bvh->nodes = malloc(2 * bvh->item_count * sizeof(bvh_node_t));
+    assert(bvh->nodes != NULL);
+    bvh_build_node(bvh, 0, bvh->item_count);
+  }
+  bvh->built = true;
+}
+
+void bvh_query(bvh_t *bvh, aabb_t box, bvh_hit_handler_t handler, void *aux) {
+  assert(bvh->built);
+  if (bvh->node_count == 0) {
+    return;
+  }
+  size_t stack[BVH_STACK_SIZE];
+  size_t depth = 0;
+  stack[depth++] = 0;
+  while (depth > 0) {
+    bvh_node_t *node = &bvh->nodes[stack[--depth]];
+    if (!aabb_overlaps(node->bounds, box)) {
+      continue;
+    }
+    if (node->count == 0) {
+      assert(depth + 2 <= BVH_STACK_SIZE);
+      stack[depth++] = node->right;
+      stack[depth++] = (size_t)(node - bvh->nodes) + 1;
+      continue;
+    }
+    for (size_t i = node->first; i < node->first + node->count; i++) {
+      if (aabb_overlaps(bvh->items[i].box, box)) {
+        handler(bvh->items[i].id, aux);
+      }
+    }
+  }
+}
+
+void bvh_query_segment(bvh_t *bvh, vector_t start, vector_t end,
+                       bvh_segment_handler_t handler, void *aux) {
+  assert(bvh->built);
+  if (bvh->node_count == 0) {
+    return;
+  }
+  vector_t delta = vec_subtract(end, start);
+  double reach = 1;
+  size_t stack[BVH_STACK_SIZE];
+  size_t depth = 0;
+  stack[depth++] = 0;
+  while (depth > 0) {
+    bvh_node_t *node = &bvh->nodes[stack[--depth]];
+    if (aabb_segment_entry(node->bounds, start, delta, reach) == INFINITY) {
+      continue;
+    }
+    if (node->count == 0) {
+      // Push the nearer child last, so it is searched first
+      size_t left = (size_t)(node - bvh->nodes) + 1;
+      double left_entry =
+          aabb_segment_entry(bvh->nodes[left].bounds, start, delta, reach);
+      double right_entry = aabb_segment_entry(bvh->nodes[node->right].bounds,
+                                              start, delta, reach);
+      assert(depth + 2 <= BVH_STACK_SIZE);
+      stack[depth++] = left_entry < right_entry ? node->right : left;
+      stack[depth++] = left_entry < right_entry ? left : node->right;
+      continue;
+    }
+    for (size_t i = node->first; i < node->first + node->count; i++) {
+      if (aabb_segment_entry(bvh->items[i].box, start, delta, reach) !=
+          INFINITY) {
+        reach = fmin(reach, handler(bvh->items[i].id, reach, aux));
+      }
+    }
+  }
+}
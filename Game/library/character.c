@@ -15,7 +15,8 @@ const double UPGRADE_AMOUNT = 0.1;
 const double USER_SPEED = 250;
 
 typedef struct character {
-  body_t *char_body;
+  scene_t *scene;
+  body_handle_t char_body;
   style_info_t char_style;
   weapon_t *curr_weapon;
   weapon_t *weapon1;
@@ -131,13 +132,13 @@ double set_healing_factor(style_info_t style) {
   }
 }
 
-character_t *character_init(scene_t *scene, list_t *vertices,
-                            computer_info_t *char_info, style_info_t style) {
+character_t *character_init(scene_t *scene, polygon_t *vertices,
+                            computer_info_t char_info, style_info_t style) {
   character_t *character = malloc(sizeof(character_t));
-  body_t *char_body =
-      body_init_with_info(vertices, set_mass(style), INTERNAL_BODY_COLOR,
-                          char_info, (free_func_t)free);
-  character->char_body = char_body;
+  body_t *char_body = body_init_from_polygon(vertices, set_mass(style),
+                                             INTERNAL_BODY_COLOR, NULL, NULL);
+  body_set_tag(char_body, comp_info_tag(char_info));
+  character->scene = scene;
   character->char_style = style;
   character->weapon1 = set_primary(style);
   character->weapon2 = set_secondary(style);
@@ -148,7 +149,9 @@ character_t *character_init(scene_t *scene, list_t *vertices,
   character->speed_multiplier = set_speed_multiplier(style);
   character->healing_factor = set_healing_factor(style);
   character->upgrade_factor = 1.0;
+  body_set_collision_layer(char_body, CHARACTER_LAYER);
   scene_add_body(scene, char_body);
+  character->char_body = body_get_handle(char_body);
   return character;
 }
 
@@ -159,28 +162,34 @@ void character_free(character_t *character) {
 }
 
 body_t *character_get_body(character_t *character) {
-  return character->char_body;
+  body_t *body =
+      scene_get_body_by_handle(character->scene, character->char_body);
+  assert(body != NULL);
+  return body;
 }
 
 vector_t character_vector_facing(character_t *character) {
-  return vec_rotate((vector_t){1, 0}, body_get_rotation(character->char_body));
+  return vec_rotate((vector_t){1, 0},
+                    body_get_rotation(character_get_body(character)));
 }
 
 void character_shoot(scene_t *scene, character_t *character, double mass) {
+  body_t *char_body = character_get_body(character);
   weapon_shoot(
       scene, character->curr_weapon,
       vec_get_unit_vector(character_vector_facing(character), VEC_ZERO),
-      character->char_body, body_get_rotation(character->char_body), mass);
+      char_body, body_get_rotation(char_body), mass);
 }
 
 void character_set_rotation(character_t *character, double angle) {
-  body_set_rotation(character->char_body, angle);
+  body_set_rotation(character_get_body(character), angle);
 }
 
 void character_process_damage(character_t *character, double enemy_dmg_mult) {
-  double damage = body_damage_collisions(character->char_body);
+  body_t *char_body = character_get_body(character);
+  double damage = body_damage_collisions(char_body);
   character->health -= enemy_dmg_mult * damage;
-  body_add_damage(character->char_body, -damage);
+  body_add_damage(char_body, -damage);
 }
 
 double character_get_health(character_t *character) {
@@ -192,7 +201,7 @@ bool character_is_alive(character_t *character) {
 }
 
 void character_set_velocity(character_t *character, vector_t velocity) {
-  body_set_velocity(character->char_body,
+  body_set_velocity(character_get_body(character),
                     vec_multiply(character->speed_multiplier, velocity));
 }
 
@@ -282,20 +291,18 @@ double character_get_healing_factor(character_t *character) {
 style_info_t character_style(character_t *player) { return player->char_style; }
 
 void create_shield(scene_t *scene, character_t *player) {
-  vector_t *center = malloc(sizeof(vector_t));
-  *center = body_get_centroid(player->char_body);
-  list_t *vertices = create_sector(SHIELD_RADIUS, center, 2 * M_PI, false);
-  computer_info_t *shield_info = malloc(sizeof(computer_info_t));
-  *shield_info = SHIELD;
-  body_t *shield =
-      body_init_with_info(vertices, INFINITY, SHIELD_COLOR, shield_info, free);
+  vector_t center = body_get_centroid(character_get_body(player));
+  body_t *shield = body_init_circle(center, SHIELD_RADIUS, INFINITY,
+                                    SHIELD_COLOR, NULL, NULL);
+  body_set_tag(shield, comp_info_tag(SHIELD));
+  body_set_collision_layer(shield, SHIELD_LAYER);
   scene_add_body(scene, shield);
-  list_t *enemies = scene_bodies_with_comp_info(scene, ENEMY);
-  for (size_t i = 0; i < list_size(enemies); i++) {
-    body_t *enemy = list_get(enemies, i);
-    create_physics_collision(scene, SHIELD_ELASTICITY, enemy, shield);
-  }
-  list_free(enemies);
+}
+
+void create_shield_collisions(scene_t *scene) {
+  create_layer_physics_collision(scene, SHIELD_ELASTICITY, ENEMY_LAYER,
+                                 SHIELD_LAYER);
+  create_layer_damaging_collision(scene, SHIELD_LAYER, ENEMY_BULLET_LAYER);
 }
 
 weapon_t *character_weapon(character_t *player) { return player->curr_weapon; }
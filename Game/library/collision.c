@@ -1,33 +1,42 @@
 #include "collision.h"
+#include "gjk.h"
 #include "list.h"
 #include "polygon.h"
 #include "vector.h"
+#include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-list_t *get_axes(list_t *shape) {
-  list_t *axes = list_init(list_size(shape), (free_func_t)free);
-  for (size_t i = 0; i < list_size(shape); i++) {
-    vector_t *vertex1 = (vector_t *)list_get(shape, i);
-    vector_t *vertex2 =
-        (vector_t *)list_get(shape, (i + 1 == list_size(shape) ? 0 : i + 1));
-    vector_t edge = vec_subtract(*vertex1, *vertex2);
-    double norm_x = edge.y;
-    double norm_y = -edge.x;
-    vector_t *axis = malloc(sizeof(vector_t));
-    double magnitude = sqrt((norm_x * norm_x) + (norm_y * norm_y));
-    *axis = vec_multiply(1 / magnitude, (vector_t){norm_x, norm_y});
-    list_add(axes, axis);
-  }
-  return axes;
-}
-
-vector_t get_projection(list_t *shape, vector_t *axis) {
-  double min = vec_dot(*axis, *(vector_t *)list_get(shape, 0));
+const size_t SAT_MAX_AXES = 8;
+const double BOX_TOLERANCE = 1e-9;
+const double REFERENCE_EDGE_TOLERANCE = 1e-3;
+const double CONTACT_TOLERANCE = 1e-9;
+
+/**
+ * Computes the unit normal of the edge from a shape's vertex at index i to
+ * the next vertex.
+ */
+vector_t get_edge_normal(polygon_view_t shape, size_t i) {
+  const vector_t *vertices = shape.vertices;
+  vector_t edge =
+      vec_subtract(vertices[i], vertices[i + 1 == shape.size ? 0 : i + 1]);
+  double norm_x = edge.y;
+  double norm_y = -edge.x;
+  double magnitude = sqrt((norm_x * norm_x) + (norm_y * norm_y));
+  return vec_multiply(1 / magnitude, (vector_t){norm_x, norm_y});
+}
+
+vector_t get_projection(polygon_view_t shape, vector_t axis) {
+  size_t n = shape.size;
+  const vector_t *vertices = shape.vertices;
+  double min = vec_dot(axis, vertices[0]);
   double max = min;
-  for (size_t i = 1; i < list_size(shape); i++) {
-    double dot = vec_dot(*axis, *(vector_t *)list_get(shape, i));
+  for (size_t i = 1; i < n; i++) {
+    double dot = vec_dot(axis, vertices[i]);
     if (dot < min) {
       min = dot;
     } else if (dot > max) {
@@ -46,49 +55,831 @@ bool detected_overlap(vector_t projection1, vector_t projection2) {
 }
 
 double get_overlap(vector_t projection1, vector_t projection2) {
-  return projection1.y >= projection2.x ? projection1.y - projection2.x
-                                        : projection2.y - projection1.x;
+  return fmin(projection1.y - projection2.x, projection2.y - projection1.x);
 }
 
-collision_info_t check_axes(list_t *axes, list_t *shape1, list_t *shape2,
-                            double *overlap, vector_t *smallest_axis) {
-  for (size_t i = 0; i < list_size(axes); i++) {
-    vector_t *axis = list_get(axes, i);
-    vector_t projection1 = get_projection(shape1, axis);
-    vector_t projection2 = get_projection(shape2, axis);
-    if (!detected_overlap(projection1, projection2)) {
-      return (collision_info_t){.collided = false, .axis = VEC_ZERO};
+/**
+ * Projects both shapes onto an axis, recording the overlap if it is the
+ * smallest so far, with the axis flipped if needed to point from shape1
+ * towards shape2. Returns false if the axis separates the shapes.
+ */
+bool check_axis(vector_t axis, polygon_view_t shape1, polygon_view_t shape2,
+                double *overlap, vector_t *smallest_axis) {
+  vector_t projection1 = get_projection(shape1, axis);
+  vector_t projection2 = get_projection(shape2, axis);
+  if (!detected_overlap(projection1, projection2)) {
+    return false;
+  }
+  double forward = projection1.y - projection2.x;
+  double backward = projection2.y - projection1.x;
+  double o = fmin(forward, backward);
+  if (o < *overlap) {
+    *overlap = o;
+    *smallest_axis = vec_multiply(forward <= backward ? o : -o, axis);
+  }
+  return true;
+}
+
+/**
+ * Tests the normal of each edge of axes_shape, computing each normal as it
+ * goes so that no axis list is needed.
+ * Returns false as soon as the projections are disjoint on some axis.
+ */
+bool check_axes(polygon_view_t axes_shape, polygon_view_t shape1,
+                polygon_view_t shape2, double *overlap,
+                vector_t *smallest_axis) {
+  for (size_t i = 0; i < axes_shape.size; i++) {
+    if (!check_axis(get_edge_normal(axes_shape, i), shape1, shape2, overlap,
+                    smallest_axis)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Acts like check_axes(), but tests precomputed normals.
+ */
+bool check_normals(normal_view_t axes, polygon_view_t shape1,
+                   polygon_view_t shape2, double *overlap,
+                   vector_t *smallest_axis) {
+  for (size_t i = 0; i < axes.size; i++) {
+    if (!check_axis(axes.normals[i], shape1, shape2, overlap, smallest_axis)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+collision_info_t find_collision_views(polygon_view_t shape1,
+                                      polygon_view_t shape2) {
+  double overlap = INFINITY;
+  vector_t smallest_axis = VEC_ZERO;
+  bool collided =
+      check_axes(shape1, shape1, shape2, &overlap, &smallest_axis) &&
+      check_axes(shape2, shape1, shape2, &overlap, &smallest_axis);
+  if (!collided) {
+    return (collision_info_t){.collided = false, .axis = VEC_ZERO};
+  }
+  return (collision_info_t){.collided = true, .axis = smallest_axis};
+}
+
+collision_info_t find_collision_normals(polygon_view_t shape1,
+                                        normal_view_t normals1,
+                                        polygon_view_t shape2,
+                                        normal_view_t normals2) {
+  double overlap = INFINITY;
+  vector_t smallest_axis = VEC_ZERO;
+  bool collided =
+      check_normals(normals1, shape1, shape2, &overlap, &smallest_axis) &&
+      check_normals(normals2, shape1, shape2, &overlap, &smallest_axis);
+  if (!collided) {
+    return (collision_info_t){.collided = false, .axis = VEC_ZERO};
+  }
+  return (collision_info_t){.collided = true, .axis = smallest_axis};
+}
+
+collision_info_t find_collision(polygon_t *shape1, polygon_t *shape2) {
+  collision_info_t collision_info = find_collision_views(
+      polygon_get_view(shape1), polygon_get_view(shape2));
+  polygon_free(shape1);
+  polygon_free(shape2);
+  return collision_info;
+}
+
+/**
+ * Wraps an overlap along a unit axis into a collision, flipping the axis if
+ * needed so that it points from from towards to.
+ */
+collision_info_t make_collision(double overlap, vector_t axis, vector_t from,
+                                vector_t to) {
+  if (vec_dot(axis, vec_subtract(to, from)) < 0) {
+    axis = vec_negate(axis);
+  }
+  return (collision_info_t){.collided = true,
+                            .axis = vec_multiply(overlap, axis)};
+}
+
+collision_info_t find_circle_collision(vector_t center1, double radius1,
+                                       vector_t center2, double radius2) {
+  vector_t distance = vec_subtract(center2, center1);
+  double reach = radius1 + radius2;
+  double distance_squared = vec_dot(distance, distance);
+  if (distance_squared > reach * reach) {
+    return (collision_info_t){.collided = false, .axis = VEC_ZERO};
+  }
+  double length = sqrt(distance_squared);
+  // Concentric circles can be pushed apart in any direction
+  vector_t axis =
+      length > 0 ? vec_multiply(1 / length, distance) : (vector_t){1, 0};
+  return (collision_info_t){.collided = true,
+                            .axis = vec_multiply(reach - length, axis)};
+}
+
+/**
+ * Acts like find_circle_polygon_collision(), but takes the polygon's edge
+ * normals if they are already known. If normals.normals is NULL, they are
+ * computed from the polygon's edges as they are tested.
+ */
+collision_info_t find_circle_normals_collision(vector_t center, double radius,
+                                               polygon_view_t shape,
+                                               normal_view_t normals) {
+  double overlap = INFINITY;
+  vector_t smallest_axis = VEC_ZERO;
+  vector_t shape_center = VEC_ZERO;
+  size_t closest = 0;
+  double closest_distance = INFINITY;
+  for (size_t i = 0; i < shape.size; i++) {
+    vector_t offset = vec_subtract(shape.vertices[i], center);
+    double distance = vec_dot(offset, offset);
+    if (distance < closest_distance) {
+      closest_distance = distance;
+      closest = i;
+    }
+    shape_center = vec_add(shape_center, shape.vertices[i]);
+  }
+  shape_center = vec_multiply(1.0 / shape.size, shape_center);
+
+  // Besides the edge normals, the only axis that can separate a circle from
+  // a polygon points from its center to the polygon's nearest vertex
+  size_t axis_count = normals.normals != NULL ? normals.size : shape.size;
+  for (size_t i = 0; i <= axis_count; i++) {
+    vector_t axis;
+    if (i < axis_count) {
+      axis = normals.normals != NULL ? normals.normals[i]
+                                     : get_edge_normal(shape, i);
+    } else if (closest_distance > 0) {
+      axis = vec_multiply(1 / sqrt(closest_distance),
+                          vec_subtract(shape.vertices[closest], center));
     } else {
-      double o = get_overlap(projection1, projection2);
-      if (o < *overlap) {
-        *overlap = o;
-        *smallest_axis = vec_multiply(*overlap, *axis);
+      break;
+    }
+    vector_t projection = get_projection(shape, axis);
+    double circle_center = vec_dot(axis, center);
+    vector_t circle_projection = {circle_center - radius,
+                                  circle_center + radius};
+    if (!detected_overlap(circle_projection, projection)) {
+      return (collision_info_t){.collided = false, .axis = VEC_ZERO};
+    }
+    double o = get_overlap(circle_projection, projection);
+    if (o < overlap) {
+      overlap = o;
+      smallest_axis = axis;
+    }
+  }
+  return make_collision(overlap, smallest_axis, center, shape_center);
+}
+
+collision_info_t find_circle_polygon_collision(vector_t center, double radius,
+                                               polygon_view_t shape) {
+  return find_circle_normals_collision(
+      center, radius, shape, (normal_view_t){.normals = NULL, .size = 0});
+}
+
+/**
+ * Acts like find_body_collision(), but polygons with more distinct edge
+ * normals between them than SAT_MAX_AXES are tested with GJK, starting
+ * from the pair's cached direction if there is one.
+ */
+collision_info_t find_body_collision_cached(body_t *body1, body_t *body2,
+                                            vector_t *direction) {
+  bool circle1 = body_get_shape_kind(body1) == SHAPE_CIRCLE;
+  bool circle2 = body_get_shape_kind(body2) == SHAPE_CIRCLE;
+  if (circle1 && circle2) {
+    return find_circle_collision(
+        body_get_centroid(body1), body_get_radius(body1),
+        body_get_centroid(body2), body_get_radius(body2));
+  }
+  if (circle1) {
+    return find_circle_normals_collision(
+        body_get_centroid(body1), body_get_radius(body1),
+        body_get_shape_view(body2), body_get_normals(body2));
+  }
+  if (circle2) {
+    collision_info_t info = find_circle_normals_collision(
+        body_get_centroid(body2), body_get_radius(body2),
+        body_get_shape_view(body1), body_get_normals(body1));
+    info.axis = vec_negate(info.axis);
+    return info;
+  }
+  normal_view_t normals1 = body_get_normals(body1);
+  normal_view_t normals2 = body_get_normals(body2);
+  if (normals1.size + normals2.size > SAT_MAX_AXES) {
+    collision_info_t info = {.collided = false, .axis = VEC_ZERO};
+    info.collided =
+        gjk_find_collision(body_get_shape_view(body1),
+                           body_get_shape_view(body2), direction, &info.axis);
+    return info;
+  }
+  return find_collision_normals(body_get_shape_view(body1), normals1,
+                                body_get_shape_view(body2), normals2);
+}
+
+collision_info_t find_body_collision(body_t *body1, body_t *body2) {
+  return find_body_collision_cached(body1, body2, NULL);
+}
+
+/**
+ * Projects a body's current shape onto an axis, in closed form for circles.
+ */
+vector_t get_body_projection(body_t *body, vector_t axis) {
+  if (body_get_shape_kind(body) == SHAPE_CIRCLE) {
+    double center = vec_dot(axis, body_get_centroid(body));
+    double radius = body_get_radius(body);
+    return (vector_t){center - radius, center + radius};
+  }
+  return get_projection(body_get_shape_view(body), axis);
+}
+
+/**
+ * Narrows the span of the sweep [enter, exit] to the times at which two
+ * projections onto an axis overlap, as the first moves speed along the axis
+ * over the sweep and ends at projection1. Returns false once the span is
+ * empty, which means the axis separates the shapes throughout the sweep.
+ */
+bool sweep_axis(vector_t projection1, vector_t projection2, double speed,
+                double *enter, double *exit) {
+  if (speed == 0) {
+    return detected_overlap(projection1, projection2);
+  }
+  double touch = 1 + (projection2.x - projection1.y) / speed;
+  double leave = 1 + (projection2.y - projection1.x) / speed;
+  *enter = fmax(*enter, fmin(touch, leave));
+  *exit = fmin(*exit, fmax(touch, leave));
+  return *enter <= *exit;
+}
+
+/**
+ * Sweeps body1 against each normal of a polygonal body, as in
+ * sweep_axis(). Circles have no normals to test.
+ */
+bool sweep_normals(body_t *axes_body, body_t *body1, body_t *body2,
+                   vector_t motion, double *enter, double *exit) {
+  if (body_get_shape_kind(axes_body) == SHAPE_CIRCLE) {
+    return true;
+  }
+  normal_view_t normals = body_get_normals(axes_body);
+  for (size_t i = 0; i < normals.size; i++) {
+    vector_t axis = normals.normals[i];
+    if (!sweep_axis(get_body_projection(body1, axis),
+                    get_body_projection(body2, axis), vec_dot(motion, axis),
+                    enter, exit)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Solves for when a moving circle first comes within radius of a fixed
+ * center, if it does during the sweep.
+ */
+double find_circle_time_of_impact(vector_t center1, vector_t motion,
+                                  vector_t center2, double radius) {
+  vector_t start = vec_subtract(vec_subtract(center1, motion), center2);
+  double c = vec_dot(start, start) - radius * radius;
+  if (c <= 0) {
+    return 0;
+  }
+  double a = vec_dot(motion, motion);
+  double b = 2 * vec_dot(start, motion);
+  double discriminant = b * b - 4 * a * c;
+  if (a == 0 || discriminant < 0) {
+    return INFINITY;
+  }
+  double time = (-b - sqrt(discriminant)) / (2 * a);
+  return time >= 0 && time <= 1 ? time : INFINITY;
+}
+
+double find_body_time_of_impact(body_t *body1, body_t *body2) {
+  vector_t motion = body_get_motion(body1);
+  if (body_get_shape_kind(body1) == SHAPE_CIRCLE &&
+      body_get_shape_kind(body2) == SHAPE_CIRCLE) {
+    return find_circle_time_of_impact(
+        body_get_centroid(body1), motion, body_get_centroid(body2),
+        body_get_radius(body1) + body_get_radius(body2));
+  }
+  // Translated convex polygons can only be separated by their edge normals.
+  // A circle sweeps out a capsule, whose sides are also tested; its rounded
+  // ends are not, so a hit may be reported just before a polygon's corner.
+  double enter = 0;
+  double exit = 1;
+  if (!sweep_normals(body1, body1, body2, motion, &enter, &exit) ||
+      !sweep_normals(body2, body1, body2, motion, &enter, &exit)) {
+    return INFINITY;
+  }
+  double distance = sqrt(vec_dot(motion, motion));
+  if (distance > 0) {
+    vector_t side = vec_multiply(1 / distance, (vector_t){-motion.y, motion.x});
+    if (!sweep_axis(get_body_projection(body1, side),
+                    get_body_projection(body2, side), 0, &enter, &exit)) {
+      return INFINITY;
+    }
+  }
+  return enter;
+}
+
+bool find_body_circle_overlap(body_t *body, vector_t center, double radius) {
+  if (body_get_shape_kind(body) == SHAPE_CIRCLE) {
+    return find_circle_collision(center, radius, body_get_centroid(body),
+                                 body_get_radius(body))
+        .collided;
+  }
+  return find_circle_normals_collision(center, radius,
+                                       body_get_shape_view(body),
+                                       body_get_normals(body))
+      .collided;
+}
+
+/**
+ * Solves for where a segment first enters a circle, as in
+ * find_body_segment_hit().
+ */
+double find_circle_segment_hit(vector_t center, double radius, vector_t start,
+                               vector_t delta, double max_fraction,
+                               vector_t *normal) {
+  vector_t offset = vec_subtract(start, center);
+  double a = vec_dot(delta, delta);
+  double b = 2 * vec_dot(offset, delta);
+  double c = vec_dot(offset, offset) - radius * radius;
+  double discriminant = b * b - 4 * a * c;
+  if (c <= 0 || a == 0 || discriminant < 0) {
+    return INFINITY;
+  }
+  double fraction = (-b - sqrt(discriminant)) / (2 * a);
+  if (fraction < 0 || fraction > max_fraction) {
+    return INFINITY;
+  }
+  vector_t point = vec_add(offset, vec_multiply(fraction, delta));
+  *normal = vec_multiply(1 / radius, point);
+  return fraction;
+}
+
+double find_body_segment_hit(body_t *body, vector_t start, vector_t delta,
+                             double max_fraction, vector_t *normal) {
+  if (body_get_shape_kind(body) == SHAPE_CIRCLE) {
+    return find_circle_segment_hit(body_get_centroid(body),
+                                   body_get_radius(body), start, delta,
+                                   max_fraction, normal);
+  }
+  // Clip the segment to the inside of each edge in turn (Cyrus-Beck)
+  polygon_view_t shape = body_get_shape_view(body);
+  double winding = 0;
+  for (size_t i = 0; i < shape.size; i++) {
+    winding += vec_cross(shape.vertices[i],
+                         shape.vertices[i + 1 == shape.size ? 0 : i + 1]);
+  }
+  double enter = 0;
+  double exit = max_fraction;
+  vector_t entry_normal = VEC_ZERO;
+  bool entered = false;
+  for (size_t i = 0; i < shape.size; i++) {
+    vector_t vertex = shape.vertices[i];
+    vector_t edge =
+        vec_subtract(shape.vertices[i + 1 == shape.size ? 0 : i + 1], vertex);
+    vector_t outward = winding > 0 ? (vector_t){edge.y, -edge.x}
+                                   : (vector_t){-edge.y, edge.x};
+    double distance = vec_dot(outward, vec_subtract(vertex, start));
+    double speed = vec_dot(outward, delta);
+    if (speed == 0) {
+      if (distance < 0) {
+        return INFINITY;
       }
+      continue;
+    }
+    double fraction = distance / speed;
+    if (speed < 0 && fraction > enter) {
+      enter = fraction;
+      entry_normal = outward;
+      entered = true;
+    } else if (speed > 0) {
+      exit = fmin(exit, fraction);
+    }
+    if (enter > exit) {
+      return INFINITY;
     }
   }
-  return (collision_info_t){.collided = true, .axis = *smallest_axis};
-}
-
-collision_info_t find_collision(list_t *shape1, list_t *shape2) {
-  list_t *axes1 = get_axes(shape1);
-  list_t *axes2 = get_axes(shape2);
-  double *overlap = malloc(sizeof(double));
-  *overlap = INFINITY;
-  vector_t *smallest_axis = malloc(sizeof(vector_t));
-  collision_info_t collided1 =
-      check_axes(axes1, shape1, shape2, overlap, smallest_axis);
-  collision_info_t collided2 =
-      !collided1.collided
-          ? collided1
-          : check_axes(axes2, shape1, shape2, overlap, smallest_axis);
-  collision_info_t collision_info =
-      (collision_info_t){.collided = collided1.collided && collided2.collided,
-                         .axis = *smallest_axis};
-  free(smallest_axis);
-  free(overlap);
-  list_free(axes1);
-  list_free(axes2);
-  list_free(shape1);
-  list_free(shape2);
-  return collision_info;
+  // A segment that was never outside an edge started inside the shape
+  if (!entered) {
+    return INFINITY;
+  }
+  *normal = vec_multiply(1 / sqrt(vec_dot(entry_normal, entry_normal)),
+                         entry_normal);
+  return enter;
+}
+
+/**
+ * Finds the edge of a shape whose outward normal leans furthest along a
+ * direction, storing that normal. Works for either winding order.
+ */
+size_t find_support_edge(polygon_view_t shape, vector_t direction,
+                         vector_t *normal) {
+  double winding = 0;
+  for (size_t i = 0; i < shape.size; i++) {
+    winding += vec_cross(shape.vertices[i],
+                         shape.vertices[i + 1 == shape.size ? 0 : i + 1]);
+  }
+  size_t best = 0;
+  double best_dot = -INFINITY;
+  for (size_t i = 0; i < shape.size; i++) {
+    vector_t edge_normal = get_edge_normal(shape, i);
+    // get_edge_normal() points inwards on counterclockwise shapes
+    if (winding > 0) {
+      edge_normal = vec_negate(edge_normal);
+    }
+    double dot = vec_dot(edge_normal, direction);
+    if (dot > best_dot) {
+      best_dot = dot;
+      best = i;
+      *normal = edge_normal;
+    }
+  }
+  return best;
+}
+
+/**
+ * Clips a segment to the side of a line where vec_dot(direction, point) is
+ * at most offset. Returns false if the whole segment is cut off; otherwise a
+ * point cut off is moved to where the segment crosses the line.
+ */
+bool clip_segment(vector_t points[2], vector_t direction, double offset) {
+  double distance1 = vec_dot(direction, points[0]) - offset;
+  double distance2 = vec_dot(direction, points[1]) - offset;
+  if (distance1 > 0 && distance2 > 0) {
+    return false;
+  }
+  if (distance1 > 0 || distance2 > 0) {
+    size_t outside = distance1 > 0 ? 0 : 1;
+    double t = distance1 / (distance1 - distance2);
+    points[outside] = vec_add(
+        points[0], vec_multiply(t, vec_subtract(points[1], points[0])));
+  }
+  return true;
+}
+
+/**
+ * Builds the manifold of two colliding polygons. The edge facing most
+ * squarely along the normal, on either shape, is the reference edge; the
+ * other shape's edge facing it is clipped to its ends, and the points that
+ * end up behind the reference edge are the contact points.
+ * A feature id packs whether the second shape holds the reference edge, the
+ * reference edge's index, the incident edge's index, and which end of it
+ * the point came from.
+ */
+void find_polygon_manifold(polygon_view_t shape1, polygon_view_t shape2,
+                           contact_manifold_t *manifold) {
+  vector_t normal1, normal2;
+  size_t edge1 = find_support_edge(shape1, manifold->normal, &normal1);
+  size_t edge2 =
+      find_support_edge(shape2, vec_negate(manifold->normal), &normal2);
+  bool flip = vec_dot(normal2, vec_negate(manifold->normal)) >
+              vec_dot(normal1, manifold->normal) + REFERENCE_EDGE_TOLERANCE;
+  polygon_view_t reference = flip ? shape2 : shape1;
+  polygon_view_t incident = flip ? shape1 : shape2;
+  size_t reference_edge = flip ? edge2 : edge1;
+  vector_t reference_normal = flip ? normal2 : normal1;
+  vector_t unused;
+  size_t incident_edge =
+      find_support_edge(incident, vec_negate(reference_normal), &unused);
+
+  size_t reference_next = reference_edge + 1 == reference.size
+                              ? 0
+                              : reference_edge + 1;
+  size_t incident_next =
+      incident_edge + 1 == incident.size ? 0 : incident_edge + 1;
+  vector_t start = reference.vertices[reference_edge];
+  vector_t end = reference.vertices[reference_next];
+  vector_t tangent = vec_subtract(end, start);
+  vector_t points[2] = {incident.vertices[incident_edge],
+                        incident.vertices[incident_next]};
+  uint32_t id = (uint32_t)flip << 31 | (uint32_t)reference_edge << 16 |
+                (uint32_t)incident_edge << 1;
+  uint32_t features[2] = {id, id | 1};
+  size_t candidates = 2;
+  if (!clip_segment(points, vec_negate(tangent), -vec_dot(tangent, start)) ||
+      !clip_segment(points, tangent, vec_dot(tangent, end))) {
+    points[0] = incident.vertices[incident_edge];
+    candidates = 1;
+  }
+
+  manifold->point_count = 0;
+  double deepest = INFINITY;
+  size_t deepest_index = 0;
+  for (size_t i = 0; i < candidates; i++) {
+    double separation =
+        vec_dot(reference_normal, vec_subtract(points[i], start));
+    if (separation < deepest) {
+      deepest = separation;
+      deepest_index = i;
+    }
+    if (separation <= CONTACT_TOLERANCE) {
+      manifold->points[manifold->point_count] = vec_subtract(
+          points[i], vec_multiply(separation / 2, reference_normal));
+      manifold->features[manifold->point_count++] = features[i];
+    }
+  }
+  // Rounding can leave both points just outside; keep the deeper one
+  if (manifold->point_count == 0) {
+    manifold->points[0] = vec_subtract(
+        points[deepest_index], vec_multiply(deepest / 2, reference_normal));
+    manifold->features[0] = features[deepest_index];
+    manifold->point_count = 1;
+  }
+}
+
+collision_info_t find_body_manifold(body_t *body1, body_t *body2,
+                                    vector_t *direction,
+                                    contact_manifold_t *manifold) {
+  collision_info_t info = find_body_collision_cached(body1, body2, direction);
+  if (!info.collided || manifold == NULL) {
+    return info;
+  }
+  double depth = sqrt(vec_dot(info.axis, info.axis));
+  vector_t normal;
+  if (depth > 0) {
+    normal = vec_multiply(1 / depth, info.axis);
+  } else {
+    // Shapes that only just touch have no axis; push along their centers
+    normal = vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+    double length = sqrt(vec_dot(normal, normal));
+    normal = length > 0 ? vec_multiply(1 / length, normal) : (vector_t){1, 0};
+  }
+  manifold->normal = normal;
+  manifold->depth = depth;
+
+  bool circle1 = body_get_shape_kind(body1) == SHAPE_CIRCLE;
+  bool circle2 = body_get_shape_kind(body2) == SHAPE_CIRCLE;
+  if (circle1 || circle2) {
+    // A circle touches anything at its point furthest along the normal
+    vector_t center = circle1 ? body_get_centroid(body1)
+                              : body_get_centroid(body2);
+    double reach = (circle1 ? body_get_radius(body1) : body_get_radius(body2)) -
+                   depth / 2;
+    manifold->points[0] =
+        vec_add(center, vec_multiply(circle1 ? reach : -reach, normal));
+    manifold->features[0] = 0;
+    manifold->point_count = 1;
+  } else {
+    find_polygon_manifold(body_get_shape_view(body1),
+                          body_get_shape_view(body2), manifold);
+  }
+  return info;
+}
+
+bool collision_box_from_body(body_t *body, collision_box_t *box) {
+  polygon_view_t view = body_get_shape_view(body);
+  if (body_get_shape_kind(body) != SHAPE_POLYGON || view.size != 4 ||
+      body_get_normals(body).size != 2) {
+    return false;
+  }
+  const vector_t *vertices = view.vertices;
+  vector_t width = vec_subtract(vertices[1], vertices[0]);
+  vector_t height = vec_subtract(vertices[2], vertices[1]);
+  double width_length = sqrt(vec_dot(width, width));
+  double height_length = sqrt(vec_dot(height, height));
+  if (fabs(vec_dot(width, height)) >
+      BOX_TOLERANCE * width_length * height_length) {
+    return false;
+  }
+  *box = (collision_box_t){
+      .center = vec_multiply(0.5, vec_add(vertices[0], vertices[2])),
+      .direction = vec_multiply(1 / width_length, width),
+      .half_width = width_length / 2,
+      .half_height = height_length / 2};
+  return true;
+}
+
+/**
+ * The boxes of a batched test, with one array per field so that
+ * neighbouring boxes load straight into one vector register.
+ * overlap and axis_x/axis_y hold each box's smallest overlap so far,
+ * and bit i of separated is set once some axis separates box i.
+ */
+typedef struct {
+  double center_x[COLLISION_BATCH_MAX];
+  double center_y[COLLISION_BATCH_MAX];
+  double direction_x[COLLISION_BATCH_MAX];
+  double direction_y[COLLISION_BATCH_MAX];
+  double half_width[COLLISION_BATCH_MAX];
+  double half_height[COLLISION_BATCH_MAX];
+  double overlap[COLLISION_BATCH_MAX];
+  double axis_x[COLLISION_BATCH_MAX];
+  double axis_y[COLLISION_BATCH_MAX];
+  uint32_t separated;
+} box_packet_t;
+
+#ifdef __SSE2__
+
+/**
+ * Records the projections of the shape and two boxes, starting at lane,
+ * onto one axis per box, like check_axis() does for a single pair.
+ */
+void packet_record_pair(box_packet_t *packet, size_t lane, __m128d shape_min,
+                        __m128d shape_max, __m128d box_min, __m128d box_max,
+                        __m128d axis_x, __m128d axis_y) {
+  __m128d separated = _mm_or_pd(_mm_cmplt_pd(shape_max, box_min),
+                                _mm_cmplt_pd(box_max, shape_min));
+  packet->separated |= (uint32_t)_mm_movemask_pd(separated) << lane;
+  __m128d forward = _mm_sub_pd(shape_max, box_min);
+  __m128d backward = _mm_sub_pd(box_max, shape_min);
+  __m128d overlap = _mm_min_pd(forward, backward);
+  __m128d is_forward = _mm_cmple_pd(forward, backward);
+  __m128d negated = _mm_sub_pd(_mm_setzero_pd(), overlap);
+  __m128d signed_overlap = _mm_or_pd(_mm_and_pd(is_forward, overlap),
+                                     _mm_andnot_pd(is_forward, negated));
+  __m128d best = _mm_loadu_pd(&packet->overlap[lane]);
+  __m128d smaller = _mm_cmplt_pd(overlap, best);
+  __m128d old_x = _mm_loadu_pd(&packet->axis_x[lane]);
+  __m128d old_y = _mm_loadu_pd(&packet->axis_y[lane]);
+  __m128d new_x = _mm_mul_pd(axis_x, signed_overlap);
+  __m128d new_y = _mm_mul_pd(axis_y, signed_overlap);
+  _mm_storeu_pd(&packet->overlap[lane],
+                _mm_or_pd(_mm_and_pd(smaller, overlap),
+                          _mm_andnot_pd(smaller, best)));
+  _mm_storeu_pd(&packet->axis_x[lane],
+                _mm_or_pd(_mm_and_pd(smaller, new_x),
+                          _mm_andnot_pd(smaller, old_x)));
+  _mm_storeu_pd(&packet->axis_y[lane],
+                _mm_or_pd(_mm_and_pd(smaller, new_y),
+                          _mm_andnot_pd(smaller, old_y)));
+}
+
+/**
+ * Projects the boxes onto one of the shape's normals, whose projection of
+ * the shape is already known. A box projects to its center plus or minus
+ * its half sides scaled by how far each side leans onto the normal.
+ */
+void packet_test_normal(box_packet_t *packet, size_t count, vector_t normal,
+                        vector_t projection) {
+  const __m128d sign = _mm_set1_pd(-0.0);
+  __m128d normal_x = _mm_set1_pd(normal.x);
+  __m128d normal_y = _mm_set1_pd(normal.y);
+  __m128d shape_min = _mm_set1_pd(projection.x);
+  __m128d shape_max = _mm_set1_pd(projection.y);
+  for (size_t lane = 0; lane < count; lane += 2) {
+    __m128d direction_x = _mm_loadu_pd(&packet->direction_x[lane]);
+    __m128d direction_y = _mm_loadu_pd(&packet->direction_y[lane]);
+    __m128d center = _mm_add_pd(
+        _mm_mul_pd(_mm_loadu_pd(&packet->center_x[lane]), normal_x),
+        _mm_mul_pd(_mm_loadu_pd(&packet->center_y[lane]), normal_y));
+    __m128d along = _mm_add_pd(_mm_mul_pd(direction_x, normal_x),
+                               _mm_mul_pd(direction_y, normal_y));
+    __m128d across = _mm_sub_pd(_mm_mul_pd(direction_x, normal_y),
+                                _mm_mul_pd(direction_y, normal_x));
+    __m128d radius = _mm_add_pd(
+        _mm_mul_pd(_mm_loadu_pd(&packet->half_width[lane]),
+                   _mm_andnot_pd(sign, along)),
+        _mm_mul_pd(_mm_loadu_pd(&packet->half_height[lane]),
+                   _mm_andnot_pd(sign, across)));
+    packet_record_pair(packet, lane, shape_min, shape_max,
+                       _mm_sub_pd(center, radius), _mm_add_pd(center, radius),
+                       normal_x, normal_y);
+  }
+}
+
+/**
+ * Projects the shape and each box onto one of the box's own normals.
+ * If across is set, the normal is that of the box's first edge, which the
+ * box's height spans; otherwise it is that of the second edge.
+ */
+void packet_test_box_axis(box_packet_t *packet, size_t count,
+                          polygon_view_t shape, bool across) {
+  for (size_t lane = 0; lane < count; lane += 2) {
+    __m128d direction_x = _mm_loadu_pd(&packet->direction_x[lane]);
+    __m128d direction_y = _mm_loadu_pd(&packet->direction_y[lane]);
+    __m128d axis_x = across ? _mm_sub_pd(_mm_setzero_pd(), direction_y)
+                            : _mm_sub_pd(_mm_setzero_pd(), direction_x);
+    __m128d axis_y =
+        across ? direction_x : _mm_sub_pd(_mm_setzero_pd(), direction_y);
+    __m128d half = _mm_loadu_pd(across ? &packet->half_height[lane]
+                                       : &packet->half_width[lane]);
+    __m128d shape_min = _mm_set1_pd(INFINITY);
+    __m128d shape_max = _mm_set1_pd(-INFINITY);
+    for (size_t i = 0; i < shape.size; i++) {
+      __m128d dot =
+          _mm_add_pd(_mm_mul_pd(_mm_set1_pd(shape.vertices[i].x), axis_x),
+                     _mm_mul_pd(_mm_set1_pd(shape.vertices[i].y), axis_y));
+      shape_min = _mm_min_pd(shape_min, dot);
+      shape_max = _mm_max_pd(shape_max, dot);
+    }
+    __m128d center = _mm_add_pd(
+        _mm_mul_pd(_mm_loadu_pd(&packet->center_x[lane]), axis_x),
+        _mm_mul_pd(_mm_loadu_pd(&packet->center_y[lane]), axis_y));
+    packet_record_pair(packet, lane, shape_min, shape_max,
+                       _mm_sub_pd(center, half), _mm_add_pd(center, half),
+                       axis_x, axis_y);
+  }
+}
+
+#else
+
+/**
+ * Records the projections of the shape and the box at lane onto an axis,
+ * like check_axis() does for a single pair.
+ */
+void packet_record(box_packet_t *packet, size_t lane, double shape_min,
+                   double shape_max, double box_min, double box_max,
+                   vector_t axis) {
+  if (shape_max < box_min || box_max < shape_min) {
+    packet->separated |= (uint32_t)1 << lane;
+  }
+  double forward = shape_max - box_min;
+  double backward = box_max - shape_min;
+  double overlap = fmin(forward, backward);
+  if (overlap < packet->overlap[lane]) {
+    double signed_overlap = forward <= backward ? overlap : -overlap;
+    packet->overlap[lane] = overlap;
+    packet->axis_x[lane] = axis.x * signed_overlap;
+    packet->axis_y[lane] = axis.y * signed_overlap;
+  }
+}
+
+/**
+ * Projects the boxes onto one of the shape's normals, whose projection of
+ * the shape is already known. A box projects to its center plus or minus
+ * its half sides scaled by how far each side leans onto the normal.
+ */
+void packet_test_normal(box_packet_t *packet, size_t count, vector_t normal,
+                        vector_t projection) {
+  for (size_t lane = 0; lane < count; lane++) {
+    double direction_x = packet->direction_x[lane];
+    double direction_y = packet->direction_y[lane];
+    double center = packet->center_x[lane] * normal.x +
+                    packet->center_y[lane] * normal.y;
+    double along = direction_x * normal.x + direction_y * normal.y;
+    double across = direction_x * normal.y - direction_y * normal.x;
+    double radius = packet->half_width[lane] * fabs(along) +
+                    packet->half_height[lane] * fabs(across);
+    packet_record(packet, lane, projection.x, projection.y, center - radius,
+                  center + radius, normal);
+  }
+}
+
+/**
+ * Projects the shape and each box onto one of the box's own normals.
+ * If across is set, the normal is that of the box's first edge, which the
+ * box's height spans; otherwise it is that of the second edge.
+ */
+void packet_test_box_axis(box_packet_t *packet, size_t count,
+                          polygon_view_t shape, bool across) {
+  for (size_t lane = 0; lane < count; lane++) {
+    double direction_x = packet->direction_x[lane];
+    double direction_y = packet->direction_y[lane];
+    vector_t axis = across ? (vector_t){-direction_y, direction_x}
+                           : (vector_t){-direction_x, -direction_y};
+    double half =
+        across ? packet->half_height[lane] : packet->half_width[lane];
+    vector_t projection = get_projection(shape, axis);
+    double center =
+        packet->center_x[lane] * axis.x + packet->center_y[lane] * axis.y;
+    packet_record(packet, lane, projection.x, projection.y, center - half,
+                  center + half, axis);
+  }
+}
+
+#endif
+
+uint32_t find_collision_batch(polygon_view_t shape, normal_view_t normals,
+                              const collision_box_t *boxes, size_t count,
+                              vector_t *axes) {
+  assert(count <= COLLISION_BATCH_MAX);
+  if (count == 0) {
+    return 0;
+  }
+  uint32_t all = count == COLLISION_BATCH_MAX ? UINT32_MAX
+                                              : ((uint32_t)1 << count) - 1;
+  // Lanes are processed in pairs, so an odd last box is tested twice
+  size_t lanes = count + count % 2;
+  box_packet_t packet;
+  for (size_t lane = 0; lane < lanes; lane++) {
+    const collision_box_t *box = &boxes[lane < count ? lane : count - 1];
+    packet.center_x[lane] = box->center.x;
+    packet.center_y[lane] = box->center.y;
+    packet.direction_x[lane] = box->direction.x;
+    packet.direction_y[lane] = box->direction.y;
+    packet.half_width[lane] = box->half_width;
+    packet.half_height[lane] = box->half_height;
+    packet.overlap[lane] = INFINITY;
+    packet.axis_x[lane] = 0;
+    packet.axis_y[lane] = 0;
+  }
+  packet.separated = 0;
+
+  for (size_t i = 0; i < normals.size; i++) {
+    packet_test_normal(&packet, lanes, normals.normals[i],
+                       get_projection(shape, normals.normals[i]));
+    if ((packet.separated & all) == all) {
+      return 0;
+    }
+  }
+  packet_test_box_axis(&packet, lanes, shape, true);
+  packet_test_box_axis(&packet, lanes, shape, false);
+
+  uint32_t hits = ~packet.separated & all;
+  for (size_t lane = 0; lane < count; lane++) {
+    if (hits & ((uint32_t)1 << lane)) {
+      axes[lane] = (vector_t){packet.axis_x[lane], packet.axis_y[lane]};
+    }
+  }
+  return hits;
 }
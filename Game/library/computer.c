@@ -11,7 +11,8 @@ const double COMP_BULLET_MASS = 150;
 
 typedef struct computer {
   computer_info_t target;
-  body_t *comp_body;
+  scene_t *scene;
+  body_handle_t comp_body;
   double health;
   bool is_boss;
   weapon_t *weapon;
@@ -92,12 +93,12 @@ double set_computer_mass(style_info_t style) {
 }
 
 computer_t *computer_init(scene_t *scene, bool is_boss, style_info_t style,
-                          computer_info_t *type_of_comp, list_t *vertices) {
+                          computer_info_t type_of_comp, polygon_t *vertices) {
   computer_t *ai = malloc(sizeof(computer_t));
-  body_t *comp_body =
-      body_init_with_info(vertices, set_computer_mass(style),
-                          INTERNAL_BODY_COLOR, type_of_comp, (free_func_t)free);
-  ai->comp_body = comp_body;
+  body_t *comp_body = body_init_from_polygon(
+      vertices, set_computer_mass(style), INTERNAL_BODY_COLOR, NULL, NULL);
+  body_set_tag(comp_body, comp_info_tag(type_of_comp));
+  ai->scene = scene;
   ai->is_boss = is_boss;
   if (is_boss) {
     ai->health = BOSS_HEALTH_MULTIPLIER * set_computer_health(style);
@@ -109,7 +110,9 @@ computer_t *computer_init(scene_t *scene, bool is_boss, style_info_t style,
   ai->target = CHARACTER;
   ai->speed_multiplier = set_computer_speed_multiplier(style);
   ai->xp_offered = set_xp_offered(style);
+  body_set_collision_layer(comp_body, ENEMY_LAYER);
   scene_add_body(scene, comp_body);
+  ai->comp_body = body_get_handle(comp_body);
   return ai;
 }
 
@@ -119,31 +122,36 @@ weapon_t *computer_get_weapon(computer_t *ai) { return ai->weapon; }
 
 style_info_t computer_get_style(computer_t *ai) { return ai->comp_style; }
 
-body_t *get_comp_body(computer_t *ai) { return ai->comp_body; }
+body_t *get_comp_body(computer_t *ai) {
+  body_t *body = scene_get_body_by_handle(ai->scene, ai->comp_body);
+  assert(body != NULL);
+  return body;
+}
 
 void computer_process_damage(computer_t *ai, double character_multiplier) {
+  body_t *comp_body = get_comp_body(ai);
   if (is_boss(ai)) {
-    double damage = body_damage_collisions(ai->comp_body);
+    double damage = body_damage_collisions(comp_body);
     ai->health -= (character_multiplier * BOSS_DAMAGE_RESISTANCE * damage);
-    body_add_damage(ai->comp_body, -damage);
+    body_add_damage(comp_body, -damage);
   } else {
-    double damage = body_damage_collisions(ai->comp_body);
+    double damage = body_damage_collisions(comp_body);
     ai->health -= (character_multiplier * damage);
-    body_add_damage(ai->comp_body, -damage);
+    body_add_damage(comp_body, -damage);
   }
 }
 
 double computer_health(computer_t *ai) { return ai->health; }
 
 vector_t computer_vector_facing(computer_t *ai) {
-  return vec_rotate((vector_t){1, 0}, body_get_rotation(ai->comp_body));
+  return vec_rotate((vector_t){1, 0}, body_get_rotation(get_comp_body(ai)));
 }
 
 void computer_shoot(scene_t *scene, computer_t *ai) {
+  body_t *comp_body = get_comp_body(ai);
   weapon_shoot(scene, ai->weapon,
                vec_get_unit_vector(computer_vector_facing(ai), VEC_ZERO),
-               ai->comp_body, body_get_rotation(ai->comp_body),
-               COMP_BULLET_MASS);
+               comp_body, body_get_rotation(comp_body), COMP_BULLET_MASS);
 }
 
 double computer_distance_to(computer_t *ai, character_t *enemy) {
@@ -155,7 +163,7 @@ double computer_distance_to(computer_t *ai, character_t *enemy) {
 
 void computer_set_velocity(computer_t *ai, vector_t direction) {
   body_set_velocity(
-      ai->comp_body,
+      get_comp_body(ai),
       vec_multiply(ENEMY_SPEED * ai->speed_multiplier, direction));
 }
 
@@ -196,7 +204,7 @@ void computer_rotate(computer_t *ai, character_t *character) {
   vector_t user_center = body_get_centroid(character_get_body(character));
   vector_t direction = vec_subtract(user_center, ai_center);
   double angle = atan2(direction.y, direction.x);
-  body_set_rotation(ai->comp_body, angle);
+  body_set_rotation(get_comp_body(ai), angle);
 }
 
 vector_t computer_direction(computer_t *ai, character_t *character) {
@@ -0,0 +1,74 @@
+#include "contact_queue.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/**
+ * A queued contact. Only the normal and depth of the manifold are needed to
+ * separate the bodies.
+ */
+typedef struct queued_contact {
+  body_t *body1;
+  body_t *body2;
+  vector_t normal;
+  double depth;
+} queued_contact_t;
+
+typedef struct contact_queue {
+  queued_contact_t *contacts;
+  size_t count;
+  size_t capacity;
+} contact_queue_t;
+
+const size_t CONTACT_QUEUE_INITIAL_SIZE = 10;
+
+contact_queue_t *contact_queue_init(void) {
+  contact_queue_t *queue = malloc(sizeof(contact_queue_t));
+  assert(queue != NULL);
+  queue->contacts = NULL;
+  queue->count = 0;
+  queue->capacity = 0;
+  return queue;
+}
+
+void contact_queue_free(contact_queue_t *queue) {
+  free(queue->contacts);
+  free(queue);
+}
+
+void contact_queue_add(contact_queue_t *queue, body_t *body1, body_t *body2,
+                       const contact_manifold_t *manifold) {
+  if (queue->count == queue->capacity) {
+    queue->capacity = queue->capacity == 0 ? CONTACT_QUEUE_INITIAL_SIZE
+                                           : queue->capacity * 2;
+    queue->contacts =
+        realloc(queue->contacts, queue->capacity * sizeof(queued_contact_t));
+    assert(queue->contacts != NULL);
+  }
+  queue->contacts[queue->count++] =
+      (queued_contact_t){.body1 = body1,
+                         .body2 = body2,
+                         .normal = manifold->normal,
+                         .depth = manifold->depth};
+}
+
+void contact_queue_resolve(contact_queue_t *queue) {
+  for (size_t i = 0; i < queue->count; i++) {
+    queued_contact_t *contact = &queue->contacts[i];
+    double inverse_mass1 = 1 / body_get_mass(contact->body1);
+    double inverse_mass2 = 1 / body_get_mass(contact->body2);
+    double inverse_total = inverse_mass1 + inverse_mass2;
+    if (inverse_total == 0) {
+      continue;
+    }
+    vector_t correction =
+        vec_multiply(contact->depth / inverse_total, contact->normal);
+    body_set_centroid(
+        contact->body1,
+        vec_subtract(body_get_centroid(contact->body1),
+                     vec_multiply(inverse_mass1, correction)));
+    body_set_centroid(contact->body2,
+                      vec_add(body_get_centroid(contact->body2),
+                              vec_multiply(inverse_mass2, correction)));
+  }
+  queue->count = 0;
+}
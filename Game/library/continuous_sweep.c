@@ -0,0 +1,126 @@
+#include "continuous_sweep.h"
+#include "collision.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * The earliest time of impact found so far for a continuous body, as a
+ * fraction of its last motion.
+ */
+typedef struct impact {
+  body_t *body;
+  double time;
+} impact_t;
+
+/**
+ * impacts holds the bodies that hit something on the current run.
+ * positions[i] is where the body whose handle has index i sits in impacts,
+ * if it is there; entries left over from earlier runs are caught by
+ * checking the body found at that position.
+ */
+typedef struct continuous_sweep {
+  impact_t *impacts;
+  size_t impact_count;
+  size_t impact_capacity;
+  size_t *positions;
+  size_t position_capacity;
+} continuous_sweep_t;
+
+const size_t CONTINUOUS_SWEEP_INITIAL_SIZE = 10;
+const size_t NO_IMPACT = SIZE_MAX;
+const double CONTINUOUS_SKIN = 1e-3;
+
+continuous_sweep_t *continuous_sweep_init(void) {
+  continuous_sweep_t *sweep = malloc(sizeof(continuous_sweep_t));
+  assert(sweep != NULL);
+  sweep->impacts = NULL;
+  sweep->impact_count = 0;
+  sweep->impact_capacity = 0;
+  sweep->positions = NULL;
+  sweep->position_capacity = 0;
+  return sweep;
+}
+
+void continuous_sweep_free(continuous_sweep_t *sweep) {
+  free(sweep->impacts);
+  free(sweep->positions);
+  free(sweep);
+}
+
+/**
+ * Gets the impact recorded for a body on this run, adding one that has not
+ * hit anything yet if there is none.
+ */
+impact_t *continuous_sweep_get_impact(continuous_sweep_t *sweep,
+                                      body_t *body) {
+  size_t index = body_get_handle(body).index;
+  if (index >= sweep->position_capacity) {
+    size_t capacity = sweep->position_capacity == 0
+                          ? CONTINUOUS_SWEEP_INITIAL_SIZE
+                          : sweep->position_capacity;
+    while (capacity <= index) {
+      capacity *= 2;
+    }
+    sweep->positions = realloc(sweep->positions, capacity * sizeof(size_t));
+    assert(sweep->positions != NULL);
+    for (size_t i = sweep->position_capacity; i < capacity; i++) {
+      sweep->positions[i] = NO_IMPACT;
+    }
+    sweep->position_capacity = capacity;
+  }
+  size_t position = sweep->positions[index];
+  if (position < sweep->impact_count &&
+      sweep->impacts[position].body == body) {
+    return &sweep->impacts[position];
+  }
+  if (sweep->impact_count == sweep->impact_capacity) {
+    sweep->impact_capacity = sweep->impact_capacity == 0
+                                 ? CONTINUOUS_SWEEP_INITIAL_SIZE
+                                 : sweep->impact_capacity * 2;
+    sweep->impacts =
+        realloc(sweep->impacts, sweep->impact_capacity * sizeof(impact_t));
+    assert(sweep->impacts != NULL);
+  }
+  sweep->positions[index] = sweep->impact_count;
+  impact_t *impact = &sweep->impacts[sweep->impact_count++];
+  *impact = (impact_t){.body = body, .time = INFINITY};
+  return impact;
+}
+
+/**
+ * Records when a continuous body first touched another body, if that is
+ * the earliest impact found for it so far.
+ */
+void continuous_sweep_record(continuous_sweep_t *sweep, body_t *body,
+                             body_t *other) {
+  if (!body_is_continuous(body)) {
+    return;
+  }
+  vector_t motion = body_get_motion(body);
+  if (motion.x == 0 && motion.y == 0) {
+    return;
+  }
+  double time = find_body_time_of_impact(body, other);
+  if (time < 1) {
+    impact_t *impact = continuous_sweep_get_impact(sweep, body);
+    impact->time = fmin(impact->time, time);
+  }
+}
+
+void continuous_sweep_run(continuous_sweep_t *sweep, body_pair_view_t pairs) {
+  sweep->impact_count = 0;
+  for (size_t i = 0; i < pairs.size; i++) {
+    continuous_sweep_record(sweep, pairs.pairs[i].body1, pairs.pairs[i].body2);
+    continuous_sweep_record(sweep, pairs.pairs[i].body2, pairs.pairs[i].body1);
+  }
+  for (size_t i = 0; i < sweep->impact_count; i++) {
+    body_t *body = sweep->impacts[i].body;
+    vector_t motion = body_get_motion(body);
+    double distance = sqrt(vec_dot(motion, motion));
+    double time = fmin(1, sweep->impacts[i].time + CONTINUOUS_SKIN / distance);
+    body_set_centroid(body, vec_subtract(body_get_centroid(body),
+                                         vec_multiply(1 - time, motion)));
+  }
+}
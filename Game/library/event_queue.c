@@ -0,0 +1,118 @@
+#include "event_queue.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/**
+ * A queued event. group and sequence are filled in when events are
+ * dispatched, to sort them into batches.
+ */
+typedef struct queued_event {
+  event_handler_t handler;
+  body_t *body1;
+  body_t *body2;
+  vector_t axis;
+  void *aux;
+  size_t group;
+  size_t sequence;
+} queued_event_t;
+
+/**
+ * groups holds the distinct handlers of the round being dispatched, in the
+ * order they were first queued.
+ */
+typedef struct event_queue {
+  queued_event_t *events;
+  size_t count;
+  size_t capacity;
+  event_handler_t *groups;
+  size_t group_capacity;
+} event_queue_t;
+
+const size_t EVENT_QUEUE_INITIAL_SIZE = 10;
+
+event_queue_t *event_queue_init(void) {
+  event_queue_t *queue = malloc(sizeof(event_queue_t));
+  assert(queue != NULL);
+  queue->events = NULL;
+  queue->count = 0;
+  queue->capacity = 0;
+  queue->groups = NULL;
+  queue->group_capacity = 0;
+  return queue;
+}
+
+void event_queue_free(event_queue_t *queue) {
+  free(queue->events);
+  free(queue->groups);
+  free(queue);
+}
+
+void event_queue_add(event_queue_t *queue, event_handler_t handler,
+                     body_t *body1, body_t *body2, vector_t axis, void *aux) {
+  if (queue->count == queue->capacity) {
+    queue->capacity = queue->capacity == 0 ? EVENT_QUEUE_INITIAL_SIZE
+                                           : queue->capacity * 2;
+    queue->events =
+        realloc(queue->events, queue->capacity * sizeof(queued_event_t));
+    assert(queue->events != NULL);
+  }
+  queue->events[queue->count++] = (queued_event_t){
+      .handler = handler, .body1 = body1, .body2 = body2, .axis = axis,
+      .aux = aux};
+}
+
+int compare_event_batch(const void *event1, const void *event2) {
+  const queued_event_t *e1 = event1;
+  const queued_event_t *e2 = event2;
+  if (e1->group != e2->group) {
+    return (e1->group > e2->group) - (e1->group < e2->group);
+  }
+  return (e1->sequence > e2->sequence) - (e1->sequence < e2->sequence);
+}
+
+/**
+ * Finds the group of a handler among the first group_count groups, adding
+ * it as a new group if it is not there yet.
+ */
+size_t event_queue_find_group(event_queue_t *queue, event_handler_t handler,
+                              size_t *group_count) {
+  size_t group = 0;
+  while (group < *group_count && queue->groups[group] != handler) {
+    group++;
+  }
+  if (group == *group_count) {
+    if (group == queue->group_capacity) {
+      queue->group_capacity = queue->group_capacity == 0
+                                  ? EVENT_QUEUE_INITIAL_SIZE
+                                  : queue->group_capacity * 2;
+      queue->groups = realloc(queue->groups,
+                              queue->group_capacity * sizeof(event_handler_t));
+      assert(queue->groups != NULL);
+    }
+    queue->groups[(*group_count)++] = handler;
+  }
+  return group;
+}
+
+void event_queue_dispatch(event_queue_t *queue) {
+  size_t start = 0;
+  while (start < queue->count) {
+    size_t end = queue->count;
+    size_t group_count = 0;
+    for (size_t i = start; i < end; i++) {
+      queued_event_t *event = &queue->events[i];
+      event->group =
+          event_queue_find_group(queue, event->handler, &group_count);
+      event->sequence = i;
+    }
+    qsort(&queue->events[start], end - start, sizeof(queued_event_t),
+          compare_event_batch);
+    for (size_t i = start; i < end; i++) {
+      // Copy the event, since a handler queueing more can move the queue
+      queued_event_t event = queue->events[i];
+      event.handler(event.body1, event.body2, event.axis, event.aux);
+    }
+    start = end;
+  }
+  queue->count = 0;
+}
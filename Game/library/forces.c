@@ -1,5 +1,7 @@
 #include "forces.h"
 #include "collision.h"
+#include "pool.h"
+#include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,15 +9,28 @@
 const int MINIMUM_DISTANCE = 5;
 const size_t RADIUS = 10;
 
+/**
+ * Whether the bodies are touching is kept in the scene's pair cache.
+ * loose_colliding is only used for bodies outside the scene, which have no
+ * handles for the cache to key them by.
+ */
 typedef struct collision_force_aux {
+  scene_t *scene;
   body_t *body1;
   body_t *body2;
   collision_handler_t handler;
   void *handler_aux;
-  bool colliding;
+  bool loose_colliding;
   free_func_t freer;
 } collision_force_aux_t;
 
+typedef struct layer_collision_aux {
+  scene_t *scene;
+  collision_handler_t handler;
+  void *handler_aux;
+  free_func_t freer;
+} layer_collision_aux_t;
+
 typedef struct aux_two {
   body_t *body1;
   body_t *body2;
@@ -27,11 +42,50 @@ typedef struct aux_one {
   double constant;
 } aux_one_t;
 
+/**
+ * Every aux struct created in this file, so that they can share one pool.
+ */
+typedef union force_aux {
+  collision_force_aux_t collision;
+  layer_collision_aux_t layer_collision;
+  aux_two_t two;
+  aux_one_t one;
+  double elasticity;
+} force_aux_t;
+
+const size_t FORCE_AUX_POOL_SLAB = 64;
+const bool DESTROY_BOTH = true;
+const bool DESTROY_ONE = false;
+
+pool_t *force_aux_pool = NULL;
+
+pool_t *forces_get_aux_pool(void) {
+  if (force_aux_pool == NULL) {
+    force_aux_pool = pool_init(sizeof(force_aux_t), FORCE_AUX_POOL_SLAB);
+  }
+  return force_aux_pool;
+}
+
+pool_stats_t forces_get_aux_pool_stats(void) {
+  return pool_get_stats(forces_get_aux_pool());
+}
+
+void *force_aux_alloc(void) { return pool_alloc(forces_get_aux_pool()); }
+
+void force_aux_free(void *aux) { pool_release(forces_get_aux_pool(), aux); }
+
 void free_collision_aux(collision_force_aux_t *aux) {
   if (aux->freer != NULL) {
     aux->freer(aux->handler_aux);
   }
-  free(aux);
+  force_aux_free(aux);
+}
+
+void free_layer_collision_aux(layer_collision_aux_t *aux) {
+  if (aux->freer != NULL) {
+    aux->freer(aux->handler_aux);
+  }
+  force_aux_free(aux);
 }
 
 void calculate_gravity(void *aux) {
@@ -55,7 +109,7 @@ void calculate_gravity(void *aux) {
 
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2) {
-  aux_two_t *aux = malloc(sizeof(aux_two_t));
+  aux_two_t *aux = force_aux_alloc();
   aux->constant = G;
   aux->body1 = body1;
   aux->body2 = body2;
@@ -63,7 +117,7 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
   list_add(bodies, body1);
   list_add(bodies, body2);
   scene_add_bodies_force_creator(scene, (force_creator_t)calculate_gravity, aux,
-                                 bodies, (free_func_t)free);
+                                 bodies, force_aux_free);
 }
 
 void calculate_spring(void *aux) {
@@ -79,7 +133,7 @@ void calculate_spring(void *aux) {
 }
 
 void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
-  aux_two_t *aux = malloc(sizeof(aux_two_t));
+  aux_two_t *aux = force_aux_alloc();
   aux->constant = k;
   aux->body1 = body1;
   aux->body2 = body2;
@@ -87,7 +141,7 @@ void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
   list_add(bodies, body1);
   list_add(bodies, body2);
   scene_add_bodies_force_creator(scene, (force_creator_t)calculate_spring, aux,
-                                 bodies, (free_func_t)free);
+                                 bodies, force_aux_free);
 }
 
 void calculate_drag(void *aux) {
@@ -99,62 +153,138 @@ void calculate_drag(void *aux) {
 }
 
 void create_drag(scene_t *scene, double gamma, body_t *body) {
-  aux_one_t *aux = malloc(sizeof(aux_one_t));
+  aux_one_t *aux = force_aux_alloc();
   aux->constant = gamma;
   aux->body = body;
   list_t *bodies = list_init(2, NULL);
   list_add(bodies, body);
   scene_add_bodies_force_creator(scene, (force_creator_t)calculate_drag, aux,
-                                 bodies, (free_func_t)free);
+                                 bodies, force_aux_free);
+}
+
+bool bodies_may_collide(body_t *body1, body_t *body2) {
+  vector_t distance =
+      vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+  double reach =
+      body_get_bounding_radius(body1) + body_get_bounding_radius(body2);
+  if (vec_dot(distance, distance) > reach * reach) {
+    return false;
+  }
+  return aabb_overlaps(body_get_aabb(body1), body_get_aabb(body2));
+}
+
+/**
+ * Checks whether two bodies are colliding and, if they are, queues their
+ * contact so the scene moves them apart once every collision this tick has
+ * been detected (see scene_queue_contact()). Neither body moves here.
+ * The returned axis is the unit contact normal, pointing from body1 to body2.
+ * direction is the pair's narrowphase search direction and manifold receives
+ * its contact (see find_body_manifold()).
+ */
+collision_info_t detect_collision(scene_t *scene, body_t *body1,
+                                  body_t *body2, vector_t *direction,
+                                  contact_manifold_t *manifold) {
+  collision_info_t info = {.collided = false, .axis = VEC_ZERO};
+  if (!bodies_may_collide(body1, body2)) {
+    return info;
+  }
+  info = find_body_manifold(body1, body2, direction, manifold);
+  if (!info.collided) {
+    return info;
+  }
+  info.axis = manifold->normal;
+  scene_queue_contact(scene, body1, body2, manifold);
+  return info;
+}
+
+/**
+ * Runs the narrowphase on a pair of bodies the first time it is asked to on
+ * a tick, recording the result in the pair's cache entry, so that several
+ * collisions on one pair only detect it once. The entry may list the
+ * bodies the other way around, in which case they are checked in its order.
+ * Returns the unit contact normal from body1 to body2, or VEC_ZERO if the
+ * bodies are not touching.
+ */
+vector_t check_pair(scene_t *scene, pair_entry_t *entry, body_t *body1,
+                    body_t *body2) {
+  bool swapped = entry->handle1.index != body_get_handle(body1).index;
+  if (!entry->checked) {
+    entry->touching = detect_collision(scene, swapped ? body2 : body1,
+                                       swapped ? body1 : body2,
+                                       &entry->direction, &entry->manifold)
+                          .collided;
+    entry->checked = true;
+  }
+  if (!entry->touching) {
+    return VEC_ZERO;
+  }
+  return swapped ? vec_negate(entry->manifold.normal) : entry->manifold.normal;
 }
 
 void apply_collision(void *aux) {
   collision_force_aux_t *aux_n = aux;
   body_t *body1 = aux_n->body1;
   body_t *body2 = aux_n->body2;
-  collision_info_t info =
-      find_collision(body_get_shape(body1), body_get_shape(body2));
-  bool collision_state = aux_n->colliding;
-  if (info.collided) {
-    if (body_get_mass(body1) != INFINITY && body_get_mass(body2) != INFINITY) {
-      body_set_centroid(body1, vec_subtract(body_get_centroid(body1),
-                                            vec_multiply(0.5, info.axis)));
-      body_set_centroid(body2, vec_add(body_get_centroid(body1),
-                                       vec_multiply(0.5, info.axis)));
-    } else if (body_get_mass(body1) == INFINITY) {
-      body_set_centroid(body2, vec_add(body_get_centroid(body1), info.axis));
-    } else if (body_get_mass(body2) == INFINITY) {
-      body_set_centroid(body1,
-                        vec_subtract(body_get_centroid(body1), info.axis));
+  pair_entry_t *entry = scene_get_pair(aux_n->scene, body1, body2);
+  if (entry == NULL) {
+    contact_manifold_t manifold;
+    collision_info_t info =
+        detect_collision(aux_n->scene, body1, body2, NULL, &manifold);
+    if (info.collided && !aux_n->loose_colliding) {
+      scene_queue_event(aux_n->scene, aux_n->handler, body1, body2, info.axis,
+                        aux_n->handler_aux);
     }
+    aux_n->loose_colliding = info.collided;
+    return;
   }
-  if (info.collided && !collision_state) {
-    aux_n->handler(body1, body2, info.axis, aux_n->handler_aux);
-    aux_n->colliding = true;
-  } else if (!info.collided) {
-    aux_n->colliding = false;
+  vector_t axis = check_pair(aux_n->scene, entry, body1, body2);
+  if (pair_entry_get_state(entry) == PAIR_ENTER) {
+    scene_queue_event(aux_n->scene, aux_n->handler, body1, body2, axis,
+                      aux_n->handler_aux);
   }
 }
 
 void create_collision(scene_t *scene, body_t *body1, body_t *body2,
                       collision_handler_t handler, void *aux,
                       free_func_t freer) {
-  collision_force_aux_t *aux_n = malloc(sizeof(collision_force_aux_t));
+  collision_force_aux_t *aux_n = force_aux_alloc();
+  aux_n->scene = scene;
   aux_n->body1 = body1;
   aux_n->body2 = body2;
   aux_n->handler = handler;
   aux_n->handler_aux = aux;
-  aux_n->colliding = false;
+  aux_n->loose_colliding = false;
   aux_n->freer = freer;
-  list_t *bodies = list_init(2, NULL);
-  list_add(bodies, body1);
-  list_add(bodies, body2);
-  scene_add_bodies_force_creator(scene, (force_creator_t)apply_collision, aux_n,
-                                 bodies, (free_func_t)free_collision_aux);
+  scene_add_pair_force_creator(scene, (force_creator_t)apply_collision, aux_n,
+                               body1, body2, (free_func_t)free_collision_aux);
+}
+
+void apply_layer_collision(body_t *body1, body_t *body2, void *aux) {
+  layer_collision_aux_t *aux_n = aux;
+  pair_entry_t *entry = scene_get_pair(aux_n->scene, body1, body2);
+  assert(entry != NULL);
+  vector_t axis = check_pair(aux_n->scene, entry, body1, body2);
+  if (pair_entry_get_state(entry) == PAIR_ENTER) {
+    scene_queue_event(aux_n->scene, aux_n->handler, body1, body2, axis,
+                      aux_n->handler_aux);
+  }
+}
+
+void create_layer_collision(scene_t *scene, size_t layer1, size_t layer2,
+                            collision_handler_t handler, void *aux,
+                            free_func_t freer) {
+  layer_collision_aux_t *aux_n = force_aux_alloc();
+  aux_n->scene = scene;
+  aux_n->handler = handler;
+  aux_n->handler_aux = aux;
+  aux_n->freer = freer;
+  scene_add_layer_force_creator(scene, layer1, layer2,
+                                (layer_force_creator_t)apply_layer_collision,
+                                aux_n, (free_func_t)free_layer_collision_aux);
 }
 
 void destroy_bodies(body_t *body1, body_t *body2, vector_t axis, void *aux) {
-  bool *destroy_both = (bool *)aux;
+  const bool *destroy_both = aux;
   body_remove(body2);
   if (*destroy_both) {
     body_remove(body1);
@@ -163,32 +293,44 @@ void destroy_bodies(body_t *body1, body_t *body2, vector_t axis, void *aux) {
 
 void create_destructive_collision(scene_t *scene, body_t *body1,
                                   body_t *body2) {
-  bool *destroy_both = malloc(sizeof(bool));
-  *destroy_both = true;
   create_collision(scene, body1, body2, (collision_handler_t)destroy_bodies,
-                   destroy_both, (free_func_t)free);
+                   (void *)&DESTROY_BOTH, NULL);
 }
 
 void create_solo_destructive_collision(scene_t *scene, body_t *retained,
                                        body_t *removed) {
-  bool *destroy_both = malloc(sizeof(bool));
-  *destroy_both = false;
   create_collision(scene, retained, removed,
-                   (collision_handler_t)destroy_bodies, destroy_both,
-                   (free_func_t)free);
+                   (collision_handler_t)destroy_bodies, (void *)&DESTROY_ONE,
+                   NULL);
 }
 
+/**
+ * Damages a body by the power of the bullet that hit it, which is the
+ * bullet_info_t in the bullet's tag, and removes the bullet.
+ */
 void damage_body(body_t *damaged, body_t *removed, vector_t axis, void *aux) {
-  bullet_info_t *damager = (bullet_info_t *)aux;
-  body_add_damage(damaged, (double)(int)*damager);
+  body_add_damage(damaged, (double)body_get_tag(removed).subtype);
   body_remove(removed);
 }
 
 void create_damaging_collision(scene_t *scene, body_t *damaged,
                                body_t *removed) {
-  bullet_info_t *bullet_info = (bullet_info_t *)body_get_info(removed);
   create_collision(scene, damaged, removed, (collision_handler_t)damage_body,
-                   bullet_info, NULL);
+                   NULL, NULL);
+}
+
+void create_layer_solo_destructive_collision(scene_t *scene,
+                                             size_t retained_layer,
+                                             size_t removed_layer) {
+  create_layer_collision(scene, retained_layer, removed_layer,
+                         (collision_handler_t)destroy_bodies,
+                         (void *)&DESTROY_ONE, NULL);
+}
+
+void create_layer_damaging_collision(scene_t *scene, size_t damaged_layer,
+                                     size_t removed_layer) {
+  create_layer_collision(scene, damaged_layer, removed_layer,
+                         (collision_handler_t)damage_body, NULL, NULL);
 }
 
 void Phy_collision_handler(body_t *body1, body_t *body2, vector_t axis,
@@ -213,9 +355,18 @@ void Phy_collision_handler(body_t *body1, body_t *body2, vector_t axis,
 
 void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
                               body_t *body2) {
-  double *elasticity_ptr = malloc(sizeof(double));
+  double *elasticity_ptr = force_aux_alloc();
   *elasticity_ptr = elasticity;
   create_collision(scene, body1, body2,
                    (collision_handler_t)Phy_collision_handler, elasticity_ptr,
-                   (free_func_t)free);
-}
\ No newline at end of file
+                   force_aux_free);
+}
+
+void create_layer_physics_collision(scene_t *scene, double elasticity,
+                                    size_t layer1, size_t layer2) {
+  double *elasticity_ptr = force_aux_alloc();
+  *elasticity_ptr = elasticity;
+  create_layer_collision(scene, layer1, layer2,
+                         (collision_handler_t)Phy_collision_handler,
+                         elasticity_ptr, force_aux_free);
+}
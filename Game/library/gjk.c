@@ -0,0 +1,186 @@
+#include "gjk.h"
+#include <math.h>
+#include <stddef.h>
+
+/**
+ * GJK never needs more than a triangle, and EPA stops growing its polytope
+ * once it holds this many points, which only shapes with more vertices
+ * between them than that can reach.
+ */
+#define EPA_MAX_POINTS 128
+
+const size_t GJK_MAX_ITERATIONS = 64;
+const double EPA_TOLERANCE = 1e-9;
+
+/**
+ * Finds the vertex of a shape furthest along a direction.
+ */
+vector_t gjk_furthest(polygon_view_t shape, vector_t direction) {
+  vector_t best = shape.vertices[0];
+  double best_dot = vec_dot(best, direction);
+  for (size_t i = 1; i < shape.size; i++) {
+    double dot = vec_dot(shape.vertices[i], direction);
+    if (dot > best_dot) {
+      best_dot = dot;
+      best = shape.vertices[i];
+    }
+  }
+  return best;
+}
+
+/**
+ * Finds the point of the Minkowski difference shape1 - shape2 furthest
+ * along a direction.
+ */
+vector_t gjk_support(polygon_view_t shape1, polygon_view_t shape2,
+                     vector_t direction) {
+  return vec_subtract(gjk_furthest(shape1, direction),
+                      gjk_furthest(shape2, vec_negate(direction)));
+}
+
+vector_t gjk_center(polygon_view_t shape) {
+  vector_t sum = VEC_ZERO;
+  for (size_t i = 0; i < shape.size; i++) {
+    sum = vec_add(sum, shape.vertices[i]);
+  }
+  return vec_multiply(1.0 / shape.size, sum);
+}
+
+/**
+ * Returns the perpendicular of an edge on the side facing a point.
+ */
+vector_t gjk_perpendicular_towards(vector_t edge, vector_t towards) {
+  vector_t perpendicular = {-edge.y, edge.x};
+  return vec_dot(perpendicular, towards) < 0 ? vec_negate(perpendicular)
+                                             : perpendicular;
+}
+
+/**
+ * Reduces the simplex to the feature nearest the origin, whose newest point
+ * is last, and points the direction from it towards the origin.
+ * Returns true if the simplex is a triangle enclosing the origin.
+ * A segment through the origin searches off to one side of it, so that
+ * the triangle it grows into gives EPA an area to expand.
+ */
+bool gjk_update_simplex(vector_t *simplex, size_t *size, vector_t *direction) {
+  vector_t a = simplex[*size - 1];
+  vector_t to_origin = vec_negate(a);
+  if (*size == 2) {
+    *direction =
+        gjk_perpendicular_towards(vec_subtract(simplex[0], a), to_origin);
+    return false;
+  }
+  vector_t ab = vec_subtract(simplex[1], a);
+  vector_t ac = vec_subtract(simplex[0], a);
+  vector_t ab_outside = gjk_perpendicular_towards(ab, vec_negate(ac));
+  vector_t ac_outside = gjk_perpendicular_towards(ac, vec_negate(ab));
+  if (vec_dot(ab_outside, to_origin) > 0) {
+    simplex[0] = simplex[1];
+    simplex[1] = a;
+    *size = 2;
+    *direction = ab_outside;
+    return false;
+  }
+  if (vec_dot(ac_outside, to_origin) > 0) {
+    simplex[1] = a;
+    *size = 2;
+    *direction = ac_outside;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Expands a triangle around the origin, inside the Minkowski difference,
+ * until its edge nearest the origin lies on the difference's boundary.
+ * That edge's outward normal, scaled by its distance, is the collision axis.
+ */
+vector_t epa_find_axis(polygon_view_t shape1, polygon_view_t shape2,
+                       const vector_t *triangle) {
+  vector_t points[EPA_MAX_POINTS];
+  size_t size = 3;
+  // Keep the polytope counterclockwise so edge normals point outwards
+  bool clockwise = vec_cross(vec_subtract(triangle[1], triangle[0]),
+                             vec_subtract(triangle[2], triangle[0])) < 0;
+  for (size_t i = 0; i < 3; i++) {
+    points[i] = triangle[clockwise ? 2 - i : i];
+  }
+
+  vector_t axis = VEC_ZERO;
+  while (true) {
+    size_t nearest = 0;
+    double nearest_distance = INFINITY;
+    vector_t nearest_normal = VEC_ZERO;
+    for (size_t i = 0; i < size; i++) {
+      vector_t edge = vec_subtract(points[i + 1 == size ? 0 : i + 1],
+                                   points[i]);
+      double length = sqrt(vec_dot(edge, edge));
+      if (length == 0) {
+        continue;
+      }
+      vector_t normal = vec_multiply(1 / length, (vector_t){edge.y, -edge.x});
+      double distance = vec_dot(normal, points[i]);
+      if (distance < nearest_distance) {
+        nearest_distance = distance;
+        nearest_normal = normal;
+        nearest = i;
+      }
+    }
+    axis = vec_multiply(nearest_distance, nearest_normal);
+    vector_t support = gjk_support(shape1, shape2, nearest_normal);
+    double support_distance = vec_dot(support, nearest_normal);
+    if (support_distance - nearest_distance <= EPA_TOLERANCE ||
+        size == EPA_MAX_POINTS) {
+      return axis;
+    }
+    for (size_t i = size; i > nearest + 1; i--) {
+      points[i] = points[i - 1];
+    }
+    points[nearest + 1] = support;
+    size++;
+  }
+}
+
+bool gjk_find_collision(polygon_view_t shape1, polygon_view_t shape2,
+                        vector_t *direction, vector_t *axis) {
+  vector_t search = direction != NULL ? *direction : VEC_ZERO;
+  if (search.x == 0 && search.y == 0) {
+    search = vec_subtract(gjk_center(shape2), gjk_center(shape1));
+    if (search.x == 0 && search.y == 0) {
+      search = (vector_t){1, 0};
+    }
+  }
+
+  vector_t simplex[3];
+  size_t size = 0;
+  bool intersect = false;
+  simplex[size++] = gjk_support(shape1, shape2, search);
+  // Unless the first direction still separates the shapes, walk towards
+  // the origin until a triangle encloses it or some direction separates them
+  if (vec_dot(simplex[0], search) >= 0) {
+    search = vec_negate(simplex[0]);
+    intersect = search.x == 0 && search.y == 0;
+    for (size_t i = 0; i < GJK_MAX_ITERATIONS && !intersect; i++) {
+      vector_t point = gjk_support(shape1, shape2, search);
+      if (vec_dot(point, search) < 0) {
+        break;
+      }
+      simplex[size++] = point;
+      intersect = (point.x == 0 && point.y == 0) ||
+                  gjk_update_simplex(simplex, &size, &search);
+    }
+  }
+  if (!intersect) {
+    if (direction != NULL) {
+      *direction = search;
+    }
+    return false;
+  }
+  // A simplex that only touches the origin has no depth to expand
+  *axis = size == 3 ? epa_find_axis(shape1, shape2, simplex) : VEC_ZERO;
+  // Once the shapes part, they will most likely part along the axis
+  if (direction != NULL && (axis->x != 0 || axis->y != 0)) {
+    *direction = *axis;
+  }
+  return true;
+}
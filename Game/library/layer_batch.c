@@ -0,0 +1,210 @@
+#include "layer_batch.h"
+#include "collision.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * What the batch knows about a body on a run: how many of the run's pairs
+ * it could be batched in, and its box, if it is a rectangle. The rest is
+ * only filled in when run is the current run.
+ */
+typedef struct batch_body {
+  size_t run;
+  size_t pair_count;
+  bool is_box;
+  collision_box_t box;
+} batch_body_t;
+
+/**
+ * A pair filed under the handle index of its polygon, subject, to be
+ * tested in one batch with every other rectangle paired with that polygon.
+ */
+typedef struct batch_pair {
+  size_t subject;
+  body_t *body;
+  body_t *other;
+} batch_pair_t;
+
+/**
+ * bodies[i] describes the body whose handle has index i.
+ */
+typedef struct layer_batch {
+  size_t run;
+  batch_body_t *bodies;
+  size_t body_capacity;
+  batch_pair_t *pairs;
+  size_t pair_count;
+  size_t pair_capacity;
+} layer_batch_t;
+
+const size_t LAYER_BATCH_INITIAL_SIZE = 10;
+
+layer_batch_t *layer_batch_init(void) {
+  layer_batch_t *batch = malloc(sizeof(layer_batch_t));
+  assert(batch != NULL);
+  batch->run = 0;
+  batch->bodies = NULL;
+  batch->body_capacity = 0;
+  batch->pairs = NULL;
+  batch->pair_count = 0;
+  batch->pair_capacity = 0;
+  return batch;
+}
+
+void layer_batch_free(layer_batch_t *batch) {
+  free(batch->bodies);
+  free(batch->pairs);
+  free(batch);
+}
+
+/**
+ * Makes room for every body in a set of pairs, so that looking bodies up
+ * never moves the ones already looked up.
+ */
+void layer_batch_reserve(layer_batch_t *batch, body_pair_view_t pairs) {
+  size_t needed = 0;
+  for (size_t i = 0; i < pairs.size; i++) {
+    size_t index1 = body_get_handle(pairs.pairs[i].body1).index;
+    size_t index2 = body_get_handle(pairs.pairs[i].body2).index;
+    size_t index = index1 > index2 ? index1 : index2;
+    needed = index + 1 > needed ? index + 1 : needed;
+  }
+  if (needed <= batch->body_capacity) {
+    return;
+  }
+  size_t capacity = batch->body_capacity == 0 ? LAYER_BATCH_INITIAL_SIZE
+                                              : batch->body_capacity;
+  while (capacity < needed) {
+    capacity *= 2;
+  }
+  batch->bodies = realloc(batch->bodies, capacity * sizeof(batch_body_t));
+  assert(batch->bodies != NULL);
+  for (size_t i = batch->body_capacity; i < capacity; i++) {
+    batch->bodies[i].run = 0;
+  }
+  batch->body_capacity = capacity;
+}
+
+/**
+ * Gets what the batch knows about a body this run, or NULL if the body is a
+ * circle, which it cannot batch.
+ */
+batch_body_t *layer_batch_get_body(layer_batch_t *batch, body_t *body) {
+  if (body_get_shape_kind(body) != SHAPE_POLYGON) {
+    return NULL;
+  }
+  size_t index = body_get_handle(body).index;
+  assert(index < batch->body_capacity);
+  batch_body_t *batch_body = &batch->bodies[index];
+  if (batch_body->run != batch->run) {
+    batch_body->run = batch->run;
+    batch_body->pair_count = 0;
+    batch_body->is_box = collision_box_from_body(body, &batch_body->box);
+  }
+  return batch_body;
+}
+
+void layer_batch_add_pair(layer_batch_t *batch, body_t *subject,
+                          body_t *other) {
+  if (batch->pair_count == batch->pair_capacity) {
+    batch->pair_capacity = batch->pair_capacity == 0
+                               ? LAYER_BATCH_INITIAL_SIZE
+                               : batch->pair_capacity * 2;
+    batch->pairs =
+        realloc(batch->pairs, batch->pair_capacity * sizeof(batch_pair_t));
+    assert(batch->pairs != NULL);
+  }
+  batch->pairs[batch->pair_count++] =
+      (batch_pair_t){.subject = body_get_handle(subject).index,
+                     .body = subject,
+                     .other = other};
+}
+
+int compare_batch_subject(const void *pair1, const void *pair2) {
+  size_t subject1 = ((const batch_pair_t *)pair1)->subject;
+  size_t subject2 = ((const batch_pair_t *)pair2)->subject;
+  return (subject1 > subject2) - (subject1 < subject2);
+}
+
+/**
+ * Tests one polygon against up to COLLISION_BATCH_MAX of the rectangles
+ * paired with it, and marks the pairs it does not touch as checked and
+ * apart.
+ */
+void layer_batch_test(layer_batch_t *batch, const batch_pair_t *pairs,
+                      size_t count, pair_cache_t *cache, size_t tick) {
+  body_t *subject = pairs[0].body;
+  collision_box_t boxes[COLLISION_BATCH_MAX];
+  vector_t axes[COLLISION_BATCH_MAX];
+  for (size_t i = 0; i < count; i++) {
+    boxes[i] = layer_batch_get_body(batch, pairs[i].other)->box;
+  }
+  uint32_t hits =
+      find_collision_batch(body_get_shape_view(subject),
+                           body_get_normals(subject), boxes, count, axes);
+  for (size_t i = 0; i < count; i++) {
+    if ((hits >> i) & 1) {
+      continue;
+    }
+    pair_entry_t *entry =
+        pair_cache_visit(cache, body_get_handle(subject),
+                         body_get_handle(pairs[i].other), tick);
+    entry->checked = true;
+    entry->touching = false;
+  }
+}
+
+void layer_batch_run(layer_batch_t *batch, body_pair_view_t pairs,
+                     pair_cache_t *cache, size_t tick) {
+  batch->run++;
+  layer_batch_reserve(batch, pairs);
+  for (size_t i = 0; i < pairs.size; i++) {
+    batch_body_t *batch1 = layer_batch_get_body(batch, pairs.pairs[i].body1);
+    batch_body_t *batch2 = layer_batch_get_body(batch, pairs.pairs[i].body2);
+    if (batch1 != NULL && batch2 != NULL &&
+        (batch1->is_box || batch2->is_box)) {
+      batch1->pair_count++;
+      batch2->pair_count++;
+    }
+  }
+  batch->pair_count = 0;
+  for (size_t i = 0; i < pairs.size; i++) {
+    body_t *body1 = pairs.pairs[i].body1;
+    body_t *body2 = pairs.pairs[i].body2;
+    batch_body_t *batch1 = layer_batch_get_body(batch, body1);
+    batch_body_t *batch2 = layer_batch_get_body(batch, body2);
+    if (batch1 == NULL || batch2 == NULL ||
+        (!batch1->is_box && !batch2->is_box)) {
+      continue;
+    }
+    if (batch2->is_box &&
+        (!batch1->is_box || batch1->pair_count >= batch2->pair_count)) {
+      layer_batch_add_pair(batch, body1, body2);
+    } else {
+      layer_batch_add_pair(batch, body2, body1);
+    }
+  }
+  if (batch->pair_count == 0) {
+    return;
+  }
+  qsort(batch->pairs, batch->pair_count, sizeof(batch_pair_t),
+        compare_batch_subject);
+  size_t start = 0;
+  while (start < batch->pair_count) {
+    size_t end = start + 1;
+    while (end < batch->pair_count &&
+           batch->pairs[end].subject == batch->pairs[start].subject) {
+      end++;
+    }
+    for (size_t i = start; end - start > 1 && i < end;
+         i += COLLISION_BATCH_MAX) {
+      size_t count = end - i;
+      layer_batch_test(batch, &batch->pairs[i],
+                       count < COLLISION_BATCH_MAX ? count
+                                                   : COLLISION_BATCH_MAX,
+                       cache, tick);
+    }
+    start = end;
+  }
+}
@@ -0,0 +1,127 @@
+#include "layer_table.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * A force creator that acts on every pair of bodies on two layers.
+ */
+typedef struct layer_force {
+  size_t layer1;
+  size_t layer2;
+  layer_force_creator_t forcer;
+  void *aux;
+  free_func_t freer;
+} layer_force_t;
+
+/**
+ * masks[i] has bit j set if some force creator acts on layers i and j.
+ */
+typedef struct layer_table {
+  layer_force_t *forces;
+  size_t force_count;
+  size_t force_capacity;
+  uint32_t masks[MAX_COLLISION_LAYERS];
+  body_pair_t *pairs;
+  size_t pair_count;
+  size_t pair_capacity;
+} layer_table_t;
+
+const size_t LAYER_TABLE_INITIAL_SIZE = 10;
+
+layer_table_t *layer_table_init(void) {
+  layer_table_t *table = malloc(sizeof(layer_table_t));
+  assert(table != NULL);
+  table->forces = NULL;
+  table->force_count = 0;
+  table->force_capacity = 0;
+  for (size_t i = 0; i < MAX_COLLISION_LAYERS; i++) {
+    table->masks[i] = 0;
+  }
+  table->pairs = NULL;
+  table->pair_count = 0;
+  table->pair_capacity = 0;
+  return table;
+}
+
+void layer_table_free(layer_table_t *table) {
+  for (size_t i = 0; i < table->force_count; i++) {
+    layer_force_t *force = &table->forces[i];
+    if (force->freer != NULL) {
+      force->freer(force->aux);
+    }
+  }
+  free(table->forces);
+  free(table->pairs);
+  free(table);
+}
+
+void layer_table_add_force(layer_table_t *table, size_t layer1,
+                           size_t layer2, layer_force_creator_t forcer,
+                           void *aux, free_func_t freer) {
+  assert(layer1 != COLLISION_LAYER_NONE && layer1 < MAX_COLLISION_LAYERS);
+  assert(layer2 != COLLISION_LAYER_NONE && layer2 < MAX_COLLISION_LAYERS);
+  if (table->force_count == table->force_capacity) {
+    table->force_capacity = table->force_capacity == 0
+                                ? LAYER_TABLE_INITIAL_SIZE
+                                : table->force_capacity * 2;
+    table->forces = realloc(table->forces,
+                            table->force_capacity * sizeof(layer_force_t));
+    assert(table->forces != NULL);
+  }
+  table->forces[table->force_count++] =
+      (layer_force_t){.layer1 = layer1,
+                      .layer2 = layer2,
+                      .forcer = forcer,
+                      .aux = aux,
+                      .freer = freer};
+  table->masks[layer1] |= (uint32_t)1 << layer2;
+  table->masks[layer2] |= (uint32_t)1 << layer1;
+}
+
+bool layer_table_has_layer(layer_table_t *table, size_t layer) {
+  return table->masks[layer] != 0;
+}
+
+bool layer_table_pairs_bodies(layer_table_t *table, body_t *body1,
+                              body_t *body2) {
+  size_t layer1 = body_get_collision_layer(body1);
+  size_t layer2 = body_get_collision_layer(body2);
+  return (table->masks[layer1] & ((uint32_t)1 << layer2)) != 0;
+}
+
+void layer_table_add_pair(layer_table_t *table, body_t *body1, body_t *body2) {
+  if (table->pair_count == table->pair_capacity) {
+    table->pair_capacity = table->pair_capacity == 0
+                               ? LAYER_TABLE_INITIAL_SIZE
+                               : table->pair_capacity * 2;
+    table->pairs =
+        realloc(table->pairs, table->pair_capacity * sizeof(body_pair_t));
+    assert(table->pairs != NULL);
+  }
+  table->pairs[table->pair_count++] =
+      (body_pair_t){.body1 = body1, .body2 = body2};
+}
+
+void layer_table_clear_pairs(layer_table_t *table) { table->pair_count = 0; }
+
+body_pair_view_t layer_table_get_pairs(layer_table_t *table) {
+  return (body_pair_view_t){.pairs = table->pairs, .size = table->pair_count};
+}
+
+void layer_table_run(layer_table_t *table) {
+  for (size_t i = 0; i < table->force_count; i++) {
+    layer_force_t *force = &table->forces[i];
+    for (size_t j = 0; j < table->pair_count; j++) {
+      body_t *body1 = table->pairs[j].body1;
+      body_t *body2 = table->pairs[j].body2;
+      size_t layer1 = body_get_collision_layer(body1);
+      size_t layer2 = body_get_collision_layer(body2);
+      if (layer1 == force->layer1 && layer2 == force->layer2) {
+        force->forcer(body1, body2, force->aux);
+      } else if (layer1 == force->layer2 && layer2 == force->layer1) {
+        force->forcer(body2, body1, force->aux);
+      }
+    }
+  }
+}
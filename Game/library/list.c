@@ -1,43 +1,99 @@
 #include "list.h"
+#include "pool.h"
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 typedef struct list {
   void **data;
   size_t size;
   size_t capacity;
   free_func_t freer;
+  arena_t *arena;
+  void *inline_data[LIST_INLINE_CAPACITY];
 } list_t;
 
 const size_t RESIZE_FAC = 2;
+const size_t LIST_POOL_SLAB = 64;
+
+pool_t *list_pool = NULL;
+
+pool_t *list_get_pool(void) {
+  if (list_pool == NULL) {
+    list_pool = pool_init(sizeof(list_t), LIST_POOL_SLAB);
+  }
+  return list_pool;
+}
+
+pool_stats_t list_get_pool_stats(void) {
+  return pool_get_stats(list_get_pool());
+}
 
 void list_resize(list_t *list) {
   if (list->size == list->capacity) {
-    list->capacity = list->capacity == 0 ? 1 : list->capacity * RESIZE_FAC;
-    list->data = realloc(list->data, list->capacity * sizeof(void *));
+    list->capacity *= RESIZE_FAC;
+    if (list->arena != NULL) {
+      void **data = arena_alloc(list->arena, list->capacity * sizeof(void *));
+      memcpy(data, list->data, list->size * sizeof(void *));
+      list->data = data;
+    } else if (list->data == list->inline_data) {
+      list->data = malloc(list->capacity * sizeof(void *));
+      assert(list->data != NULL);
+      memcpy(list->data, list->inline_data, list->size * sizeof(void *));
+    } else {
+      list->data = realloc(list->data, list->capacity * sizeof(void *));
+      assert(list->data != NULL);
+    }
   }
 }
 
 list_t *list_init(size_t initial_size, free_func_t freer) {
-  list_t *output = malloc(sizeof(list_t));
-  assert(output != NULL);
-  output->data = malloc(initial_size * sizeof(void *));
-  output->capacity = initial_size;
+  list_t *output = pool_alloc(list_get_pool());
+  if (initial_size <= LIST_INLINE_CAPACITY) {
+    output->data = output->inline_data;
+    output->capacity = LIST_INLINE_CAPACITY;
+  } else {
+    output->data = malloc(initial_size * sizeof(void *));
+    assert(output->data != NULL);
+    output->capacity = initial_size;
+  }
   output->size = 0;
   output->freer = freer;
+  output->arena = NULL;
   return output;
 };
 
+list_t *list_init_in_arena(arena_t *arena, size_t initial_size,
+                           free_func_t freer) {
+  list_t *output = arena_alloc(arena, sizeof(list_t));
+  if (initial_size <= LIST_INLINE_CAPACITY) {
+    output->data = output->inline_data;
+    output->capacity = LIST_INLINE_CAPACITY;
+  } else {
+    output->data = arena_alloc(arena, initial_size * sizeof(void *));
+    output->capacity = initial_size;
+  }
+  output->size = 0;
+  output->freer = freer;
+  output->arena = arena;
+  return output;
+}
+
 void list_free(list_t *list) {
   if (list->freer != NULL) {
     for (size_t i = 0; i < list->size; i++) {
       list->freer(list->data[i]);
     }
   }
-  free(list->data);
-  free(list);
+  if (list->arena != NULL) {
+    return;
+  }
+  if (list->data != list->inline_data) {
+    free(list->data);
+  }
+  pool_release(list_get_pool(), list);
 };
 
 size_t list_size(list_t *list) { return list->size; }
@@ -0,0 +1,193 @@
+#include "pair_cache.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * entries and spare have capacity slots each, a power of two; a slot whose
+ * handle1 is BODY_HANDLE_NONE is empty. Pairs are probed linearly from
+ * their hash, and the table doubles before it is half full.
+ * Removing pairs rehashes the live ones into spare and swaps the arrays,
+ * so probe chains never have holes.
+ */
+typedef struct pair_cache {
+  pair_entry_t *entries;
+  pair_entry_t *spare;
+  size_t capacity;
+  size_t size;
+} pair_cache_t;
+
+const size_t PAIR_CACHE_INITIAL_SIZE = 64;
+
+pair_entry_t *pair_cache_alloc_entries(size_t capacity) {
+  pair_entry_t *entries = malloc(capacity * sizeof(pair_entry_t));
+  assert(entries != NULL);
+  for (size_t i = 0; i < capacity; i++) {
+    entries[i].handle1 = BODY_HANDLE_NONE;
+  }
+  return entries;
+}
+
+pair_cache_t *pair_cache_init(void) {
+  pair_cache_t *cache = malloc(sizeof(pair_cache_t));
+  assert(cache != NULL);
+  cache->capacity = PAIR_CACHE_INITIAL_SIZE;
+  cache->size = 0;
+  cache->entries = pair_cache_alloc_entries(cache->capacity);
+  cache->spare = pair_cache_alloc_entries(cache->capacity);
+  return cache;
+}
+
+void pair_cache_free(pair_cache_t *cache) {
+  free(cache->entries);
+  free(cache->spare);
+  free(cache);
+}
+
+size_t pair_cache_size(pair_cache_t *cache) { return cache->size; }
+
+bool pair_slot_empty(const pair_entry_t *entry) {
+  return entry->handle1.generation == 0;
+}
+
+bool pair_handles_equal(body_handle_t handle1, body_handle_t handle2) {
+  return handle1.index == handle2.index &&
+         handle1.generation == handle2.generation;
+}
+
+uint64_t pair_hash_handle(body_handle_t handle) {
+  uint64_t key = (uint64_t)handle.index << 32 ^ handle.generation;
+  key *= 0x9E3779B97F4A7C15ULL;
+  return key ^ key >> 29;
+}
+
+/**
+ * Hashes a pair the same way whichever order its handles are in.
+ */
+size_t pair_hash(body_handle_t handle1, body_handle_t handle2) {
+  return (size_t)(pair_hash_handle(handle1) + pair_hash_handle(handle2));
+}
+
+/**
+ * Finds the slot holding a pair, or the empty slot where it would go.
+ */
+pair_entry_t *pair_cache_probe(pair_entry_t *entries, size_t capacity,
+                               body_handle_t handle1, body_handle_t handle2) {
+  size_t mask = capacity - 1;
+  size_t i = pair_hash(handle1, handle2) & mask;
+  while (true) {
+    pair_entry_t *entry = &entries[i];
+    if (pair_slot_empty(entry) ||
+        (pair_handles_equal(entry->handle1, handle1) &&
+         pair_handles_equal(entry->handle2, handle2)) ||
+        (pair_handles_equal(entry->handle1, handle2) &&
+         pair_handles_equal(entry->handle2, handle1))) {
+      return entry;
+    }
+    i = (i + 1) & mask;
+  }
+}
+
+/**
+ * Moves the live entries into the spare array, which is resized to the
+ * given capacity, and swaps the arrays. Entries from before the given tick
+ * are dropped along the way.
+ */
+void pair_cache_rehash(pair_cache_t *cache, size_t capacity, size_t tick) {
+  if (capacity != cache->capacity) {
+    free(cache->spare);
+    cache->spare = pair_cache_alloc_entries(capacity);
+  } else {
+    for (size_t i = 0; i < capacity; i++) {
+      cache->spare[i].handle1 = BODY_HANDLE_NONE;
+    }
+  }
+  size_t size = 0;
+  for (size_t i = 0; i < cache->capacity; i++) {
+    pair_entry_t *entry = &cache->entries[i];
+    if (pair_slot_empty(entry) || entry->tick < tick) {
+      continue;
+    }
+    *pair_cache_probe(cache->spare, capacity, entry->handle1,
+                      entry->handle2) = *entry;
+    size++;
+  }
+  pair_entry_t *entries = cache->entries;
+  cache->entries = cache->spare;
+  cache->spare = entries;
+  if (capacity != cache->capacity) {
+    free(cache->spare);
+    cache->spare = pair_cache_alloc_entries(capacity);
+  }
+  cache->capacity = capacity;
+  cache->size = size;
+}
+
+pair_entry_t *pair_cache_find(pair_cache_t *cache, body_handle_t handle1,
+                              body_handle_t handle2) {
+  pair_entry_t *entry =
+      pair_cache_probe(cache->entries, cache->capacity, handle1, handle2);
+  return pair_slot_empty(entry) ? NULL : entry;
+}
+
+pair_entry_t *pair_cache_visit(pair_cache_t *cache, body_handle_t handle1,
+                               body_handle_t handle2, size_t tick) {
+  assert(handle1.generation != 0 && handle2.generation != 0);
+  pair_entry_t *entry =
+      pair_cache_probe(cache->entries, cache->capacity, handle1, handle2);
+  if (pair_slot_empty(entry)) {
+    if (2 * (cache->size + 1) > cache->capacity) {
+      pair_cache_rehash(cache, 2 * cache->capacity, 0);
+      entry =
+          pair_cache_probe(cache->entries, cache->capacity, handle1, handle2);
+    }
+    *entry = (pair_entry_t){.handle1 = handle1,
+                            .handle2 = handle2,
+                            .tick = tick,
+                            .checked = false,
+                            .touching = false,
+                            .was_touching = false,
+                            .direction = VEC_ZERO};
+    cache->size++;
+    return entry;
+  }
+  pair_cache_touch(cache, entry, tick);
+  return entry;
+}
+
+void pair_cache_touch(pair_cache_t *cache, pair_entry_t *entry, size_t tick) {
+  assert(entry >= cache->entries && entry < cache->entries + cache->capacity &&
+         !pair_slot_empty(entry));
+  if (entry->tick != tick) {
+    entry->was_touching = entry->tick + 1 == tick && entry->touching;
+    entry->touching = false;
+    entry->checked = false;
+    entry->tick = tick;
+  }
+}
+
+void pair_cache_remove_stale(pair_cache_t *cache, size_t tick) {
+  for (size_t i = 0; i < cache->capacity; i++) {
+    pair_entry_t *entry = &cache->entries[i];
+    if (!pair_slot_empty(entry) && entry->tick < tick) {
+      pair_cache_rehash(cache, cache->capacity, tick);
+      return;
+    }
+  }
+}
+
+void pair_cache_for_each(pair_cache_t *cache, pair_visitor_t visitor,
+                         void *aux) {
+  for (size_t i = 0; i < cache->capacity; i++) {
+    if (!pair_slot_empty(&cache->entries[i])) {
+      visitor(&cache->entries[i], aux);
+    }
+  }
+}
+
+pair_state_t pair_entry_get_state(const pair_entry_t *entry) {
+  if (entry->touching) {
+    return entry->was_touching ? PAIR_STAY : PAIR_ENTER;
+  }
+  return entry->was_touching ? PAIR_EXIT : PAIR_APART;
+}
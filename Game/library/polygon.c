@@ -1,51 +1,152 @@
 #include "polygon.h"
+#include "pool.h"
+#include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 typedef struct polygon {
-  vector_t velocity;
-  list_t *shape;
-  float R;
-  float G;
-  float B;
+  vector_t *vertices;
+  size_t size;
+  size_t capacity;
+  vector_t inline_vertices[POLYGON_INLINE_CAPACITY];
 } polygon_t;
 
-polygon_t *polygon_init() {
-  polygon_t *output = malloc(sizeof(polygon_t));
-  return output;
-};
+const size_t POLYGON_RESIZE_FAC = 2;
+const size_t POLYGON_POOL_SLAB = 64;
+
+pool_t *polygon_pool = NULL;
+
+pool_t *polygon_get_pool(void) {
+  if (polygon_pool == NULL) {
+    polygon_pool = pool_init(sizeof(polygon_t), POLYGON_POOL_SLAB);
+  }
+  return polygon_pool;
+}
+
+pool_stats_t polygon_get_pool_stats(void) {
+  return pool_get_stats(polygon_get_pool());
+}
+
+polygon_t *polygon_init(size_t capacity) {
+  polygon_t *polygon = pool_alloc(polygon_get_pool());
+  if (capacity <= POLYGON_INLINE_CAPACITY) {
+    polygon->vertices = polygon->inline_vertices;
+    polygon->capacity = POLYGON_INLINE_CAPACITY;
+  } else {
+    polygon->vertices = malloc(capacity * sizeof(vector_t));
+    assert(polygon->vertices != NULL);
+    polygon->capacity = capacity;
+  }
+  polygon->size = 0;
+  return polygon;
+}
 
 void polygon_free(polygon_t *polygon) {
-  list_free(polygon->shape);
-  free(polygon);
-};
+  if (polygon->vertices != polygon->inline_vertices) {
+    free(polygon->vertices);
+  }
+  pool_release(polygon_get_pool(), polygon);
+}
 
-vector_t polygon_get_velocity(polygon_t *polygon) { return polygon->velocity; }
+polygon_t *polygon_copy(polygon_t *polygon) {
+  polygon_t *copy = polygon_init(polygon->size);
+  memcpy(copy->vertices, polygon->vertices, polygon->size * sizeof(vector_t));
+  copy->size = polygon->size;
+  return copy;
+}
 
-list_t *polygon_get_vertices(polygon_t *polygon) { return polygon->shape; }
+polygon_t *polygon_from_list(list_t *shape) {
+  size_t n = list_size(shape);
+  polygon_t *polygon = polygon_init(n);
+  for (size_t i = 0; i < n; i++) {
+    polygon->vertices[i] = *(vector_t *)list_get(shape, i);
+  }
+  polygon->size = n;
+  return polygon;
+}
 
-float polygon_get_R(polygon_t *polygon) { return polygon->R; }
+list_t *polygon_to_list(polygon_t *polygon) {
+  list_t *shape = list_init(polygon->size, (free_func_t)free);
+  for (size_t i = 0; i < polygon->size; i++) {
+    vector_t *point = malloc(sizeof(vector_t));
+    *point = polygon->vertices[i];
+    list_add(shape, point);
+  }
+  return shape;
+}
 
-float polygon_get_G(polygon_t *polygon) { return polygon->G; }
+size_t polygon_size(polygon_t *polygon) { return polygon->size; }
 
-float polygon_get_B(polygon_t *polygon) { return polygon->B; }
+vector_t *polygon_vertices(polygon_t *polygon) { return polygon->vertices; }
 
-void polygon_set_velocity(polygon_t *polygon, vector_t velocity) {
-  polygon->velocity = velocity;
+polygon_view_t polygon_get_view(polygon_t *polygon) {
+  return (polygon_view_t){.vertices = polygon->vertices,
+                          .size = polygon->size};
 }
 
-void *polygon_set_vertices(polygon_t *polygon, list_t *shape) {
-  return polygon->shape = shape;
+vector_t polygon_get(polygon_t *polygon, size_t index) {
+  assert(index < polygon->size);
+  return polygon->vertices[index];
 }
 
-void polygon_set_R(polygon_t *polygon, float R) { polygon->R = R; }
+void polygon_add(polygon_t *polygon, vector_t vertex) {
+  if (polygon->size == polygon->capacity) {
+    size_t capacity = polygon->capacity * POLYGON_RESIZE_FAC;
+    vector_t *vertices = malloc(capacity * sizeof(vector_t));
+    assert(vertices != NULL);
+    memcpy(vertices, polygon->vertices, polygon->size * sizeof(vector_t));
+    if (polygon->vertices != polygon->inline_vertices) {
+      free(polygon->vertices);
+    }
+    polygon->vertices = vertices;
+    polygon->capacity = capacity;
+  }
+  polygon->vertices[polygon->size] = vertex;
+  polygon->size++;
+}
 
-void polygon_set_G(polygon_t *polygon, float G) { polygon->G = G; }
+double vertices_area(const vector_t *vertices, size_t n_sides) {
+  double area = 0;
+  for (size_t i = 0; i < n_sides; i++) {
+    area += vec_cross(vertices[i], vertices[(i + 1) % n_sides]);
+  }
+  return 0.5 * area;
+}
 
-void polygon_set_B(polygon_t *polygon, float B) { polygon->B = B; }
+vector_t vertices_centroid(const vector_t *vertices, size_t n_sides) {
+  double factor = 6 * vertices_area(vertices, n_sides);
+  double center_x = 0;
+  double center_y = 0;
+  for (size_t i = 0; i < n_sides; i++) {
+    vector_t v1 = vertices[i];
+    vector_t v2 = vertices[(i + 1) % n_sides];
+    center_x += vec_cross(v1, v2) * (v1.x + v2.x);
+    center_y += vec_cross(v1, v2) * (v1.y + v2.y);
+  }
+  return (vector_t){center_x / factor, center_y / factor};
+}
 
-void polygon_change_velocity(polygon_t *polygon, vector_t delta_v) {
-  polygon->velocity = vec_add(polygon->velocity, delta_v);
+double polygon_get_area(polygon_t *polygon) {
+  return vertices_area(polygon->vertices, polygon->size);
+}
+
+vector_t polygon_get_centroid(polygon_t *polygon) {
+  return vertices_centroid(polygon->vertices, polygon->size);
+}
+
+void polygon_translate_vertices(polygon_t *polygon, vector_t translation) {
+  for (size_t i = 0; i < polygon->size; i++) {
+    polygon->vertices[i] = vec_add(polygon->vertices[i], translation);
+  }
+}
+
+void polygon_rotate_vertices(polygon_t *polygon, double angle, vector_t point) {
+  for (size_t i = 0; i < polygon->size; i++) {
+    polygon->vertices[i] =
+        vec_add(vec_rotate(vec_subtract(polygon->vertices[i], point), angle),
+                point);
+  }
 }
 
 vector_t *void_to_vector(list_t *polygon, size_t index) {
@@ -90,4 +191,4 @@ void polygon_rotate(list_t *polygon, double angle, vector_t point) {
     *void_to_vector(polygon, i) =
         vec_add(vec_rotate(vec_subtract(*vertex, point), angle), point);
   }
-};
\ No newline at end of file
+};
@@ -0,0 +1,113 @@
+#include "pool.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/**
+ * A free object stores the next free object in its first bytes.
+ */
+typedef struct free_object {
+  struct free_object *next;
+} free_object_t;
+
+typedef struct pool {
+  size_t stride;
+  size_t objects_per_slab;
+  void **slabs;
+  size_t slab_count;
+  size_t slab_capacity;
+  free_object_t *free_list;
+  pool_stats_t stats;
+} pool_t;
+
+const size_t POOL_INITIAL_SLABS = 4;
+
+/**
+ * Rounds an object size up so that consecutive objects never straddle a
+ * cache line: small objects get the next power of two, and objects larger
+ * than a line get a whole number of lines.
+ */
+size_t pool_stride(size_t object_size) {
+  if (object_size < sizeof(free_object_t)) {
+    object_size = sizeof(free_object_t);
+  }
+  if (object_size > POOL_CACHE_LINE) {
+    return (object_size + POOL_CACHE_LINE - 1) / POOL_CACHE_LINE *
+           POOL_CACHE_LINE;
+  }
+  size_t stride = sizeof(free_object_t);
+  while (stride < object_size) {
+    stride *= 2;
+  }
+  return stride;
+}
+
+pool_t *pool_init(size_t object_size, size_t objects_per_slab) {
+  assert(objects_per_slab > 0);
+  pool_t *pool = malloc(sizeof(pool_t));
+  assert(pool != NULL);
+  pool->stride = pool_stride(object_size);
+  pool->objects_per_slab = objects_per_slab;
+  pool->slabs = NULL;
+  pool->slab_count = 0;
+  pool->slab_capacity = 0;
+  pool->free_list = NULL;
+  pool->stats = (pool_stats_t){0};
+  return pool;
+}
+
+void pool_free(pool_t *pool) {
+  for (size_t i = 0; i < pool->slab_count; i++) {
+    free(pool->slabs[i]);
+  }
+  free(pool->slabs);
+  free(pool);
+}
+
+/**
+ * Allocates another slab and threads all of its objects onto the free list.
+ */
+void pool_grow(pool_t *pool) {
+  if (pool->slab_count == pool->slab_capacity) {
+    pool->slab_capacity = pool->slab_capacity == 0 ? POOL_INITIAL_SLABS
+                                                   : pool->slab_capacity * 2;
+    pool->slabs = realloc(pool->slabs, pool->slab_capacity * sizeof(void *));
+    assert(pool->slabs != NULL);
+  }
+  // aligned_alloc() requires the size to be a multiple of the alignment
+  size_t size = pool->stride * pool->objects_per_slab;
+  size = (size + POOL_CACHE_LINE - 1) / POOL_CACHE_LINE * POOL_CACHE_LINE;
+  char *slab = aligned_alloc(POOL_CACHE_LINE, size);
+  assert(slab != NULL);
+  pool->slabs[pool->slab_count++] = slab;
+
+  for (size_t i = pool->objects_per_slab; i > 0; i--) {
+    free_object_t *object = (free_object_t *)(slab + (i - 1) * pool->stride);
+    object->next = pool->free_list;
+    pool->free_list = object;
+  }
+  pool->stats.capacity += pool->objects_per_slab;
+  pool->stats.slabs++;
+}
+
+void *pool_alloc(pool_t *pool) {
+  if (pool->free_list == NULL) {
+    pool_grow(pool);
+  }
+  free_object_t *object = pool->free_list;
+  pool->free_list = object->next;
+  pool->stats.live++;
+  if (pool->stats.live > pool->stats.peak) {
+    pool->stats.peak = pool->stats.live;
+  }
+  return object;
+}
+
+void pool_release(pool_t *pool, void *object) {
+  assert(pool->stats.live > 0);
+  free_object_t *freed = object;
+  freed->next = pool->free_list;
+  pool->free_list = freed;
+  pool->stats.live--;
+}
+
+pool_stats_t pool_get_stats(pool_t *pool) { return pool->stats; }
@@ -0,0 +1,277 @@
+#include "query_index.h"
+#include "collision.h"
+#include "spatial_grid.h"
+#include "sweep_and_prune.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+/**
+ * grid or sweep, whichever matches the broadphase, holds the boxes of the
+ * moving bodies, and bodies[i] is the body whose handle has index i among
+ * them. Only ids inserted since the index was last cleared are reported by
+ * either, so the entries they lead to are always current.
+ */
+typedef struct query_index {
+  spatial_grid_t *grid;
+  sweep_and_prune_t *sweep;
+  body_t **bodies;
+  size_t body_capacity;
+  bool stale;
+  bvh_t *static_tree;
+  static_lookup_t lookup;
+  void *lookup_aux;
+} query_index_t;
+
+const size_t QUERY_INDEX_INITIAL_SIZE = 10;
+const double QUERY_GRID_CELL_SIZE = 100;
+
+query_index_t *query_index_init(broadphase_t broadphase) {
+  query_index_t *index = malloc(sizeof(query_index_t));
+  assert(index != NULL);
+  index->grid = NULL;
+  index->sweep = NULL;
+  if (broadphase == BROADPHASE_GRID) {
+    index->grid = spatial_grid_init(QUERY_GRID_CELL_SIZE);
+  } else {
+    index->sweep = sweep_and_prune_init();
+  }
+  index->bodies = NULL;
+  index->body_capacity = 0;
+  index->stale = true;
+  index->static_tree = NULL;
+  index->lookup = NULL;
+  index->lookup_aux = NULL;
+  return index;
+}
+
+void query_index_free(query_index_t *index) {
+  if (index->grid != NULL) {
+    spatial_grid_free(index->grid);
+  }
+  if (index->sweep != NULL) {
+    sweep_and_prune_free(index->sweep);
+  }
+  free(index->bodies);
+  free(index);
+}
+
+void query_index_mark_stale(query_index_t *index) { index->stale = true; }
+
+bool query_index_is_stale(query_index_t *index) { return index->stale; }
+
+void query_index_clear(query_index_t *index) {
+  if (index->grid != NULL) {
+    spatial_grid_clear(index->grid);
+  }
+}
+
+void query_index_insert(query_index_t *index, body_t *body) {
+  size_t id = body_get_handle(body).index;
+  if (id >= index->body_capacity) {
+    size_t capacity = index->body_capacity == 0 ? QUERY_INDEX_INITIAL_SIZE
+                                                : index->body_capacity;
+    while (capacity <= id) {
+      capacity *= 2;
+    }
+    index->bodies = realloc(index->bodies, capacity * sizeof(body_t *));
+    assert(index->bodies != NULL);
+    index->body_capacity = capacity;
+  }
+  index->bodies[id] = body;
+  aabb_t box = body_get_aabb(body);
+  if (index->grid != NULL) {
+    spatial_grid_insert(index->grid, id, box);
+  } else {
+    sweep_and_prune_insert(index->sweep, id, box);
+  }
+}
+
+void query_index_commit(query_index_t *index) {
+  if (index->sweep != NULL) {
+    sweep_and_prune_commit(index->sweep);
+  }
+  index->stale = false;
+}
+
+void query_index_set_statics(query_index_t *index, bvh_t *tree,
+                             static_lookup_t lookup, void *aux) {
+  index->static_tree = tree;
+  index->lookup = lookup;
+  index->lookup_aux = aux;
+}
+
+/**
+ * The closest hit found so far by a segment query.
+ */
+typedef struct segment_query {
+  query_index_t *index;
+  vector_t start;
+  vector_t delta;
+  uint32_t layers;
+  double fraction;
+  body_t *body;
+  vector_t normal;
+} segment_query_t;
+
+/**
+ * Tests a body against a segment query, keeping it if it is on one of the
+ * query's layers and is hit before the closest hit so far.
+ */
+void query_index_test_segment_body(segment_query_t *query, body_t *body) {
+  size_t layer = body_get_collision_layer(body);
+  if (body_is_removed(body) || (query->layers & ((uint32_t)1 << layer)) == 0) {
+    return;
+  }
+  if (aabb_segment_entry(body_get_aabb(body), query->start, query->delta,
+                         query->fraction) == INFINITY) {
+    return;
+  }
+  vector_t normal;
+  double fraction = find_body_segment_hit(body, query->start, query->delta,
+                                          query->fraction, &normal);
+  if (fraction < query->fraction) {
+    query->fraction = fraction;
+    query->body = body;
+    query->normal = normal;
+  }
+}
+
+/**
+ * Called by the static tree with the id of a static body the segment passes
+ * near. The body may have been removed since the tree was built.
+ */
+double query_index_test_static_segment(size_t id, double max_fraction,
+                                       segment_query_t *query) {
+  query_index_t *index = query->index;
+  body_t *body = index->lookup(id, index->lookup_aux);
+  if (body != NULL) {
+    query_index_test_segment_body(query, body);
+  }
+  return query->fraction;
+}
+
+/**
+ * Called with the id of a moving body whose box the segment passes through.
+ * Returning the closest hit so far, which may be a static body, stops the
+ * search past it.
+ */
+double query_index_test_moving_segment(size_t id, double max_fraction,
+                                       segment_query_t *query) {
+  query_index_test_segment_body(query, query->index->bodies[id]);
+  return query->fraction;
+}
+
+bool query_index_segment(query_index_t *index, vector_t start, vector_t end,
+                         uint32_t layers, ray_hit_t *hit) {
+  assert(!index->stale);
+  segment_query_t query = {.index = index,
+                           .start = start,
+                           .delta = vec_subtract(end, start),
+                           .layers = layers,
+                           .fraction = 1,
+                           .body = NULL,
+                           .normal = VEC_ZERO};
+  if (index->static_tree != NULL) {
+    bvh_query_segment(index->static_tree, start, end,
+                      (bvh_segment_handler_t)query_index_test_static_segment,
+                      &query);
+  }
+  if (index->grid != NULL) {
+    spatial_grid_query_segment(
+        index->grid, start, end,
+        (grid_segment_handler_t)query_index_test_moving_segment, &query);
+  } else {
+    sweep_and_prune_query_segment(
+        index->sweep, start, end,
+        (sweep_segment_handler_t)query_index_test_moving_segment, &query);
+  }
+  double length = sqrt(vec_dot(query.delta, query.delta));
+  *hit = (ray_hit_t){
+      .body = query.body,
+      .distance = query.body != NULL ? query.fraction * length : INFINITY,
+      .point = vec_add(start, vec_multiply(query.fraction, query.delta)),
+      .normal = query.normal};
+  return query.body != NULL;
+}
+
+/**
+ * The region a radius or box query looks in. A radius query has a positive
+ * radius and only accepts bodies that overlap its circle, not just the box
+ * around it.
+ */
+typedef struct region_query {
+  query_index_t *index;
+  aabb_t box;
+  vector_t center;
+  double radius;
+  uint32_t layers;
+  body_visitor_t visitor;
+  void *aux;
+  size_t count;
+} region_query_t;
+
+/**
+ * Passes a body to a region query's visitor if it is on one of the query's
+ * layers and lies in the query's region.
+ */
+void query_index_test_region_body(region_query_t *query, body_t *body) {
+  size_t layer = body_get_collision_layer(body);
+  if (body_is_removed(body) || (query->layers & ((uint32_t)1 << layer)) == 0 ||
+      !aabb_overlaps(body_get_aabb(body), query->box)) {
+    return;
+  }
+  if (query->radius > 0 &&
+      !find_body_circle_overlap(body, query->center, query->radius)) {
+    return;
+  }
+  query->count++;
+  query->visitor(body, query->aux);
+}
+
+/**
+ * Called by the static tree with the id of a static body whose box overlaps
+ * the query's. The body may have been removed since the tree was built.
+ */
+void query_index_test_static_region(size_t id, region_query_t *query) {
+  query_index_t *index = query->index;
+  body_t *body = index->lookup(id, index->lookup_aux);
+  if (body != NULL) {
+    query_index_test_region_body(query, body);
+  }
+}
+
+/**
+ * Called with the id of a moving body whose box overlaps the query's.
+ */
+void query_index_test_moving_region(size_t id, region_query_t *query) {
+  query_index_test_region_body(query, query->index->bodies[id]);
+}
+
+size_t query_index_region(query_index_t *index, aabb_t box, vector_t center,
+                          double radius, uint32_t layers,
+                          body_visitor_t visitor, void *aux) {
+  assert(!index->stale);
+  region_query_t query = {.index = index,
+                          .box = box,
+                          .center = center,
+                          .radius = radius,
+                          .layers = layers,
+                          .visitor = visitor,
+                          .aux = aux,
+                          .count = 0};
+  if (index->static_tree != NULL) {
+    bvh_query(index->static_tree, box,
+              (bvh_hit_handler_t)query_index_test_static_region, &query);
+  }
+  if (index->grid != NULL) {
+    spatial_grid_query(index->grid, box,
+                       (grid_hit_handler_t)query_index_test_moving_region,
+                       &query);
+  } else {
+    sweep_and_prune_query(index->sweep, box,
+                          (sweep_hit_handler_t)query_index_test_moving_region,
+                          &query);
+  }
+  return query.count;
+}
@@ -1,22 +1,142 @@
 #include "scene.h"
 #include "body.h"
+#include "bvh.h"
+#include "collision.h"
+#include "contact_queue.h"
+#include "continuous_sweep.h"
+#include "event_queue.h"
+#include "layer_batch.h"
+#include "layer_table.h"
+#include "pool.h"
+#include "query_index.h"
+#include "spatial_grid.h"
+#include "sweep_and_prune.h"
+#include "tag_index.h"
 #include <assert.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#define FORCE_INLINE_BODIES 2
+
+/**
+ * A registered force creator.
+ * link_positions[i] is where the force sits in the link array of the slot
+ * holding its i-th body, or NO_LINK if that body was not in the scene when
+ * the force was added. Forces with any such body are also kept "loose" and
+ * are checked for removed bodies every tick, as before.
+ * Forces with at most FORCE_INLINE_BODIES bodies keep their link positions
+ * inline, so adding one only takes an object from the force pool.
+ * Pair forces only run while the broadphase reports their two bodies as a
+ * candidate pair; candidate_tick is the last tick that happened on, and
+ * sequence orders them by when they were added.
+ */
 typedef struct force {
   force_creator_t forcer;
   void *aux;
   list_t *bodies;
   free_func_t freer;
+  size_t *link_positions;
+  size_t inline_positions[FORCE_INLINE_BODIES];
+  bool loose;
+  bool retired;
+  bool pair;
+  size_t sequence;
+  uint64_t candidate_tick;
 } force_t;
 
+/**
+ * A growable array of forces.
+ */
+typedef struct force_array {
+  force_t **forces;
+  size_t count;
+  size_t capacity;
+} force_array_t;
+
+/**
+ * An entry in a body's list of attached forces: the force and the position
+ * of the body in force->bodies.
+ */
+typedef struct force_link {
+  force_t *force;
+  size_t body_index;
+} force_link_t;
+
+/**
+ * One entry in the scene's slot map.
+ * While occupied, dense_index is the body's position in scene->bodies;
+ * while free, next_free links to the next free slot.
+ * links holds the forces attached to the slot's body, in no particular order,
+ * and pair_link_count counts the pair forces among them.
+ * is_static is set if the body is in the scene's static tree.
+ */
+typedef struct body_slot {
+  uint32_t generation;
+  bool occupied;
+  size_t dense_index;
+  size_t next_free;
+  force_link_t *links;
+  size_t link_count;
+  size_t link_capacity;
+  size_t pair_link_count;
+  bool is_static;
+} body_slot_t;
+
+/**
+ * queries indexes every moving body's current box for spatial queries, and
+ * is marked stale whenever bodies move or are added.
+ */
 typedef struct scene {
-  list_t *bodies;
-  list_t *forces;
+  body_t **bodies;
+  size_t *body_slots;
+  size_t body_count;
+  size_t body_capacity;
+  body_slot_t *slots;
+  size_t slot_count;
+  size_t free_slot;
+  force_array_t forces;
+  force_array_t pair_forces;
+  force_array_t candidates;
+  force_array_t last_candidates;
+  force_array_t pair_run;
+  list_t *loose_forces;
+  bool has_retired_forces;
+  broadphase_t broadphase;
+  spatial_grid_t *grid;
+  sweep_and_prune_t *sweep;
+  bvh_t *static_tree;
+  query_index_t *queries;
+  layer_table_t *layers;
+  pair_cache_t *pairs;
+  contact_queue_t *contacts;
+  event_queue_t *events;
+  continuous_sweep_t *continuous;
+  layer_batch_t *batch;
+  tag_index_t *tags;
+  uint64_t tick;
+  size_t next_sequence;
 } scene_t;
 
 const size_t INITIAL_SIZE = 10;
+const size_t NO_FREE_SLOT = SIZE_MAX;
+const size_t NO_LINK = SIZE_MAX;
+const size_t FORCE_POOL_SLAB = 64;
+const double SCENE_GRID_CELL_SIZE = 100;
+
+pool_t *force_pool = NULL;
+
+pool_t *scene_get_force_pool(void) {
+  if (force_pool == NULL) {
+    force_pool = pool_init(sizeof(force_t), FORCE_POOL_SLAB);
+  }
+  return force_pool;
+}
+
+pool_stats_t scene_get_force_pool_stats(void) {
+  return pool_get_stats(scene_get_force_pool());
+}
 
 void free_force(force_t *force) {
   if (force->freer != NULL) {
@@ -25,31 +145,322 @@ void free_force(force_t *force) {
   if (force->bodies != NULL) {
     list_free(force->bodies);
   }
-  free(force);
+  if (force->link_positions != force->inline_positions) {
+    free(force->link_positions);
+  }
+  pool_release(scene_get_force_pool(), force);
 }
 
-scene_t *scene_init(void) {
+void force_array_add(force_array_t *array, force_t *force) {
+  if (array->count == array->capacity) {
+    array->capacity = array->capacity == 0 ? INITIAL_SIZE : array->capacity * 2;
+    array->forces = realloc(array->forces, array->capacity * sizeof(force_t *));
+    assert(array->forces != NULL);
+  }
+  array->forces[array->count++] = force;
+}
+
+/**
+ * Drops retired forces from an array, keeping the rest in order.
+ * If free_retired is true, the dropped forces are also freed.
+ */
+void force_array_compact(force_array_t *array, bool free_retired) {
+  size_t kept = 0;
+  for (size_t i = 0; i < array->count; i++) {
+    force_t *force = array->forces[i];
+    if (!force->retired) {
+      array->forces[kept++] = force;
+    } else if (free_retired) {
+      free_force(force);
+    }
+  }
+  array->count = kept;
+}
+
+scene_t *scene_init_with_broadphase(broadphase_t broadphase) {
   scene_t *init_scene = malloc(sizeof(scene_t));
   assert(init_scene != NULL);
-  init_scene->bodies = list_init(INITIAL_SIZE, (free_func_t)body_free);
-  init_scene->forces = list_init(INITIAL_SIZE, (free_func_t)free_force);
+  init_scene->bodies = malloc(INITIAL_SIZE * sizeof(body_t *));
+  init_scene->body_slots = malloc(INITIAL_SIZE * sizeof(size_t));
+  init_scene->slots = malloc(INITIAL_SIZE * sizeof(body_slot_t));
+  assert(init_scene->bodies != NULL);
+  assert(init_scene->body_slots != NULL);
+  assert(init_scene->slots != NULL);
+  init_scene->body_count = 0;
+  init_scene->body_capacity = INITIAL_SIZE;
+  init_scene->slot_count = 0;
+  init_scene->free_slot = NO_FREE_SLOT;
+  init_scene->forces = (force_array_t){0};
+  init_scene->pair_forces = (force_array_t){0};
+  init_scene->candidates = (force_array_t){0};
+  init_scene->last_candidates = (force_array_t){0};
+  init_scene->pair_run = (force_array_t){0};
+  init_scene->layers = layer_table_init();
+  init_scene->pairs = pair_cache_init();
+  init_scene->contacts = contact_queue_init();
+  init_scene->events = event_queue_init();
+  init_scene->continuous = continuous_sweep_init();
+  init_scene->batch = layer_batch_init();
+  init_scene->tags = tag_index_init();
+  init_scene->broadphase = broadphase;
+  init_scene->grid = NULL;
+  init_scene->sweep = NULL;
+  if (broadphase == BROADPHASE_GRID) {
+    init_scene->grid = spatial_grid_init(SCENE_GRID_CELL_SIZE);
+  } else {
+    init_scene->sweep = sweep_and_prune_init();
+  }
+  init_scene->queries = query_index_init(broadphase);
+  init_scene->static_tree = NULL;
+  init_scene->tick = 0;
+  init_scene->next_sequence = 0;
+  init_scene->loose_forces = list_init(INITIAL_SIZE, NULL);
+  init_scene->has_retired_forces = false;
   return init_scene;
 }
 
+scene_t *scene_init(void) {
+  return scene_init_with_broadphase(BROADPHASE_GRID);
+}
+
 void scene_free(scene_t *scene) {
-  list_free(scene->forces);
-  list_free(scene->bodies);
+  for (size_t i = 0; i < scene->forces.count; i++) {
+    free_force(scene->forces.forces[i]);
+  }
+  for (size_t i = 0; i < scene->pair_forces.count; i++) {
+    free_force(scene->pair_forces.forces[i]);
+  }
+  free(scene->forces.forces);
+  free(scene->pair_forces.forces);
+  free(scene->candidates.forces);
+  free(scene->last_candidates.forces);
+  free(scene->pair_run.forces);
+  layer_table_free(scene->layers);
+  pair_cache_free(scene->pairs);
+  contact_queue_free(scene->contacts);
+  event_queue_free(scene->events);
+  continuous_sweep_free(scene->continuous);
+  layer_batch_free(scene->batch);
+  tag_index_free(scene->tags);
+  if (scene->grid != NULL) {
+    spatial_grid_free(scene->grid);
+  }
+  if (scene->sweep != NULL) {
+    sweep_and_prune_free(scene->sweep);
+  }
+  query_index_free(scene->queries);
+  if (scene->static_tree != NULL) {
+    bvh_free(scene->static_tree);
+  }
+  list_free(scene->loose_forces);
+  for (size_t i = 0; i < scene->body_count; i++) {
+    body_free(scene->bodies[i]);
+  }
+  for (size_t i = 0; i < scene->slot_count; i++) {
+    free(scene->slots[i].links);
+  }
+  free(scene->bodies);
+  free(scene->body_slots);
+  free(scene->slots);
   free(scene);
 }
 
-size_t scene_bodies(scene_t *scene) { return list_size(scene->bodies); }
+size_t scene_bodies(scene_t *scene) { return scene->body_count; }
+
+size_t scene_get_ticks(scene_t *scene) { return (size_t)scene->tick; }
+
+pair_entry_t *scene_get_pair(scene_t *scene, body_t *body1, body_t *body2) {
+  body_handle_t handle1 = body_get_handle(body1);
+  body_handle_t handle2 = body_get_handle(body2);
+  if (handle1.generation == 0 || handle2.generation == 0) {
+    return NULL;
+  }
+  return pair_cache_visit(scene->pairs, handle1, handle2,
+                          (size_t)scene->tick);
+}
 
 body_t *scene_get_body(scene_t *scene, size_t index) {
-  return (body_t *)(list_get(scene->bodies, index));
+  assert(index < scene->body_count);
+  return scene->bodies[index];
+}
+
+body_t *scene_get_body_by_handle(scene_t *scene, body_handle_t handle) {
+  if (handle.index >= scene->slot_count) {
+    return NULL;
+  }
+  body_slot_t *slot = &scene->slots[handle.index];
+  if (!slot->occupied || slot->generation != handle.generation) {
+    return NULL;
+  }
+  return scene->bodies[slot->dense_index];
+}
+
+/**
+ * Takes a slot off the free list, or appends a new one.
+ * New slots start at generation 1 so that BODY_HANDLE_NONE never resolves.
+ */
+size_t scene_claim_slot(scene_t *scene) {
+  if (scene->free_slot != NO_FREE_SLOT) {
+    size_t index = scene->free_slot;
+    scene->free_slot = scene->slots[index].next_free;
+    return index;
+  }
+  if (scene->slot_count == scene->body_capacity) {
+    scene->body_capacity *= 2;
+    scene->bodies =
+        realloc(scene->bodies, scene->body_capacity * sizeof(body_t *));
+    scene->body_slots =
+        realloc(scene->body_slots, scene->body_capacity * sizeof(size_t));
+    scene->slots =
+        realloc(scene->slots, scene->body_capacity * sizeof(body_slot_t));
+    assert(scene->bodies != NULL);
+    assert(scene->body_slots != NULL);
+    assert(scene->slots != NULL);
+  }
+  size_t index = scene->slot_count++;
+  body_slot_t *slot = &scene->slots[index];
+  slot->generation = 1;
+  slot->links = NULL;
+  slot->link_count = 0;
+  slot->link_capacity = 0;
+  slot->pair_link_count = 0;
+  return index;
 }
 
 void scene_add_body(scene_t *scene, body_t *body) {
-  list_add(scene->bodies, body);
+  size_t index = scene_claim_slot(scene);
+  body_slot_t *slot = &scene->slots[index];
+  slot->occupied = true;
+  slot->is_static = false;
+  slot->dense_index = scene->body_count;
+  scene->bodies[scene->body_count] = body;
+  scene->body_slots[scene->body_count] = index;
+  scene->body_count++;
+  body_set_handle(body, (body_handle_t){.index = index,
+                                        .generation = slot->generation});
+  tag_index_add(scene->tags, body);
+  query_index_mark_stale(scene->queries);
+}
+
+/**
+ * Records that a force acts on the body at a given position in its bodies
+ * list. Bodies that are not in the scene cannot be indexed, so the force is
+ * marked loose instead.
+ */
+void scene_link_force(scene_t *scene, force_t *force, size_t body_index) {
+  body_t *body = list_get(force->bodies, body_index);
+  body_handle_t handle = body_get_handle(body);
+  if (scene_get_body_by_handle(scene, handle) != body) {
+    force->link_positions[body_index] = NO_LINK;
+    if (!force->loose) {
+      force->loose = true;
+      list_add(scene->loose_forces, force);
+    }
+    return;
+  }
+
+  body_slot_t *slot = &scene->slots[handle.index];
+  if (slot->link_count == slot->link_capacity) {
+    slot->link_capacity =
+        slot->link_capacity == 0 ? INITIAL_SIZE : slot->link_capacity * 2;
+    slot->links =
+        realloc(slot->links, slot->link_capacity * sizeof(force_link_t));
+    assert(slot->links != NULL);
+  }
+  slot->links[slot->link_count] =
+      (force_link_t){.force = force, .body_index = body_index};
+  force->link_positions[body_index] = slot->link_count;
+  slot->link_count++;
+  if (force->pair) {
+    slot->pair_link_count++;
+  }
+}
+
+/**
+ * Removes a force from the link array of one of its bodies by moving the
+ * last link into its place.
+ */
+void scene_unlink_force(scene_t *scene, force_t *force, size_t body_index) {
+  size_t position = force->link_positions[body_index];
+  if (position == NO_LINK) {
+    return;
+  }
+  body_t *body = list_get(force->bodies, body_index);
+  body_slot_t *slot = &scene->slots[body_get_handle(body).index];
+  size_t last = slot->link_count - 1;
+  if (position != last) {
+    force_link_t moved = slot->links[last];
+    slot->links[position] = moved;
+    moved.force->link_positions[moved.body_index] = position;
+  }
+  slot->link_count--;
+  if (force->pair) {
+    slot->pair_link_count--;
+  }
+  force->link_positions[body_index] = NO_LINK;
+}
+
+/**
+ * Detaches a force from all of its bodies and marks it to be freed by the
+ * next scene_compact_forces().
+ */
+void scene_retire_force(scene_t *scene, force_t *force) {
+  if (force->retired) {
+    return;
+  }
+  force->retired = true;
+  scene->has_retired_forces = true;
+  for (size_t i = 0; i < list_size(force->bodies); i++) {
+    scene_unlink_force(scene, force, i);
+  }
+  if (force->loose) {
+    for (size_t i = 0; i < list_size(scene->loose_forces); i++) {
+      if (list_get(scene->loose_forces, i) == force) {
+        list_remove(scene->loose_forces, i);
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * Frees all retired forces, keeping the remaining forces in the order they
+ * were added.
+ */
+void scene_compact_forces(scene_t *scene) {
+  if (!scene->has_retired_forces) {
+    return;
+  }
+  force_array_compact(&scene->forces, true);
+  force_array_compact(&scene->pair_forces, true);
+  scene->has_retired_forces = false;
+}
+
+/**
+ * Frees the body at a dense index by moving the last body into its place
+ * and retiring its slot, so any outstanding handles to it stop resolving.
+ * Every force acting on the body is retired first.
+ */
+void scene_release_body(scene_t *scene, size_t dense_index) {
+  size_t index = scene->body_slots[dense_index];
+  body_slot_t *slot = &scene->slots[index];
+  while (slot->link_count > 0) {
+    scene_retire_force(scene, slot->links[slot->link_count - 1].force);
+  }
+  tag_index_remove(scene->tags, scene->bodies[dense_index]);
+  body_free(scene->bodies[dense_index]);
+  slot->occupied = false;
+  slot->generation = slot->generation == UINT32_MAX ? 1 : slot->generation + 1;
+  slot->next_free = scene->free_slot;
+  scene->free_slot = index;
+
+  size_t last = scene->body_count - 1;
+  if (dense_index != last) {
+    scene->bodies[dense_index] = scene->bodies[last];
+    scene->body_slots[dense_index] = scene->body_slots[last];
+    scene->slots[scene->body_slots[dense_index]].dense_index = dense_index;
+  }
+  scene->body_count--;
 }
 
 void scene_remove_body(scene_t *scene, size_t index) {
@@ -57,15 +468,41 @@ void scene_remove_body(scene_t *scene, size_t index) {
   body_remove(scene_get_body(scene, index));
 }
 
-void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
-                                    void *aux, list_t *bodies,
-                                    free_func_t freer) {
-  force_t *force = malloc(sizeof(force_t));
+/**
+ * Allocates a force and links it to its bodies.
+ */
+force_t *scene_init_force(scene_t *scene, force_creator_t forcer, void *aux,
+                          list_t *bodies, free_func_t freer, bool pair) {
+  force_t *force = pool_alloc(scene_get_force_pool());
   force->forcer = forcer;
   force->aux = aux;
   force->bodies = bodies;
   force->freer = freer;
-  list_add(scene->forces, force);
+  force->link_positions = NULL;
+  force->loose = false;
+  force->retired = false;
+  force->pair = pair;
+  force->sequence = scene->next_sequence++;
+  force->candidate_tick = 0;
+  if (bodies != NULL && list_size(bodies) > 0) {
+    if (list_size(bodies) <= FORCE_INLINE_BODIES) {
+      force->link_positions = force->inline_positions;
+    } else {
+      force->link_positions = malloc(list_size(bodies) * sizeof(size_t));
+      assert(force->link_positions != NULL);
+    }
+    for (size_t i = 0; i < list_size(bodies); i++) {
+      scene_link_force(scene, force, i);
+    }
+  }
+  return force;
+}
+
+void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
+                                    void *aux, list_t *bodies,
+                                    free_func_t freer) {
+  force_array_add(&scene->forces,
+                  scene_init_force(scene, forcer, aux, bodies, freer, false));
 }
 
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
@@ -73,61 +510,357 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
   scene_add_bodies_force_creator(scene, forcer, aux, NULL, freer);
 }
 
+void scene_add_pair_force_creator(scene_t *scene, force_creator_t forcer,
+                                  void *aux, body_t *body1, body_t *body2,
+                                  free_func_t freer) {
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, body1);
+  list_add(bodies, body2);
+  force_array_add(&scene->pair_forces,
+                  scene_init_force(scene, forcer, aux, bodies, freer, true));
+}
+
+void scene_add_layer_force_creator(scene_t *scene, size_t layer1,
+                                   size_t layer2, layer_force_creator_t forcer,
+                                   void *aux, free_func_t freer) {
+  layer_table_add_force(scene->layers, layer1, layer2, forcer, aux, freer);
+}
+
+/**
+ * Whether the broadphase needs to report pairs involving a body.
+ */
+bool scene_body_in_broadphase(scene_t *scene, size_t index) {
+  return scene->slots[scene->body_slots[index]].pair_link_count > 0 ||
+         layer_table_has_layer(scene->layers,
+                               body_get_collision_layer(scene->bodies[index]));
+}
+
+/**
+ * Records a pair of bodies whose layers some layer force creator acts on,
+ * and visits it in the pair cache.
+ */
+void scene_add_layer_pair(scene_t *scene, body_t *body1, body_t *body2) {
+  if (layer_table_pairs_bodies(scene->layers, body1, body2)) {
+    scene_get_pair(scene, body1, body2);
+    layer_table_add_pair(scene->layers, body1, body2);
+  }
+}
+
+/**
+ * Called by the broadphase with the dense indices of two bodies whose
+ * bounding boxes overlap. Marks the pair forces between them as candidates,
+ * searching whichever body has fewer forces attached, and records the pair
+ * for the layer force creators.
+ */
+void scene_add_candidate_pair(size_t index1, size_t index2, scene_t *scene) {
+  scene_add_layer_pair(scene, scene->bodies[index1], scene->bodies[index2]);
+  body_slot_t *slot1 = &scene->slots[scene->body_slots[index1]];
+  body_slot_t *slot2 = &scene->slots[scene->body_slots[index2]];
+  body_slot_t *slot = slot1;
+  body_t *other = scene->bodies[index2];
+  if (slot2->pair_link_count < slot1->pair_link_count) {
+    slot = slot2;
+    other = scene->bodies[index1];
+  }
+  for (size_t i = 0; i < slot->link_count; i++) {
+    force_link_t link = slot->links[i];
+    force_t *force = link.force;
+    if (!force->pair || force->candidate_tick == scene->tick ||
+        list_get(force->bodies, 1 - link.body_index) != other) {
+      continue;
+    }
+    force->candidate_tick = scene->tick;
+    force_array_add(&scene->candidates, force);
+  }
+}
+
+/**
+ * Records a pair that was touching last tick but that the broadphase has
+ * not reported this tick, so the layer force creators see it separate.
+ * Called while iterating over the pair cache, so the entry is brought up to
+ * this tick in place rather than visited.
+ */
+void scene_keep_touching_pair(pair_entry_t *entry, scene_t *scene) {
+  if (entry->tick + 1 != scene->tick || !entry->touching) {
+    return;
+  }
+  body_t *body1 = scene_get_body_by_handle(scene, entry->handle1);
+  body_t *body2 = scene_get_body_by_handle(scene, entry->handle2);
+  if (body1 != NULL && body2 != NULL && !body_is_removed(body1) &&
+      !body_is_removed(body2) &&
+      layer_table_pairs_bodies(scene->layers, body1, body2)) {
+    pair_cache_touch(scene->pairs, entry, (size_t)scene->tick);
+    layer_table_add_pair(scene->layers, body1, body2);
+  }
+}
+
+int compare_force_sequence(const void *force1, const void *force2) {
+  size_t sequence1 = (*(force_t *const *)force1)->sequence;
+  size_t sequence2 = (*(force_t *const *)force2)->sequence;
+  return (sequence1 > sequence2) - (sequence1 < sequence2);
+}
+
+/**
+ * Called by the query index with the slot index of a static body the static
+ * tree reports. The slot may have been reused since the tree was built, if
+ * the static body was removed.
+ */
+body_t *scene_get_static_body(size_t slot_index, scene_t *scene) {
+  body_slot_t *slot = &scene->slots[slot_index];
+  if (!slot->occupied || !slot->is_static) {
+    return NULL;
+  }
+  return scene->bodies[slot->dense_index];
+}
+
+void scene_build_static_tree(scene_t *scene) {
+  if (scene->static_tree != NULL) {
+    bvh_free(scene->static_tree);
+  }
+  scene->static_tree = bvh_init();
+  for (size_t i = 0; i < scene->body_count; i++) {
+    body_t *body = scene->bodies[i];
+    if (body_get_mass(body) == INFINITY) {
+      size_t index = scene->body_slots[i];
+      scene->slots[index].is_static = true;
+      bvh_insert(scene->static_tree, index, body_get_aabb(body));
+    }
+  }
+  bvh_build(scene->static_tree);
+  query_index_set_statics(scene->queries, scene->static_tree,
+                          (static_lookup_t)scene_get_static_body, scene);
+  query_index_mark_stale(scene->queries);
+}
+
+/**
+ * The body being looked up in the static tree.
+ */
+typedef struct static_query {
+  scene_t *scene;
+  size_t index;
+} static_query_t;
+
+/**
+ * Called by the static tree with the slot index of a static body whose
+ * bounding box overlaps the queried body's. The slot may have been reused
+ * since the tree was built, if the static body was removed.
+ */
+void scene_add_static_candidate(size_t slot_index, static_query_t *query) {
+  scene_t *scene = query->scene;
+  body_slot_t *slot = &scene->slots[slot_index];
+  if (slot->occupied && slot->is_static &&
+      scene_body_in_broadphase(scene, slot->dense_index)) {
+    scene_add_candidate_pair(query->index, slot->dense_index, scene);
+  }
+}
+
+/**
+ * Called by the sweep and prune broadphase, which identifies bodies by their
+ * slot index since their dense indices change as bodies are removed.
+ */
+void scene_add_swept_pair(size_t slot1, size_t slot2, scene_t *scene) {
+  scene_add_candidate_pair(scene->slots[slot1].dense_index,
+                           scene->slots[slot2].dense_index, scene);
+}
+
+/**
+ * Runs the broadphase over every body that a pair or layer force creator
+ * acts on, collecting this tick's candidate pair forces and layer pairs.
+ * Moving bodies are paired with each other by the scene's broadphase, and
+ * with static bodies by the static tree.
+ */
+void scene_find_candidates(scene_t *scene) {
+  if (scene->grid != NULL) {
+    spatial_grid_clear(scene->grid);
+  }
+  scene->candidates.count = 0;
+  layer_table_clear_pairs(scene->layers);
+  for (size_t i = 0; i < scene->body_count; i++) {
+    if (!scene_body_in_broadphase(scene, i) ||
+        scene->slots[scene->body_slots[i]].is_static) {
+      continue;
+    }
+    aabb_t box = body_get_swept_aabb(scene->bodies[i]);
+    if (scene->broadphase == BROADPHASE_GRID) {
+      spatial_grid_insert(scene->grid, i, box);
+    } else {
+      sweep_and_prune_insert(scene->sweep, scene->body_slots[i], box);
+    }
+    if (scene->static_tree != NULL) {
+      static_query_t query = {.scene = scene, .index = i};
+      bvh_query(scene->static_tree, box,
+                (bvh_hit_handler_t)scene_add_static_candidate, &query);
+    }
+  }
+  if (scene->broadphase == BROADPHASE_GRID) {
+    spatial_grid_find_pairs(
+        scene->grid, (grid_pair_handler_t)scene_add_candidate_pair, scene);
+  } else {
+    sweep_and_prune_find_pairs(
+        scene->sweep, (sweep_pair_handler_t)scene_add_swept_pair, scene);
+  }
+  pair_cache_for_each(scene->pairs, (pair_visitor_t)scene_keep_touching_pair,
+                      scene);
+}
+
+/**
+ * Runs the pair forces that need to run this tick: those whose bodies the
+ * grid reports as overlapping, those that were candidates last tick (so they
+ * can see their bodies separate), and those with a body outside the scene.
+ */
+void scene_run_pair_forces(scene_t *scene) {
+  force_array_t *run = &scene->pair_run;
+  run->count = 0;
+  for (size_t i = 0; i < scene->candidates.count; i++) {
+    force_array_add(run, scene->candidates.forces[i]);
+  }
+  for (size_t i = 0; i < scene->last_candidates.count; i++) {
+    force_t *force = scene->last_candidates.forces[i];
+    if (force->candidate_tick != scene->tick) {
+      force_array_add(run, force);
+    }
+  }
+  for (size_t i = 0; i < list_size(scene->loose_forces); i++) {
+    force_t *force = list_get(scene->loose_forces, i);
+    if (force->pair && force->candidate_tick != scene->tick) {
+      force_array_add(run, force);
+    }
+  }
+  if (run->count > 0) {
+    qsort(run->forces, run->count, sizeof(force_t *), compare_force_sequence);
+  }
+  for (size_t i = 0; i < run->count; i++) {
+    run->forces[i]->forcer(run->forces[i]->aux);
+  }
+}
+
+void scene_queue_event(scene_t *scene, event_handler_t handler, body_t *body1,
+                       body_t *body2, vector_t axis, void *aux) {
+  event_queue_add(scene->events, handler, body1, body2, axis, aux);
+}
+
+void scene_queue_contact(scene_t *scene, body_t *body1, body_t *body2,
+                         const contact_manifold_t *manifold) {
+  contact_queue_add(scene->contacts, body1, body2, manifold);
+}
+
 void scene_tick(scene_t *scene, double dt) {
-  for (size_t i = 0; i < list_size(scene->forces); i++) {
-    force_t *force = list_get(scene->forces, i);
+  scene->tick++;
+  for (size_t i = 0; i < scene->forces.count; i++) {
+    force_t *force = scene->forces.forces[i];
     force->forcer(force->aux);
   }
+  scene_find_candidates(scene);
+  continuous_sweep_run(scene->continuous,
+                       layer_table_get_pairs(scene->layers));
+  layer_batch_run(scene->batch, layer_table_get_pairs(scene->layers),
+                  scene->pairs, (size_t)scene->tick);
+  scene_run_pair_forces(scene);
+  layer_table_run(scene->layers);
+  contact_queue_resolve(scene->contacts);
+  pair_cache_remove_stale(scene->pairs, (size_t)scene->tick);
+  event_queue_dispatch(scene->events);
 
-  for (size_t i = 0; i < list_size(scene->forces); i++) {
-    force_t *force = list_get(scene->forces, i);
-    if (force->bodies != NULL) {
-      for (size_t j = 0; j < list_size(force->bodies); j++) {
-        body_t *body_to_check = list_get(force->bodies, j);
-        if (body_is_removed(body_to_check)) {
-          list_remove(scene->forces, i);
-          free_force(force);
-          i--;
-          break;
-        }
+  for (size_t i = list_size(scene->loose_forces); i > 0; i--) {
+    force_t *force = list_get(scene->loose_forces, i - 1);
+    for (size_t j = 0; j < list_size(force->bodies); j++) {
+      if (body_is_removed(list_get(force->bodies, j))) {
+        scene_retire_force(scene, force);
+        break;
       }
     }
   }
 
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *body = list_get(scene->bodies, i);
-    if (body_is_removed(body)) {
-      list_remove(scene->bodies, i);
-      body_free(body);
-      i--;
+  size_t i = 0;
+  while (i < scene->body_count) {
+    if (body_is_removed(scene->bodies[i])) {
+      scene_release_body(scene, i);
+    } else {
+      i++;
     }
   }
+  // Remember this tick's candidates, minus any that were just retired
+  force_array_compact(&scene->candidates, false);
+  force_array_t last_candidates = scene->last_candidates;
+  scene->last_candidates = scene->candidates;
+  scene->candidates = last_candidates;
+  scene_compact_forces(scene);
 
   for (size_t i = 0; i < scene_bodies(scene); i++) {
     body_tick(scene_get_body(scene, i), dt);
   }
+  query_index_mark_stale(scene->queries);
 }
 
-list_t *scene_bodies_with_comp_info(scene_t *scene, computer_info_t info) {
-  list_t *bodies = list_init(30, NULL);
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *body = scene_get_body(scene, i);
-    computer_info_t *b_info = body_get_info(body);
-    if (*b_info == info) {
-      list_add(bodies, scene_get_body(scene, i));
-    }
-  }
-  return bodies;
+body_view_t scene_bodies_with_tag(scene_t *scene, body_tag_t tag) {
+  return tag_index_get(scene->tags, tag);
 }
 
-list_t *scene_bodies_with_bullet_info(scene_t *scene, bullet_info_t info) {
-  list_t *bodies = list_init(30, NULL);
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *body = scene_get_body(scene, i);
-    bullet_info_t *b_info = body_get_info(body);
-    if (*b_info == info) {
-      list_add(bodies, scene_get_body(scene, i));
+body_tag_t comp_info_tag(computer_info_t info) {
+  return (body_tag_t){.kind = COMPUTER_TAG, .subtype = (uint8_t)info};
+}
+
+body_tag_t bullet_info_tag(bullet_info_t info) {
+  return (body_tag_t){.kind = BULLET_TAG, .subtype = (uint8_t)info};
+}
+
+body_view_t scene_bodies_with_comp_info(scene_t *scene, computer_info_t info) {
+  return scene_bodies_with_tag(scene, comp_info_tag(info));
+}
+
+body_view_t scene_bodies_with_bullet_info(scene_t *scene, bullet_info_t info) {
+  return scene_bodies_with_tag(scene, bullet_info_tag(info));
+}
+
+/**
+ * Refills the query index with the current box of every body that is not in
+ * the static tree, if bodies have moved or been added since it was filled.
+ */
+void scene_refresh_query_index(scene_t *scene) {
+  if (!query_index_is_stale(scene->queries)) {
+    return;
+  }
+  query_index_clear(scene->queries);
+  for (size_t i = 0; i < scene->body_count; i++) {
+    if (!scene->slots[scene->body_slots[i]].is_static) {
+      query_index_insert(scene->queries, scene->bodies[i]);
     }
   }
-  return bodies;
-}
\ No newline at end of file
+  query_index_commit(scene->queries);
+}
+
+bool scene_segment_query(scene_t *scene, vector_t start, vector_t end,
+                         uint32_t layers, ray_hit_t *hit) {
+  scene_refresh_query_index(scene);
+  return query_index_segment(scene->queries, start, end, layers, hit);
+}
+
+bool scene_raycast(scene_t *scene, vector_t origin, vector_t direction,
+                   double max_distance, uint32_t layers, ray_hit_t *hit) {
+  double length = sqrt(vec_dot(direction, direction));
+  assert(length > 0);
+  vector_t end =
+      vec_add(origin, vec_multiply(max_distance / length, direction));
+  return scene_segment_query(scene, origin, end, layers, hit);
+}
+
+/**
+ * Bodies the visitor removes stay in the scene until the next tick, so the
+ * query index does not change under the query.
+ */
+size_t scene_query_radius(scene_t *scene, vector_t center, double radius,
+                          uint32_t layers, body_visitor_t visitor, void *aux) {
+  vector_t extent = {radius, radius};
+  aabb_t box = {.min = vec_subtract(center, extent),
+                .max = vec_add(center, extent)};
+  scene_refresh_query_index(scene);
+  return query_index_region(scene->queries, box, center, radius, layers,
+                            visitor, aux);
+}
+
+size_t scene_query_aabb(scene_t *scene, aabb_t box, uint32_t layers,
+                        body_visitor_t visitor, void *aux) {
+  scene_refresh_query_index(scene);
+  return query_index_region(scene->queries, box, VEC_ZERO, 0, layers,
+                            visitor, aux);
+}
@@ -1,4 +1,5 @@
 #include "sdl_wrapper.h"
+#include "arena.h"
 #include "character.h"
 #include "computer.h"
 #include "info_types.h"
@@ -239,9 +240,9 @@ void sdl_clear(void) {
   SDL_RenderClear(renderer);
 }
 
-void sdl_draw_polygon(list_t *points, rgb_color_t color) {
+void sdl_draw_polygon(polygon_view_t points, rgb_color_t color) {
   // Check parameters
-  size_t n = list_size(points);
+  size_t n = points.size;
   assert(n >= 3);
   assert(0 <= color.r && color.r <= 1);
   assert(0 <= color.g && color.g <= 1);
@@ -251,13 +252,10 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   vector_t window_center = get_window_center();
 
   // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
+  int16_t *x_points = arena_alloc(frame_arena(), sizeof(*x_points) * n),
+          *y_points = arena_alloc(frame_arena(), sizeof(*y_points) * n);
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
+    vector_t pixel = get_window_position(points.vertices[i], window_center);
     x_points[i] = pixel.x;
     y_points[i] = pixel.y;
   }
@@ -265,8 +263,20 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   // Draw polygon with the given color
   filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
                     color.g * 255, color.b * 255, color.a * 255);
-  free(x_points);
-  free(y_points);
+}
+
+void sdl_draw_circle(vector_t center, double radius, rgb_color_t color) {
+  assert(radius > 0);
+  assert(0 <= color.r && color.r <= 1);
+  assert(0 <= color.g && color.g <= 1);
+  assert(0 <= color.b && color.b <= 1);
+  assert(0 <= color.a && color.a <= 1);
+
+  vector_t window_center = get_window_center();
+  vector_t pixel = get_window_position(center, window_center);
+  double pixel_radius = round(radius * get_scene_scale(window_center));
+  filledCircleRGBA(renderer, pixel.x, pixel.y, pixel_radius, color.r * 255,
+                   color.g * 255, color.b * 255, color.a * 255);
 }
 
 void sdl_show(void) {
@@ -312,7 +322,8 @@ SDL_print_object_t *
 SDL_print_object_init(print_handler_t print_handler, void *message,
                       double font_size, char *font_file, SDL_Rect rectangle_dms,
                       SDL_Color color, free_func_t message_freer) {
-  SDL_print_object_t *output = malloc(sizeof(SDL_print_object_t));
+  SDL_print_object_t *output =
+      arena_alloc(frame_arena(), sizeof(SDL_print_object_t));
   output->print_handler = print_handler;
   output->message = message;
   output->font_size = font_size;
@@ -327,7 +338,6 @@ void SDL_print_object_free(SDL_print_object_t *print_object) {
   if (print_object->message_freer != NULL) {
     print_object->message_freer(print_object->message);
   }
-  free(print_object);
 }
 
 void sdl_render_scene(scene_t *scene, list_t *print_objects,
@@ -335,14 +345,18 @@ void sdl_render_scene(scene_t *scene, list_t *print_objects,
   sdl_clear();
   // Texture list is to make sure all the textures are destroyed.
   list_t *texture_list =
-      list_init(list_size(print_objects), (free_func_t)SDL_DestroyTexture);
+      list_init_in_arena(frame_arena(), list_size(print_objects),
+                         (free_func_t)SDL_DestroyTexture);
 
   size_t body_count = scene_bodies(scene);
   for (size_t i = 0; i < body_count; i++) {
     body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    sdl_draw_polygon(shape, body_get_color(body));
-    list_free(shape);
+    if (body_get_shape_kind(body) == SHAPE_CIRCLE) {
+      sdl_draw_circle(body_get_centroid(body), body_get_radius(body),
+                      body_get_color(body));
+    } else {
+      sdl_draw_polygon(body_get_shape_view(body), body_get_color(body));
+    }
   }
   // Renders Text
   if (print_objects != NULL) {
@@ -356,8 +370,8 @@ void sdl_render_scene(scene_t *scene, list_t *print_objects,
     }
   }
   // Renders Sprites
-  list_t *img_textures =
-      list_init(list_size(print_objects), (free_func_t)list_free);
+  list_t *img_textures = list_init_in_arena(
+      frame_arena(), list_size(print_objects), (free_func_t)list_free);
   if (start) {
     list_add(img_textures, show_image(NULL, 1, 1, NULL, NULL, start));
   }
@@ -399,7 +413,8 @@ list_t *show_image(body_t *body, style_info_t style, weapon_info_t weapon_type,
                    character_t *character, computer_t *comp, bool start) {
   int w;
   int h;
-  list_t *textures = list_init(5, (free_func_t)SDL_DestroyTexture);
+  list_t *textures =
+      list_init_in_arena(frame_arena(), 5, (free_func_t)SDL_DestroyTexture);
   if (!start) {
     SDL_Texture *img = NULL;
     double angle = 0;
@@ -438,7 +453,7 @@ list_t *show_image(body_t *body, style_info_t style, weapon_info_t weapon_type,
     location.w = w / SPRITE_SIZE_FACTOR;
     location.h = h / SPRITE_SIZE_FACTOR;
     // Character Location
-    if (*((computer_info_t *)(body_get_info(body))) == CHARACTER) {
+    if (body_tag_equals(body_get_tag(body), comp_info_tag(CHARACTER))) {
       angle = (get_rotation_body(body) - (M_PI / 2)) * (-180.0 / M_PI);
       location.x = (WINDOW_WIDTH / 2) - USER_SIZE;
       location.y = (WINDOW_HEIGHT / 2) - USER_SIZE;
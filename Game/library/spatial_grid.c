@@ -0,0 +1,420 @@
+#include "spatial_grid.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct grid_entry {
+  size_t id;
+  aabb_t box;
+  long min_x;
+  long min_y;
+  bool oversized;
+  size_t query;
+} grid_entry_t;
+
+/**
+ * An occupied cell. Its members form a linked list through
+ * grid->members, starting at first_member.
+ */
+typedef struct grid_cell {
+  long x;
+  long y;
+  size_t first_member;
+} grid_cell_t;
+
+typedef struct grid_member {
+  size_t entry;
+  size_t next;
+} grid_member_t;
+
+/**
+ * query is the last query that visited an entry, counted by query_count, so
+ * that queries report boxes spanning several cells once.
+ */
+typedef struct spatial_grid {
+  double cell_size;
+  grid_entry_t *entries;
+  size_t entry_count;
+  size_t entry_capacity;
+  grid_cell_t *cells;
+  size_t cell_count;
+  size_t cell_capacity;
+  grid_member_t *members;
+  size_t member_count;
+  size_t member_capacity;
+  size_t *buckets;
+  size_t bucket_count;
+  size_t *oversized;
+  size_t oversized_count;
+  size_t oversized_capacity;
+  size_t query_count;
+} spatial_grid_t;
+
+const size_t GRID_INITIAL_SIZE = 64;
+const size_t GRID_EMPTY = SIZE_MAX;
+const long GRID_MAX_CELLS_PER_BOX = 64;
+
+/**
+ * Makes sure an array has room for one more element.
+ */
+void *grid_reserve(void *array, size_t count, size_t *capacity,
+                   size_t element_size) {
+  if (count < *capacity) {
+    return array;
+  }
+  *capacity = *capacity == 0 ? GRID_INITIAL_SIZE : *capacity * 2;
+  array = realloc(array, *capacity * element_size);
+  assert(array != NULL);
+  return array;
+}
+
+spatial_grid_t *spatial_grid_init(double cell_size) {
+  assert(cell_size > 0);
+  spatial_grid_t *grid = malloc(sizeof(spatial_grid_t));
+  assert(grid != NULL);
+  grid->cell_size = cell_size;
+  grid->entries = NULL;
+  grid->entry_count = 0;
+  grid->entry_capacity = 0;
+  grid->cells = NULL;
+  grid->cell_count = 0;
+  grid->cell_capacity = 0;
+  grid->members = NULL;
+  grid->member_count = 0;
+  grid->member_capacity = 0;
+  grid->bucket_count = GRID_INITIAL_SIZE;
+  grid->buckets = malloc(grid->bucket_count * sizeof(size_t));
+  assert(grid->buckets != NULL);
+  memset(grid->buckets, 0xff, grid->bucket_count * sizeof(size_t));
+  grid->oversized = NULL;
+  grid->oversized_count = 0;
+  grid->oversized_capacity = 0;
+  grid->query_count = 0;
+  return grid;
+}
+
+void spatial_grid_free(spatial_grid_t *grid) {
+  free(grid->entries);
+  free(grid->cells);
+  free(grid->members);
+  free(grid->buckets);
+  free(grid->oversized);
+  free(grid);
+}
+
+void spatial_grid_clear(spatial_grid_t *grid) {
+  grid->entry_count = 0;
+  grid->cell_count = 0;
+  grid->member_count = 0;
+  grid->oversized_count = 0;
+  memset(grid->buckets, 0xff, grid->bucket_count * sizeof(size_t));
+}
+
+size_t grid_hash(long x, long y) {
+  return (size_t)((unsigned long)x * 73856093UL ^
+                  (unsigned long)y * 19349663UL);
+}
+
+/**
+ * Doubles the bucket table and reinserts every occupied cell.
+ */
+void grid_rehash(spatial_grid_t *grid) {
+  grid->bucket_count *= 2;
+  grid->buckets = realloc(grid->buckets, grid->bucket_count * sizeof(size_t));
+  assert(grid->buckets != NULL);
+  memset(grid->buckets, 0xff, grid->bucket_count * sizeof(size_t));
+  size_t mask = grid->bucket_count - 1;
+  for (size_t i = 0; i < grid->cell_count; i++) {
+    size_t bucket = grid_hash(grid->cells[i].x, grid->cells[i].y) & mask;
+    while (grid->buckets[bucket] != GRID_EMPTY) {
+      bucket = (bucket + 1) & mask;
+    }
+    grid->buckets[bucket] = i;
+  }
+}
+
+/**
+ * Finds the cell at the given coordinates, or returns NULL if it is empty.
+ */
+grid_cell_t *grid_find_cell(spatial_grid_t *grid, long x, long y) {
+  size_t mask = grid->bucket_count - 1;
+  size_t bucket = grid_hash(x, y) & mask;
+  while (grid->buckets[bucket] != GRID_EMPTY) {
+    grid_cell_t *cell = &grid->cells[grid->buckets[bucket]];
+    if (cell->x == x && cell->y == y) {
+      return cell;
+    }
+    bucket = (bucket + 1) & mask;
+  }
+  return NULL;
+}
+
+/**
+ * Finds the cell at the given coordinates, creating it if it is empty.
+ */
+grid_cell_t *grid_get_cell(spatial_grid_t *grid, long x, long y) {
+  size_t mask = grid->bucket_count - 1;
+  size_t bucket = grid_hash(x, y) & mask;
+  while (grid->buckets[bucket] != GRID_EMPTY) {
+    grid_cell_t *cell = &grid->cells[grid->buckets[bucket]];
+    if (cell->x == x && cell->y == y) {
+      return cell;
+    }
+    bucket = (bucket + 1) & mask;
+  }
+
+  grid->cells = grid_reserve(grid->cells, grid->cell_count,
+                             &grid->cell_capacity, sizeof(grid_cell_t));
+  size_t index = grid->cell_count++;
+  grid->cells[index] =
+      (grid_cell_t){.x = x, .y = y, .first_member = GRID_EMPTY};
+  grid->buckets[bucket] = index;
+  // Keep the table at most half full so probes stay short
+  if (grid->cell_count * 2 > grid->bucket_count) {
+    grid_rehash(grid);
+  }
+  return &grid->cells[index];
+}
+
+void spatial_grid_insert(spatial_grid_t *grid, size_t id, aabb_t box) {
+  long min_x = (long)floor(box.min.x / grid->cell_size);
+  long min_y = (long)floor(box.min.y / grid->cell_size);
+  long max_x = (long)floor(box.max.x / grid->cell_size);
+  long max_y = (long)floor(box.max.y / grid->cell_size);
+
+  grid->entries = grid_reserve(grid->entries, grid->entry_count,
+                               &grid->entry_capacity, sizeof(grid_entry_t));
+  size_t entry = grid->entry_count++;
+  grid->entries[entry] =
+      (grid_entry_t){.id = id,
+                     .box = box,
+                     .min_x = min_x,
+                     .min_y = min_y,
+                     .oversized = false,
+                     .query = 0};
+
+  if ((max_x - min_x + 1) * (max_y - min_y + 1) > GRID_MAX_CELLS_PER_BOX) {
+    grid->entries[entry].oversized = true;
+    grid->oversized =
+        grid_reserve(grid->oversized, grid->oversized_count,
+                     &grid->oversized_capacity, sizeof(size_t));
+    grid->oversized[grid->oversized_count++] = entry;
+    return;
+  }
+  for (long x = min_x; x <= max_x; x++) {
+    for (long y = min_y; y <= max_y; y++) {
+      grid_cell_t *cell = grid_get_cell(grid, x, y);
+      grid->members =
+          grid_reserve(grid->members, grid->member_count,
+                       &grid->member_capacity, sizeof(grid_member_t));
+      grid->members[grid->member_count] =
+          (grid_member_t){.entry = entry, .next = cell->first_member};
+      cell->first_member = grid->member_count++;
+    }
+  }
+}
+
+/**
+ * Two boxes that share several cells are only reported from the cell holding
+ * the lower-left corner of their intersection.
+ */
+bool grid_owns_pair(grid_cell_t *cell, grid_entry_t *entry1,
+                    grid_entry_t *entry2) {
+  long x = entry1->min_x > entry2->min_x ? entry1->min_x : entry2->min_x;
+  long y = entry1->min_y > entry2->min_y ? entry1->min_y : entry2->min_y;
+  return cell->x == x && cell->y == y;
+}
+
+void spatial_grid_find_pairs(spatial_grid_t *grid, grid_pair_handler_t handler,
+                             void *aux) {
+  for (size_t c = 0; c < grid->cell_count; c++) {
+    grid_cell_t *cell = &grid->cells[c];
+    for (size_t i = cell->first_member; i != GRID_EMPTY;
+         i = grid->members[i].next) {
+      grid_entry_t *entry1 = &grid->entries[grid->members[i].entry];
+      for (size_t j = grid->members[i].next; j != GRID_EMPTY;
+           j = grid->members[j].next) {
+        grid_entry_t *entry2 = &grid->entries[grid->members[j].entry];
+        if (aabb_overlaps(entry1->box, entry2->box) &&
+            grid_owns_pair(cell, entry1, entry2)) {
+          handler(entry1->id, entry2->id, aux);
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < grid->oversized_count; i++) {
+    size_t oversized = grid->oversized[i];
+    grid_entry_t *entry1 = &grid->entries[oversized];
+    for (size_t j = 0; j < grid->entry_count; j++) {
+      grid_entry_t *entry2 = &grid->entries[j];
+      // Pairs of oversized boxes are reported by the earlier one only
+      if (entry2->oversized && j <= oversized) {
+        continue;
+      }
+      if (aabb_overlaps(entry1->box, entry2->box)) {
+        handler(entry1->id, entry2->id, aux);
+      }
+    }
+  }
+}
+
+/**
+ * Reports an entry to a query if the query has not visited it yet and its
+ * box overlaps the query's.
+ */
+void grid_visit_entry(spatial_grid_t *grid, size_t index, aabb_t box,
+                      grid_hit_handler_t handler, void *aux) {
+  grid_entry_t *entry = &grid->entries[index];
+  if (entry->query == grid->query_count) {
+    return;
+  }
+  entry->query = grid->query_count;
+  if (aabb_overlaps(entry->box, box)) {
+    handler(entry->id, aux);
+  }
+}
+
+void grid_visit_cell(spatial_grid_t *grid, grid_cell_t *cell, aabb_t box,
+                     grid_hit_handler_t handler, void *aux) {
+  for (size_t i = cell->first_member; i != GRID_EMPTY;
+       i = grid->members[i].next) {
+    grid_visit_entry(grid, grid->members[i].entry, box, handler, aux);
+  }
+}
+
+/**
+ * Boxes covering more cells than the grid has occupied are answered by
+ * walking the occupied cells instead of every cell under the box.
+ */
+void spatial_grid_query(spatial_grid_t *grid, aabb_t box,
+                        grid_hit_handler_t handler, void *aux) {
+  grid->query_count++;
+  long min_x = (long)floor(box.min.x / grid->cell_size);
+  long min_y = (long)floor(box.min.y / grid->cell_size);
+  long max_x = (long)floor(box.max.x / grid->cell_size);
+  long max_y = (long)floor(box.max.y / grid->cell_size);
+  long cell_count = (long)grid->cell_count;
+  long width = max_x - min_x + 1;
+  long height = max_y - min_y + 1;
+  if (width > cell_count || height > cell_count ||
+      width * height > cell_count) {
+    for (size_t c = 0; c < grid->cell_count; c++) {
+      grid_cell_t *cell = &grid->cells[c];
+      if (cell->x >= min_x && cell->x <= max_x && cell->y >= min_y &&
+          cell->y <= max_y) {
+        grid_visit_cell(grid, cell, box, handler, aux);
+      }
+    }
+  } else {
+    for (long x = min_x; x <= max_x; x++) {
+      for (long y = min_y; y <= max_y; y++) {
+        grid_cell_t *cell = grid_find_cell(grid, x, y);
+        if (cell != NULL) {
+          grid_visit_cell(grid, cell, box, handler, aux);
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < grid->oversized_count; i++) {
+    grid_visit_entry(grid, grid->oversized[i], box, handler, aux);
+  }
+}
+
+/**
+ * Reports an entry to a segment query if the query has not visited it yet
+ * and the segment enters its box within the query's reach.
+ * Returns the query's new reach.
+ */
+double grid_visit_segment_entry(spatial_grid_t *grid, size_t index,
+                                vector_t start, vector_t delta, double reach,
+                                grid_segment_handler_t handler, void *aux) {
+  grid_entry_t *entry = &grid->entries[index];
+  if (entry->query == grid->query_count) {
+    return reach;
+  }
+  entry->query = grid->query_count;
+  if (aabb_segment_entry(entry->box, start, delta, reach) == INFINITY) {
+    return reach;
+  }
+  return fmin(reach, handler(entry->id, reach, aux));
+}
+
+/**
+ * Finds how far along a segment, from its start, it first crosses a cell
+ * boundary along one axis, and how far it goes between boundaries.
+ * The segment covers delta along the axis, starting in the cell whose lower
+ * boundary is at cell_start.
+ */
+void grid_segment_steps(double start, double delta, double cell_start,
+                        double cell_size, double *next, double *step) {
+  if (delta > 0) {
+    *next = (cell_start + cell_size - start) / delta;
+    *step = cell_size / delta;
+  } else if (delta < 0) {
+    *next = (cell_start - start) / delta;
+    *step = -cell_size / delta;
+  } else {
+    *next = INFINITY;
+    *step = INFINITY;
+  }
+}
+
+/**
+ * Walks the cells the segment crosses in order, as long as the segment
+ * enters them within the reach. A segment crossing more cells than the grid
+ * has boxes tests every box instead.
+ */
+void spatial_grid_query_segment(spatial_grid_t *grid, vector_t start,
+                                vector_t end, grid_segment_handler_t handler,
+                                void *aux) {
+  grid->query_count++;
+  vector_t delta = vec_subtract(end, start);
+  double reach = 1;
+  long x = (long)floor(start.x / grid->cell_size);
+  long y = (long)floor(start.y / grid->cell_size);
+  long end_x = (long)floor(end.x / grid->cell_size);
+  long end_y = (long)floor(end.y / grid->cell_size);
+  if ((size_t)(labs(end_x - x) + labs(end_y - y)) >= grid->entry_count) {
+    for (size_t i = 0; i < grid->entry_count; i++) {
+      reach = grid_visit_segment_entry(grid, i, start, delta, reach, handler,
+                                       aux);
+    }
+    return;
+  }
+  for (size_t i = 0; i < grid->oversized_count; i++) {
+    reach = grid_visit_segment_entry(grid, grid->oversized[i], start, delta,
+                                     reach, handler, aux);
+  }
+
+  double next_x, step_x, next_y, step_y;
+  grid_segment_steps(start.x, delta.x, x * grid->cell_size, grid->cell_size,
+                     &next_x, &step_x);
+  grid_segment_steps(start.y, delta.y, y * grid->cell_size, grid->cell_size,
+                     &next_y, &step_y);
+  double entry = 0;
+  while (entry <= reach) {
+    grid_cell_t *cell = grid_find_cell(grid, x, y);
+    if (cell != NULL) {
+      for (size_t i = cell->first_member; i != GRID_EMPTY;
+           i = grid->members[i].next) {
+        reach = grid_visit_segment_entry(grid, grid->members[i].entry, start,
+                                         delta, reach, handler, aux);
+      }
+    }
+    if (x == end_x && y == end_y) {
+      break;
+    }
+    if (next_x < next_y) {
+      entry = next_x;
+      next_x += step_x;
+      x += delta.x > 0 ? 1 : -1;
+    } else {
+      entry = next_y;
+      next_y += step_y;
+      y += delta.y > 0 ? 1 : -1;
+    }
+  }
+}
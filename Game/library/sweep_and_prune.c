@@ -0,0 +1,269 @@
+#include "sweep_and_prune.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct sweep_entry {
+  size_t id;
+  aabb_t box;
+  bool inserted;
+  bool wide;
+} sweep_entry_t;
+
+/**
+ * entries are sorted by the left edge of their boxes as of the last round,
+ * and positions[id] is the index of the entry with that id, or SWEEP_ABSENT.
+ * Boxes more than SWEEP_WIDE_FACTOR times as wide as the average are wide,
+ * and their positions are listed in wide; max_width is the width of the
+ * widest of the rest. Queries look for narrow boxes by their left edges,
+ * and test the few wide ones separately, so that one long box does not
+ * widen the window every query searches.
+ */
+typedef struct sweep_and_prune {
+  sweep_entry_t *entries;
+  size_t entry_count;
+  size_t entry_capacity;
+  size_t *positions;
+  size_t position_capacity;
+  size_t *wide;
+  size_t wide_count;
+  size_t wide_capacity;
+  double max_width;
+} sweep_and_prune_t;
+
+const size_t SWEEP_INITIAL_SIZE = 64;
+const size_t SWEEP_ABSENT = SIZE_MAX;
+const double SWEEP_WIDE_FACTOR = 4;
+
+sweep_and_prune_t *sweep_and_prune_init(void) {
+  sweep_and_prune_t *sap = malloc(sizeof(sweep_and_prune_t));
+  assert(sap != NULL);
+  sap->entries = NULL;
+  sap->entry_count = 0;
+  sap->entry_capacity = 0;
+  sap->positions = NULL;
+  sap->position_capacity = 0;
+  sap->wide = NULL;
+  sap->wide_count = 0;
+  sap->wide_capacity = 0;
+  sap->max_width = 0;
+  return sap;
+}
+
+void sweep_and_prune_free(sweep_and_prune_t *sap) {
+  free(sap->entries);
+  free(sap->positions);
+  free(sap->wide);
+  free(sap);
+}
+
+/**
+ * Grows the id table so that it has a position for the given id.
+ */
+void sweep_and_prune_reserve_id(sweep_and_prune_t *sap, size_t id) {
+  if (id < sap->position_capacity) {
+    return;
+  }
+  size_t capacity =
+      sap->position_capacity == 0 ? SWEEP_INITIAL_SIZE : sap->position_capacity;
+  while (capacity <= id) {
+    capacity *= 2;
+  }
+  sap->positions = realloc(sap->positions, capacity * sizeof(size_t));
+  assert(sap->positions != NULL);
+  for (size_t i = sap->position_capacity; i < capacity; i++) {
+    sap->positions[i] = SWEEP_ABSENT;
+  }
+  sap->position_capacity = capacity;
+}
+
+void sweep_and_prune_insert(sweep_and_prune_t *sap, size_t id, aabb_t box) {
+  sweep_and_prune_reserve_id(sap, id);
+  size_t position = sap->positions[id];
+  if (position != SWEEP_ABSENT) {
+    sap->entries[position].box = box;
+    sap->entries[position].inserted = true;
+    return;
+  }
+  if (sap->entry_count == sap->entry_capacity) {
+    sap->entry_capacity = sap->entry_capacity == 0 ? SWEEP_INITIAL_SIZE
+                                                   : sap->entry_capacity * 2;
+    sap->entries =
+        realloc(sap->entries, sap->entry_capacity * sizeof(sweep_entry_t));
+    assert(sap->entries != NULL);
+  }
+  sap->positions[id] = sap->entry_count;
+  sap->entries[sap->entry_count++] =
+      (sweep_entry_t){.id = id, .box = box, .inserted = true, .wide = false};
+}
+
+/**
+ * Sorts the entries into wide and narrow ones by the given width.
+ */
+void sweep_and_prune_find_wide(sweep_and_prune_t *sap, double wide_width) {
+  sap->wide_count = 0;
+  sap->max_width = 0;
+  for (size_t i = 0; i < sap->entry_count; i++) {
+    sweep_entry_t *entry = &sap->entries[i];
+    double width = entry->box.max.x - entry->box.min.x;
+    entry->wide = width > wide_width;
+    if (!entry->wide) {
+      sap->max_width = width > sap->max_width ? width : sap->max_width;
+      continue;
+    }
+    if (sap->wide_count == sap->wide_capacity) {
+      sap->wide_capacity = sap->wide_capacity == 0 ? SWEEP_INITIAL_SIZE
+                                                   : sap->wide_capacity * 2;
+      sap->wide = realloc(sap->wide, sap->wide_capacity * sizeof(size_t));
+      assert(sap->wide != NULL);
+    }
+    sap->wide[sap->wide_count++] = i;
+  }
+}
+
+/**
+ * Drops the entries that were not inserted this round and insertion sorts
+ * the rest by left edge. Entries only move past the entries they overtook
+ * since the last round, so this is close to linear when boxes move slowly.
+ */
+void sweep_and_prune_sort(sweep_and_prune_t *sap) {
+  sweep_entry_t *entries = sap->entries;
+  size_t kept = 0;
+  for (size_t i = 0; i < sap->entry_count; i++) {
+    if (!entries[i].inserted) {
+      sap->positions[entries[i].id] = SWEEP_ABSENT;
+      continue;
+    }
+    sweep_entry_t entry = entries[i];
+    size_t j = kept;
+    while (j > 0 && entries[j - 1].box.min.x > entry.box.min.x) {
+      entries[j] = entries[j - 1];
+      j--;
+    }
+    entries[j] = entry;
+    kept++;
+  }
+  sap->entry_count = kept;
+  double total_width = 0;
+  for (size_t i = 0; i < kept; i++) {
+    sap->positions[entries[i].id] = i;
+    total_width += entries[i].box.max.x - entries[i].box.min.x;
+  }
+  double average_width = kept == 0 ? 0 : total_width / kept;
+  sweep_and_prune_find_wide(sap, SWEEP_WIDE_FACTOR * average_width);
+}
+
+void sweep_and_prune_find_pairs(sweep_and_prune_t *sap,
+                                sweep_pair_handler_t handler, void *aux) {
+  sweep_and_prune_sort(sap);
+  sweep_entry_t *entries = sap->entries;
+  for (size_t i = 0; i < sap->entry_count; i++) {
+    aabb_t box = entries[i].box;
+    for (size_t j = i + 1;
+         j < sap->entry_count && entries[j].box.min.x <= box.max.x; j++) {
+      if (entries[j].box.min.y <= box.max.y &&
+          box.min.y <= entries[j].box.max.y) {
+        handler(entries[i].id, entries[j].id, aux);
+      }
+    }
+    entries[i].inserted = false;
+  }
+}
+
+void sweep_and_prune_commit(sweep_and_prune_t *sap) {
+  sweep_and_prune_sort(sap);
+  for (size_t i = 0; i < sap->entry_count; i++) {
+    sap->entries[i].inserted = false;
+  }
+}
+
+/**
+ * Finds the first entry whose box's left edge is at least a given x, or
+ * past it if inclusive is false.
+ */
+size_t sweep_and_prune_search(sweep_and_prune_t *sap, double x,
+                              bool inclusive) {
+  size_t low = 0;
+  size_t high = sap->entry_count;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    double min_x = sap->entries[middle].box.min.x;
+    if (inclusive ? min_x < x : min_x <= x) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+void sweep_and_prune_query(sweep_and_prune_t *sap, aabb_t box,
+                           sweep_hit_handler_t handler, void *aux) {
+  sweep_entry_t *entries = sap->entries;
+  for (size_t i = sweep_and_prune_search(sap, box.min.x - sap->max_width, true);
+       i < sap->entry_count && entries[i].box.min.x <= box.max.x; i++) {
+    if (!entries[i].wide && aabb_overlaps(entries[i].box, box)) {
+      handler(entries[i].id, aux);
+    }
+  }
+  for (size_t i = 0; i < sap->wide_count; i++) {
+    sweep_entry_t *entry = &entries[sap->wide[i]];
+    if (aabb_overlaps(entry->box, box)) {
+      handler(entry->id, aux);
+    }
+  }
+}
+
+/**
+ * Reports an entry to a segment query if the segment enters its box within
+ * the query's reach, returning the query's new reach.
+ */
+double sweep_visit_segment_entry(sweep_entry_t *entry, vector_t start,
+                                 vector_t delta, double reach,
+                                 sweep_segment_handler_t handler, void *aux) {
+  if (aabb_segment_entry(entry->box, start, delta, reach) == INFINITY) {
+    return reach;
+  }
+  return fmin(reach, handler(entry->id, reach, aux));
+}
+
+/**
+ * A segment heading right can only enter narrow boxes whose left edges lie
+ * between max_width left of its start and the x it reaches, so those are
+ * walked left to right; a segment heading left walks the same window the
+ * other way. Either walk stops early as the reach shrinks.
+ */
+void sweep_and_prune_query_segment(sweep_and_prune_t *sap, vector_t start,
+                                   vector_t end,
+                                   sweep_segment_handler_t handler,
+                                   void *aux) {
+  sweep_entry_t *entries = sap->entries;
+  vector_t delta = vec_subtract(end, start);
+  double reach = 1;
+  for (size_t i = 0; i < sap->wide_count; i++) {
+    reach = sweep_visit_segment_entry(&entries[sap->wide[i]], start, delta,
+                                      reach, handler, aux);
+  }
+  if (delta.x >= 0) {
+    size_t first = sweep_and_prune_search(sap, start.x - sap->max_width, true);
+    for (size_t i = first; i < sap->entry_count &&
+                           entries[i].box.min.x <= start.x + reach * delta.x;
+         i++) {
+      if (!entries[i].wide) {
+        reach = sweep_visit_segment_entry(&entries[i], start, delta, reach,
+                                          handler, aux);
+      }
+    }
+    return;
+  }
+  size_t last = sweep_and_prune_search(sap, start.x, false);
+  for (size_t i = last; i > 0 && entries[i - 1].box.min.x + sap->max_width >=
+                                     start.x + reach * delta.x;
+       i--) {
+    if (!entries[i - 1].wide) {
+      reach = sweep_visit_segment_entry(&entries[i - 1], start, delta, reach,
+                                        handler, aux);
+    }
+  }
+}
@@ -0,0 +1,149 @@
+#include "tag_index.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * The bodies that share a tag, in no particular order.
+ */
+typedef struct tag_bucket {
+  body_tag_t tag;
+  body_t **bodies;
+  size_t count;
+  size_t capacity;
+} tag_bucket_t;
+
+/**
+ * Where a body sits: at position in the bucket with index bucket, or
+ * nowhere if bucket is NO_TAG_BUCKET.
+ */
+typedef struct tag_entry {
+  size_t bucket;
+  size_t position;
+} tag_entry_t;
+
+/**
+ * entries[i] is where the body whose handle has index i sits.
+ */
+typedef struct tag_index {
+  tag_bucket_t *buckets;
+  size_t bucket_count;
+  size_t bucket_capacity;
+  tag_entry_t *entries;
+  size_t entry_capacity;
+} tag_index_t;
+
+const size_t TAG_INDEX_INITIAL_SIZE = 10;
+const size_t NO_TAG_BUCKET = SIZE_MAX;
+
+tag_index_t *tag_index_init(void) {
+  tag_index_t *index = malloc(sizeof(tag_index_t));
+  assert(index != NULL);
+  index->buckets = NULL;
+  index->bucket_count = 0;
+  index->bucket_capacity = 0;
+  index->entries = NULL;
+  index->entry_capacity = 0;
+  return index;
+}
+
+void tag_index_free(tag_index_t *index) {
+  for (size_t i = 0; i < index->bucket_count; i++) {
+    free(index->buckets[i].bodies);
+  }
+  free(index->buckets);
+  free(index->entries);
+  free(index);
+}
+
+/**
+ * Finds the index of the bucket holding a tag's bodies, or NO_TAG_BUCKET if
+ * the index has never held a body with that tag.
+ */
+size_t tag_index_find_bucket(tag_index_t *index, body_tag_t tag) {
+  for (size_t i = 0; i < index->bucket_count; i++) {
+    if (body_tag_equals(index->buckets[i].tag, tag)) {
+      return i;
+    }
+  }
+  return NO_TAG_BUCKET;
+}
+
+/**
+ * Gets the entry for the body whose handle has a given index, growing the
+ * entries to hold it if needed.
+ */
+tag_entry_t *tag_index_get_entry(tag_index_t *index, size_t handle_index) {
+  if (handle_index >= index->entry_capacity) {
+    size_t capacity = index->entry_capacity == 0 ? TAG_INDEX_INITIAL_SIZE
+                                                 : index->entry_capacity;
+    while (capacity <= handle_index) {
+      capacity *= 2;
+    }
+    index->entries = realloc(index->entries, capacity * sizeof(tag_entry_t));
+    assert(index->entries != NULL);
+    index->entry_capacity = capacity;
+  }
+  return &index->entries[handle_index];
+}
+
+void tag_index_add(tag_index_t *index, body_t *body) {
+  tag_entry_t *entry = tag_index_get_entry(index, body_get_handle(body).index);
+  body_tag_t tag = body_get_tag(body);
+  entry->bucket = NO_TAG_BUCKET;
+  if (tag.kind == BODY_TAG_NONE.kind) {
+    return;
+  }
+  size_t bucket_index = tag_index_find_bucket(index, tag);
+  if (bucket_index == NO_TAG_BUCKET) {
+    if (index->bucket_count == index->bucket_capacity) {
+      index->bucket_capacity = index->bucket_capacity == 0
+                                   ? TAG_INDEX_INITIAL_SIZE
+                                   : index->bucket_capacity * 2;
+      index->buckets = realloc(index->buckets,
+                               index->bucket_capacity * sizeof(tag_bucket_t));
+      assert(index->buckets != NULL);
+    }
+    bucket_index = index->bucket_count++;
+    index->buckets[bucket_index] =
+        (tag_bucket_t){.tag = tag, .bodies = NULL, .count = 0, .capacity = 0};
+  }
+  tag_bucket_t *bucket = &index->buckets[bucket_index];
+  if (bucket->count == bucket->capacity) {
+    bucket->capacity =
+        bucket->capacity == 0 ? TAG_INDEX_INITIAL_SIZE : bucket->capacity * 2;
+    bucket->bodies =
+        realloc(bucket->bodies, bucket->capacity * sizeof(body_t *));
+    assert(bucket->bodies != NULL);
+  }
+  entry->bucket = bucket_index;
+  entry->position = bucket->count;
+  bucket->bodies[bucket->count++] = body;
+}
+
+void tag_index_remove(tag_index_t *index, body_t *body) {
+  size_t handle_index = body_get_handle(body).index;
+  assert(handle_index < index->entry_capacity);
+  tag_entry_t *entry = &index->entries[handle_index];
+  if (entry->bucket == NO_TAG_BUCKET) {
+    return;
+  }
+  tag_bucket_t *bucket = &index->buckets[entry->bucket];
+  size_t last = bucket->count - 1;
+  if (entry->position != last) {
+    body_t *moved = bucket->bodies[last];
+    bucket->bodies[entry->position] = moved;
+    index->entries[body_get_handle(moved).index].position = entry->position;
+  }
+  bucket->count--;
+  entry->bucket = NO_TAG_BUCKET;
+}
+
+body_view_t tag_index_get(tag_index_t *index, body_tag_t tag) {
+  size_t bucket_index = tag_index_find_bucket(index, tag);
+  if (bucket_index == NO_TAG_BUCKET) {
+    return (body_view_t){.bodies = NULL, .size = 0};
+  }
+  tag_bucket_t *bucket = &index->buckets[bucket_index];
+  return (body_view_t){.bodies = bucket->bodies, .size = bucket->count};
+}
@@ -35,6 +35,131 @@ bool vec_isclose(vector_t v1, vector_t v2) {
   return isclose(v1.x, v2.x) && isclose(v1.y, v2.y);
 }
 
+polygon_t *make_box(vector_t center, double width, double height) {
+  polygon_t *box = polygon_init(4);
+  polygon_add(box, vec_add(center, (vector_t){-width / 2, -height / 2}));
+  polygon_add(box, vec_add(center, (vector_t){width / 2, -height / 2}));
+  polygon_add(box, vec_add(center, (vector_t){width / 2, height / 2}));
+  polygon_add(box, vec_add(center, (vector_t){-width / 2, height / 2}));
+  return box;
+}
+
+body_t *make_box_body(vector_t center, double width, double height,
+                      double mass) {
+  return body_init_from_polygon(make_box(center, width, height), mass,
+                                (rgb_color_t){0, 0, 0}, NULL, NULL);
+}
+
+list_t *make_shape(void) {
+  list_t *square = list_init(4, free);
+  for (int i = 0; i < 4; i++) {
+    vector_t *v = malloc(sizeof(*v));
+    assert(v != NULL);
+    *v = (vector_t){i == 1 || i == 2 ? 1 : -1, i < 2 ? -1 : 1};
+    list_add(square, v);
+  }
+  return square;
+}
+
+double random_between(double min, double max) {
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+void random_boxes(aabb_t *boxes, size_t count, aabb_t area, double max_size) {
+  assert(count <= TEST_MAX_BOXES);
+  for (size_t i = 0; i < count; i++) {
+    vector_t min = {random_between(area.min.x, area.max.x),
+                    random_between(area.min.y, area.max.y)};
+    double width = i % 40 == 0 ? 1500 : random_between(1, max_size);
+    boxes[i] = (aabb_t){.min = min,
+                        .max = {min.x + width,
+                                min.y + random_between(1, max_size)}};
+  }
+}
+
+void count_pair(size_t id1, size_t id2, pair_counts_t *counts) {
+  assert(id1 != id2);
+  assert(id1 < TEST_MAX_BOXES && id2 < TEST_MAX_BOXES);
+  counts->counts[id1][id2]++;
+  counts->counts[id2][id1]++;
+}
+
+void check_pair_counts(pair_counts_t *counts, aabb_t *boxes, bool *present,
+                       size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = i + 1; j < count; j++) {
+      bool expected = aabb_overlaps(boxes[i], boxes[j]) &&
+                      (present == NULL || (present[i] && present[j]));
+      assert(counts->counts[i][j] == (expected ? 1 : 0));
+    }
+  }
+}
+
+void count_hit(size_t id, hit_counts_t *counts) {
+  assert(id < TEST_MAX_BOXES);
+  counts->hits[id]++;
+}
+
+void check_box_queries(void *index, box_query_t query, aabb_t *boxes,
+                       size_t count, aabb_t area, size_t queries) {
+  for (size_t q = 0; q < queries; q++) {
+    aabb_t box = area;
+    if (q % 10 != 0) {
+      vector_t min = {random_between(area.min.x, area.max.x),
+                      random_between(area.min.y, area.max.y)};
+      double size = random_between(1, 300);
+      box = (aabb_t){.min = min, .max = {min.x + size, min.y + size / 2}};
+    }
+    hit_counts_t counts = {0};
+    query(index, box, &counts);
+    for (size_t i = 0; i < count; i++) {
+      assert(counts.hits[i] == (aabb_overlaps(boxes[i], box) ? 1 : 0));
+    }
+  }
+}
+
+double count_segment_hit(size_t id, double max_fraction,
+                         segment_hits_t *hits) {
+  count_hit(id, &hits->counts);
+  if (!hits->closest) {
+    return max_fraction;
+  }
+  return fmin(max_fraction, aabb_segment_entry(hits->boxes[id], hits->start,
+                                               hits->delta, max_fraction));
+}
+
+void check_segment_queries(void *index, segment_query_t query, aabb_t *boxes,
+                           size_t count, aabb_t area, size_t queries) {
+  for (size_t q = 0; q < queries; q++) {
+    vector_t start = {random_between(area.min.x, area.max.x),
+                      random_between(area.min.y, area.max.y)};
+    vector_t end = {random_between(area.min.x, area.max.x),
+                    random_between(area.min.y, area.max.y)};
+    segment_hits_t hits = {.boxes = boxes,
+                           .start = start,
+                           .delta = vec_subtract(end, start),
+                           .counts = {{0}},
+                           .closest = q % 2 == 1};
+    query(index, start, end, &hits);
+    double nearest = INFINITY;
+    size_t nearest_id = count;
+    for (size_t i = 0; i < count; i++) {
+      double entry = aabb_segment_entry(boxes[i], start, hits.delta, 1);
+      if (entry < nearest) {
+        nearest = entry;
+        nearest_id = i;
+      }
+      int entered = entry != INFINITY ? 1 : 0;
+      if (!hits.closest) {
+        assert(hits.counts.hits[i] == entered);
+      } else {
+        assert(hits.counts.hits[i] <= entered);
+      }
+    }
+    assert(nearest_id == count || hits.counts.hits[nearest_id] == 1);
+  }
+}
+
 void read_testname(char *filename, char *testname, size_t testname_size) {
   FILE *f = fopen(filename, "r");
   if (f == NULL) {
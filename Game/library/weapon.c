@@ -200,21 +200,29 @@ void weapon_decrement_reload(weapon_t *weapon, double timer_decrement) {
 
 double weapon_reload_timer(weapon_t *weapon) { return weapon->reload_time; }
 
+/**
+ * Returns whether a bullet was fired by the player's character.
+ */
+bool fired_by_player(body_t *shooter) {
+  return body_tag_equals(body_get_tag(shooter), comp_info_tag(CHARACTER));
+}
+
+/**
+ * Picks the collision layer for a bullet from the body that fired it, so
+ * the layer collisions registered by the game decide what it can hit.
+ */
+size_t bullet_layer(body_t *shooter) {
+  return fired_by_player(shooter) ? PLAYER_BULLET_LAYER : ENEMY_BULLET_LAYER;
+}
+
 void shotgun_shoot(scene_t *scene, weapon_t *weapon, vector_t dir,
                    body_t *shooter, double mass) {
-  computer_info_t *shooter_info = body_get_info(shooter);
-  list_t *obstacles = scene_bodies_with_comp_info(scene, OBSTACLE);
-  list_t *enemies = scene_bodies_with_comp_info(scene, ENEMY);
-  list_t *characters = scene_bodies_with_comp_info(scene, CHARACTER);
-  list_t *shields = scene_bodies_with_comp_info(scene, SHIELD);
+  size_t layer = bullet_layer(shooter);
   for (size_t i = 1; i <= (size_t)SHOTGUN_AMMO; i++) {
-    bullet_info_t *bullet_info = malloc(sizeof(bullet_info_t));
-    *bullet_info = weapon->bullet_type;
-    vector_t *bullet_center = malloc(sizeof(vector_t));
-    *bullet_center = body_get_centroid(shooter);
-    body_t *bullet = body_init_with_info(
-        create_sector(BULLET_WIDTH, bullet_center, 2 * M_PI, false), mass * 2,
-        set_bullet_color(weapon->bullet_type), bullet_info, free);
+    body_t *bullet = body_init_circle(
+        body_get_centroid(shooter), BULLET_WIDTH, mass * 2,
+        set_bullet_color(weapon->bullet_type), NULL, NULL);
+    body_set_tag(bullet, bullet_info_tag(weapon->bullet_type));
     if (i % 2) {
       body_set_velocity(
           bullet,
@@ -224,32 +232,11 @@ void shotgun_shoot(scene_t *scene, weapon_t *weapon, vector_t dir,
           bullet,
           vec_multiply(BULLET_SPEED, vec_rotate(dir, -SHOTGUN_SPREAD * i)));
     }
+    body_set_collision_layer(bullet, layer);
+    body_set_continuous(bullet, true);
     scene_add_body(scene, bullet);
     create_drag(scene, set_bullet_drag(weapon->bullet_type), bullet);
-    for (size_t i = 0; i < list_size(obstacles); i++) {
-      body_t *obstacle = list_get(obstacles, i);
-      create_solo_destructive_collision(scene, obstacle, bullet);
-    }
-    if (*shooter_info == CHARACTER) {
-      for (size_t i = 0; i < list_size(enemies); i++) {
-        body_t *enemy = list_get(enemies, i);
-        create_damaging_collision(scene, enemy, bullet);
-      }
-    } else if (*shooter_info == ENEMY) {
-      for (size_t i = 0; i < list_size(characters); i++) {
-        body_t *character = list_get(characters, i);
-        create_damaging_collision(scene, character, bullet);
-      }
-      for (size_t i = 0; i < list_size(shields); i++) {
-        body_t *shield = list_get(shields, i);
-        create_damaging_collision(scene, shield, bullet);
-      }
-    }
   }
-  list_free(shields);
-  list_free(obstacles);
-  list_free(enemies);
-  list_free(characters);
 }
 
 void weapon_shoot(scene_t *scene, weapon_t *weapon, vector_t dir,
@@ -270,48 +257,24 @@ void weapon_shoot(scene_t *scene, weapon_t *weapon, vector_t dir,
     shotgun_shoot(scene, weapon, dir, shooter, mass);
   } else {
     vector_t center = body_get_centroid(shooter);
-    computer_info_t *shooter_info = body_get_info(shooter);
-    bullet_info_t *bullet_info = malloc(sizeof(bullet_info_t));
-    *bullet_info = weapon->bullet_type;
-    body_t *bullet = body_init_with_info(
+    body_t *bullet = body_init_from_polygon(
         create_four_sided_shape(center, BULLET_LENGTH, BULLET_WIDTH), mass,
-        set_bullet_color(weapon->bullet_type), bullet_info, free);
+        set_bullet_color(weapon->bullet_type), NULL, NULL);
+    body_set_tag(bullet, bullet_info_tag(weapon->bullet_type));
     body_set_rotation(bullet, orientation);
     body_set_velocity(bullet, vec_multiply(BULLET_SPEED, dir));
+    body_set_collision_layer(bullet, bullet_layer(shooter));
+    body_set_continuous(bullet, true);
     scene_add_body(scene, bullet);
     create_drag(scene, set_bullet_drag(weapon->bullet_type), bullet);
-    list_t *obstacles = scene_bodies_with_comp_info(scene, OBSTACLE);
-    for (size_t i = 0; i < list_size(obstacles); i++) {
-      body_t *obstacle = list_get(obstacles, i);
-      create_solo_destructive_collision(scene, obstacle, bullet);
-    }
-    if (*shooter_info == CHARACTER) {
-      list_t *enemies = scene_bodies_with_comp_info(scene, ENEMY);
-      for (size_t i = 0; i < list_size(enemies); i++) {
-        body_t *enemy = list_get(enemies, i);
-        if (mass > BULLET_MASS) {
-          // Homing bullet that draws enemies
-          body_set_velocity(bullet, vec_multiply(400, dir));
-          create_newtonian_gravity(scene, 100000, bullet, enemy);
-        }
-        create_damaging_collision(scene, enemy, bullet);
-      }
-      list_free(enemies);
-    } else if (*shooter_info == ENEMY) {
-      list_t *characters = scene_bodies_with_comp_info(scene, CHARACTER);
-      for (size_t i = 0; i < list_size(characters); i++) {
-        body_t *character = list_get(characters, i);
-        create_damaging_collision(scene, character, bullet);
-      }
-      list_free(characters);
-      list_t *shields = scene_bodies_with_comp_info(scene, SHIELD);
-      for (size_t i = 0; i < list_size(shields); i++) {
-        body_t *shield = list_get(shields, i);
-        create_damaging_collision(scene, shield, bullet);
+    if (fired_by_player(shooter) && mass > BULLET_MASS) {
+      // Homing bullet that draws enemies
+      body_set_velocity(bullet, vec_multiply(400, dir));
+      body_view_t enemies = scene_bodies_with_comp_info(scene, ENEMY);
+      for (size_t i = 0; i < enemies.size; i++) {
+        create_newtonian_gravity(scene, 100000, bullet, enemies.bodies[i]);
       }
-      list_free(shields);
     }
-    list_free(obstacles);
   }
   if (mass <= BULLET_MASS) {
     weapon->ammo--;
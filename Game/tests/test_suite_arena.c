@@ -0,0 +1,96 @@
+#include "arena.h"
+#include "list.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+void test_alloc() {
+  arena_t *arena = arena_init(256);
+  char *bytes = arena_alloc(arena, 3);
+  double *number = arena_alloc(arena, sizeof(double));
+  assert((uintptr_t)number % alignof(max_align_t) == 0);
+  assert((char *)number >= bytes + 3);
+  bytes[2] = 'x';
+  *number = 1.5;
+  assert(bytes[2] == 'x' && *number == 1.5);
+  assert(arena_used(arena) >= 3 + sizeof(double));
+  arena_free(arena);
+}
+
+// Resetting reuses the same memory
+void test_reset() {
+  arena_t *arena = arena_init(256);
+  void *first = arena_alloc(arena, 64);
+  arena_alloc(arena, 64);
+  arena_reset(arena);
+  assert(arena_used(arena) == 0);
+  assert(arena_alloc(arena, 64) == first);
+  arena_free(arena);
+}
+
+// Allocates 100 ints and a large buffer, returning the first int
+int *fill_arena(arena_t *arena) {
+  int *values[100];
+  for (int i = 0; i < 100; i++) {
+    values[i] = arena_alloc(arena, sizeof(int));
+    *values[i] = i;
+  }
+  assert(arena_alloc(arena, 1000) != NULL);
+  for (int i = 0; i < 100; i++) {
+    assert(*values[i] == i);
+  }
+  return values[0];
+}
+
+// Overflowing an arena grows it, and the next reset merges the blocks
+// so the same workload then fits without growing again
+void test_growth() {
+  arena_t *arena = arena_init(64);
+  fill_arena(arena);
+  arena_reset(arena);
+  int *first = fill_arena(arena);
+  arena_reset(arena);
+  assert(fill_arena(arena) == first);
+  arena_free(arena);
+}
+
+int freed_count = 0;
+
+void count_free(void *value) { freed_count++; }
+
+void test_arena_list() {
+  arena_t *arena = arena_init(64);
+  list_t *list = list_init_in_arena(arena, 1, count_free);
+  int values[20];
+  for (int i = 0; i < 20; i++) {
+    values[i] = i;
+    list_add(list, &values[i]);
+  }
+  assert(list_size(list) == 20);
+  for (int i = 0; i < 20; i++) {
+    assert(list_get(list, i) == &values[i]);
+  }
+  freed_count = 0;
+  list_free(list);
+  assert(freed_count == 20);
+  arena_free(arena);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_alloc)
+  DO_TEST(test_reset)
+  DO_TEST(test_growth)
+  DO_TEST(test_arena_list)
+
+  puts("arena_test PASS");
+}
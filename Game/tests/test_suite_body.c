@@ -248,6 +248,211 @@ void test_body_info_freer() {
   body_free(body);
 }
 
+// The shape view reads the body's own vertices and follows its movement
+void test_body_shape_view() {
+  vector_t v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
+  const size_t VERTICES = sizeof(v) / sizeof(*v);
+  polygon_t *polygon = polygon_init(VERTICES);
+  for (size_t i = 0; i < VERTICES; i++) {
+    polygon_add(polygon, v[i]);
+  }
+  body_t *body =
+      body_init_from_polygon(polygon, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  polygon_view_t view = body_get_shape_view(body);
+  assert(view.size == VERTICES);
+  for (size_t i = 0; i < VERTICES; i++) {
+    assert(vec_isclose(view.vertices[i], v[i]));
+  }
+
+  body_set_centroid(body, (vector_t){2.5, 1.5});
+  view = body_get_shape_view(body);
+  for (size_t i = 0; i < VERTICES; i++) {
+    assert(vec_isclose(view.vertices[i], vec_add(v[i], (vector_t){1, 0})));
+  }
+  body_free(body);
+}
+
+// A shape copied into an arena lives until the arena is reset, while a plain
+// copy is the caller's to free
+void test_body_shape_in_arena() {
+  vector_t v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
+  const size_t VERTICES = sizeof(v) / sizeof(*v);
+  polygon_t *polygon = polygon_init(VERTICES);
+  for (size_t i = 0; i < VERTICES; i++) {
+    polygon_add(polygon, v[i]);
+  }
+  body_t *body =
+      body_init_from_polygon(polygon, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  arena_t *arena = arena_init(16);
+  list_t *copy = body_get_shape(body);
+  list_t *temporary = body_get_shape_in_arena(body, arena);
+  assert(arena_used(arena) > 0);
+  assert(list_size(temporary) == VERTICES);
+  for (size_t i = 0; i < VERTICES; i++) {
+    assert(vec_isclose(*(vector_t *)list_get(temporary, i), v[i]));
+  }
+  arena_free(arena);
+  frame_arena_reset();
+  assert(list_size(copy) == VERTICES);
+  for (size_t i = 0; i < VERTICES; i++) {
+    assert(vec_isclose(*(vector_t *)list_get(copy, i), v[i]));
+  }
+  list_free(copy);
+  body_free(body);
+}
+
+// Repeatedly rotating and moving a body does not distort its shape
+void test_body_no_drift() {
+  vector_t v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
+  const size_t VERTICES = sizeof(v) / sizeof(*v);
+  polygon_t *polygon = polygon_init(VERTICES);
+  for (size_t i = 0; i < VERTICES; i++) {
+    polygon_add(polygon, v[i]);
+  }
+  body_t *body =
+      body_init_from_polygon(polygon, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  for (int i = 0; i < 100000; i++) {
+    body_set_rotation(body, i * 0.1);
+    body_set_centroid(body, (vector_t){i, -i});
+    body_get_shape_view(body);
+  }
+  body_set_rotation(body, 0);
+  body_set_centroid(body, (vector_t){1.5, 1.5});
+  polygon_view_t view = body_get_shape_view(body);
+  for (size_t i = 0; i < VERTICES; i++) {
+    assert(vec_equal(view.vertices[i], v[i]));
+  }
+  body_free(body);
+}
+
+// The bounding box and radius contain the shape as it moves and rotates
+void test_body_bounds() {
+  vector_t v[] = {{0, 0}, {4, 0}, {4, 2}, {0, 2}};
+  const size_t VERTICES = sizeof(v) / sizeof(*v);
+  polygon_t *polygon = polygon_init(VERTICES);
+  for (size_t i = 0; i < VERTICES; i++) {
+    polygon_add(polygon, v[i]);
+  }
+  body_t *body =
+      body_init_from_polygon(polygon, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(isclose(body_get_bounding_radius(body), sqrt(5)));
+  aabb_t box = body_get_aabb(body);
+  assert(vec_isclose(box.min, (vector_t){0, 0}));
+  assert(vec_isclose(box.max, (vector_t){4, 2}));
+
+  for (int i = 0; i < 16; i++) {
+    body_set_rotation(body, i * M_PI / 8);
+    body_set_centroid(body, (vector_t){i, 2 * i});
+    box = body_get_aabb(body);
+    polygon_view_t view = body_get_shape_view(body);
+    for (size_t j = 0; j < view.size; j++) {
+      vector_t vertex = view.vertices[j];
+      assert(box.min.x - 1e-9 <= vertex.x && vertex.x <= box.max.x + 1e-9);
+      assert(box.min.y - 1e-9 <= vertex.y && vertex.y <= box.max.y + 1e-9);
+      vector_t offset = vec_subtract(vertex, body_get_centroid(body));
+      assert(sqrt(vec_dot(offset, offset)) <=
+             body_get_bounding_radius(body) + 1e-9);
+    }
+  }
+
+  body_set_rotation(body, M_PI / 2);
+  body_set_centroid(body, (vector_t){10, 10});
+  box = body_get_aabb(body);
+  assert(vec_isclose(box.min, (vector_t){9, 8}));
+  assert(vec_isclose(box.max, (vector_t){11, 12}));
+  body_free(body);
+}
+
+// Each normal is a unit vector perpendicular to some edge of the shape,
+// and every edge has one
+void check_body_normals(body_t *body, size_t expected_count) {
+  normal_view_t normals = body_get_normals(body);
+  polygon_view_t view = body_get_shape_view(body);
+  assert(normals.size == expected_count);
+  for (size_t i = 0; i < normals.size; i++) {
+    assert(isclose(vec_dot(normals.normals[i], normals.normals[i]), 1));
+  }
+  for (size_t j = 0; j < view.size; j++) {
+    vector_t edge =
+        vec_subtract(view.vertices[(j + 1) % view.size], view.vertices[j]);
+    size_t perpendicular = 0;
+    for (size_t i = 0; i < normals.size; i++) {
+      if (fabs(vec_dot(normals.normals[i], edge)) < 1e-9) {
+        perpendicular++;
+      }
+    }
+    assert(perpendicular == 1);
+  }
+}
+
+// Parallel edges share a normal, and normals follow the body's rotation
+void test_body_normals() {
+  vector_t v[] = {{0, 0}, {4, 0}, {4, 2}, {0, 2}};
+  const size_t VERTICES = sizeof(v) / sizeof(*v);
+  polygon_t *polygon = polygon_init(VERTICES);
+  for (size_t i = 0; i < VERTICES; i++) {
+    polygon_add(polygon, v[i]);
+  }
+  body_t *body =
+      body_init_from_polygon(polygon, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  check_body_normals(body, 2);
+  for (int i = 1; i < 8; i++) {
+    body_set_rotation(body, i * M_PI / 7);
+    check_body_normals(body, 2);
+  }
+  body_free(body);
+
+  polygon = polygon_init(3);
+  polygon_add(polygon, (vector_t){0, 0});
+  polygon_add(polygon, (vector_t){3, 0});
+  polygon_add(polygon, (vector_t){0, 1});
+  body = body_init_from_polygon(polygon, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  check_body_normals(body, 3);
+  body_set_rotation(body, 1);
+  check_body_normals(body, 3);
+  body_free(body);
+}
+
+// Circular bodies are bounded by the circle, not by their outline
+void test_body_circle() {
+  body_t *body = body_init_circle((vector_t){3, 4}, 2, 1,
+                                  (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(body_get_shape_kind(body) == SHAPE_CIRCLE);
+  assert(isclose(body_get_radius(body), 2));
+  assert(vec_isclose(body_get_centroid(body), (vector_t){3, 4}));
+  assert(body_get_shape_view(body).size == BODY_CIRCLE_OUTLINE_VERTICES);
+  body_set_rotation(body, M_PI / 5);
+  body_set_centroid(body, (vector_t){1, 1});
+  aabb_t box = body_get_aabb(body);
+  assert(vec_isclose(box.min, (vector_t){-1, -1}));
+  assert(vec_isclose(box.max, (vector_t){3, 3}));
+  assert(isclose(body_get_bounding_radius(body), 2));
+  body_free(body);
+}
+
+void test_aabb_overlaps() {
+  aabb_t box = {.min = {0, 0}, .max = {2, 2}};
+  assert(aabb_overlaps(box, (aabb_t){.min = {1, 1}, .max = {3, 3}}));
+  assert(aabb_overlaps(box, (aabb_t){.min = {2, 0}, .max = {3, 1}}));
+  assert(!aabb_overlaps(box, (aabb_t){.min = {3, 0}, .max = {4, 2}}));
+  assert(!aabb_overlaps(box, (aabb_t){.min = {0, -3}, .max = {2, -1}}));
+}
+
+// Bodies start untagged, and tags only match in both kind and subtype
+void test_body_tag() {
+  body_t *body =
+      body_init_circle(VEC_ZERO, 1, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(body_tag_equals(body_get_tag(body), BODY_TAG_NONE));
+  body_tag_t tag = {.kind = 1, .subtype = 20};
+  body_set_tag(body, tag);
+  assert(body_tag_equals(body_get_tag(body), tag));
+  assert(!body_tag_equals(body_get_tag(body),
+                          (body_tag_t){.kind = 2, .subtype = 20}));
+  assert(!body_tag_equals(body_get_tag(body),
+                          (body_tag_t){.kind = 1, .subtype = 15}));
+  body_free(body);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -265,6 +470,14 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_body_remove)
   DO_TEST(test_body_info)
   DO_TEST(test_body_info_freer)
+  DO_TEST(test_body_shape_view)
+  DO_TEST(test_body_shape_in_arena)
+  DO_TEST(test_body_no_drift)
+  DO_TEST(test_body_bounds)
+  DO_TEST(test_aabb_overlaps)
+  DO_TEST(test_body_circle)
+  DO_TEST(test_body_normals)
+  DO_TEST(test_body_tag)
 
   puts("body_test PASS");
 }
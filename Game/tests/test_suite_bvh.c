@@ -0,0 +1,73 @@
+#include "bvh.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define BOXES 300
+
+const aabb_t BOX_AREA = {.min = {-1000, -500}, .max = {1000, 500}};
+const aabb_t QUERY_AREA = {.min = {-1200, -600}, .max = {1200, 600}};
+
+void query_bvh(bvh_t *bvh, aabb_t box, hit_counts_t *counts) {
+  bvh_query(bvh, box, (bvh_hit_handler_t)count_hit, counts);
+}
+
+void query_bvh_segment(bvh_t *bvh, vector_t start, vector_t end,
+                       segment_hits_t *hits) {
+  bvh_query_segment(bvh, start, end, (bvh_segment_handler_t)count_segment_hit,
+                    hits);
+}
+
+// Box and segment queries on a built tree agree with testing every box
+void test_matches_brute_force() {
+  srand(5);
+  aabb_t boxes[BOXES];
+  random_boxes(boxes, BOXES, BOX_AREA, 150);
+  bvh_t *bvh = bvh_init();
+  for (size_t i = 0; i < BOXES; i++) {
+    bvh_insert(bvh, i, boxes[i]);
+  }
+  bvh_build(bvh);
+  assert(bvh_size(bvh) == BOXES);
+  check_box_queries(bvh, (box_query_t)query_bvh, boxes, BOXES, QUERY_AREA,
+                    100);
+  check_segment_queries(bvh, (segment_query_t)query_bvh_segment, boxes, BOXES,
+                        QUERY_AREA, 100);
+  bvh_free(bvh);
+}
+
+// Boxes inserted after a build are found once the tree is rebuilt
+void test_empty_and_rebuild() {
+  bvh_t *bvh = bvh_init();
+  aabb_t box = {.min = {0, 0}, .max = {10, 10}};
+  hit_counts_t counts = {0};
+  bvh_build(bvh);
+  query_bvh(bvh, box, &counts);
+  assert(counts.hits[0] == 0);
+
+  bvh_insert(bvh, 0, (aabb_t){.min = {5, 5}, .max = {20, 20}});
+  bvh_build(bvh);
+  bvh_insert(bvh, 1, (aabb_t){.min = {-5, -5}, .max = {1, 1}});
+  bvh_insert(bvh, 2, (aabb_t){.min = {11, 0}, .max = {12, 1}});
+  bvh_build(bvh);
+  query_bvh(bvh, box, &counts);
+  assert(counts.hits[0] == 1);
+  assert(counts.hits[1] == 1);
+  assert(counts.hits[2] == 0);
+  bvh_free(bvh);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_matches_brute_force)
+  DO_TEST(test_empty_and_rebuild)
+
+  puts("bvh_test PASS");
+}
@@ -1 +1,299 @@
-int main(int argc, char *argv[]) {}
\ No newline at end of file
+#include "collision.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_circle_collision() {
+  collision_info_t info =
+      find_circle_collision(VEC_ZERO, 2, (vector_t){3, 0}, 2);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){1, 0}));
+  info = find_circle_collision((vector_t){0, 3}, 2, VEC_ZERO, 2);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){0, -1}));
+  info = find_circle_collision(VEC_ZERO, 1, (vector_t){3, 0}, 1);
+  assert(!info.collided);
+  info = find_circle_collision(VEC_ZERO, 1, VEC_ZERO, 1);
+  assert(info.collided);
+}
+
+// Circles collide with a square's edges, but not past its corners
+// where the bounding boxes would overlap
+void test_circle_polygon_collision() {
+  polygon_t *square = make_box(VEC_ZERO, 2, 2);
+  polygon_view_t view = polygon_get_view(square);
+  collision_info_t info =
+      find_circle_polygon_collision((vector_t){-2.5, 0}, 2, view);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){0.5, 0}));
+  info = find_circle_polygon_collision((vector_t){0, 1.5}, 1, view);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){0, -0.5}));
+  info = find_circle_polygon_collision((vector_t){1.8, 1.8}, 1, view);
+  assert(!info.collided);
+  info = find_circle_polygon_collision((vector_t){1.5, 1.5}, 1, view);
+  assert(info.collided);
+  info = find_circle_polygon_collision((vector_t){0, 3}, 1, view);
+  assert(!info.collided);
+  polygon_free(square);
+}
+
+// Bodies are tested by their shape kinds, with the axis pointing from the
+// first body towards the second
+void test_body_collision() {
+  body_t *circle = body_init_circle((vector_t){2.5, 0}, 2, 1,
+                                    (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_t *square = body_init_from_polygon(make_box(VEC_ZERO, 2, 2), 1,
+                                          (rgb_color_t){0, 0, 0}, NULL, NULL);
+  collision_info_t info = find_body_collision(square, circle);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){0.5, 0}));
+  info = find_body_collision(circle, square);
+  assert(info.collided);
+  assert(vec_isclose(info.axis, (vector_t){-0.5, 0}));
+  body_set_centroid(circle, (vector_t){4, 0});
+  assert(!find_body_collision(square, circle).collided);
+  body_free(circle);
+  body_free(square);
+}
+
+// Only rectangles can be described as boxes
+void test_collision_box_from_body() {
+  body_t *body = make_box_body((vector_t){1, 2}, 4, 2, 1);
+  body_set_rotation(body, M_PI / 2);
+  collision_box_t box;
+  assert(collision_box_from_body(body, &box));
+  assert(vec_isclose(box.center, (vector_t){1, 2}));
+  assert(vec_isclose(box.direction, (vector_t){0, 1}));
+  assert(isclose(box.half_width, 2));
+  assert(isclose(box.half_height, 1));
+  body_free(body);
+
+  polygon_t *triangle = polygon_init(3);
+  polygon_add(triangle, (vector_t){0, 0});
+  polygon_add(triangle, (vector_t){1, 0});
+  polygon_add(triangle, (vector_t){0, 1});
+  body = body_init_from_polygon(triangle, 1, (rgb_color_t){0, 0, 0}, NULL,
+                                NULL);
+  assert(!collision_box_from_body(body, &box));
+  body_free(body);
+  body = body_init_circle(VEC_ZERO, 1, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(!collision_box_from_body(body, &box));
+  body_free(body);
+}
+
+// Each box in a batch gets the same result as testing it on its own
+void test_collision_batch() {
+  srand(3);
+  polygon_t *triangle = polygon_init(3);
+  polygon_add(triangle, (vector_t){0, 0});
+  polygon_add(triangle, (vector_t){6, 0});
+  polygon_add(triangle, (vector_t){2, 4});
+  body_t *shape = body_init_from_polygon(triangle, 1, (rgb_color_t){0, 0, 0},
+                                         NULL, NULL);
+  body_t *bodies[COLLISION_BATCH_MAX];
+  collision_box_t boxes[COLLISION_BATCH_MAX];
+  vector_t axes[COLLISION_BATCH_MAX];
+  size_t counts[] = {1, 4, 7, COLLISION_BATCH_MAX};
+  size_t hits = 0;
+  for (size_t round = 0; round < 40; round++) {
+    body_set_rotation(shape, random_between(0, 2 * M_PI));
+    size_t count = counts[round % (sizeof(counts) / sizeof(*counts))];
+    for (size_t i = 0; i < count; i++) {
+      vector_t center = {random_between(-6, 10), random_between(-6, 10)};
+      bodies[i] = make_box_body(center, random_between(0.5, 4),
+                                random_between(0.5, 4), 1);
+      body_set_rotation(bodies[i], random_between(0, 2 * M_PI));
+      assert(collision_box_from_body(bodies[i], &boxes[i]));
+    }
+    uint32_t mask =
+        find_collision_batch(body_get_shape_view(shape),
+                             body_get_normals(shape), boxes, count, axes);
+    for (size_t i = 0; i < count; i++) {
+      collision_info_t info = find_collision_normals(
+          body_get_shape_view(shape), body_get_normals(shape),
+          body_get_shape_view(bodies[i]), body_get_normals(bodies[i]));
+      bool hit = (mask >> i) & 1;
+      assert(hit == info.collided);
+      if (hit) {
+        assert(vec_isclose(axes[i], info.axis));
+        hits++;
+      }
+      body_free(bodies[i]);
+    }
+    if (count < COLLISION_BATCH_MAX) {
+      assert(mask >> count == 0);
+    }
+  }
+  assert(hits > 0);
+  body_free(shape);
+}
+
+bool has_point(contact_manifold_t *manifold, vector_t point) {
+  for (size_t i = 0; i < manifold->point_count; i++) {
+    if (vec_isclose(manifold->points[i], point)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Boxes resting edge to edge touch at both ends of the shared segment,
+// halfway through the overlap, and keep their feature ids as they slide
+void test_box_manifold() {
+  body_t *box1 = make_box_body(VEC_ZERO, 2, 2, 1);
+  body_t *box2 = make_box_body((vector_t){1.5, 0.5}, 2, 2, 1);
+  contact_manifold_t manifold;
+  assert(find_body_manifold(box1, box2, NULL, &manifold).collided);
+  assert(vec_isclose(manifold.normal, (vector_t){1, 0}));
+  assert(isclose(manifold.depth, 0.5));
+  assert(manifold.point_count == 2);
+  assert(has_point(&manifold, (vector_t){0.75, 1}));
+  assert(has_point(&manifold, (vector_t){0.75, -0.5}));
+  assert(manifold.features[0] != manifold.features[1]);
+
+  uint32_t features[] = {manifold.features[0], manifold.features[1]};
+  body_set_centroid(box2, (vector_t){1.5, 0.2});
+  assert(find_body_manifold(box1, box2, NULL, &manifold).collided);
+  assert(manifold.point_count == 2);
+  assert(manifold.features[0] == features[0]);
+  assert(manifold.features[1] == features[1]);
+
+  // Swapping the bodies flips the normal but not the points
+  assert(find_body_manifold(box2, box1, NULL, &manifold).collided);
+  assert(vec_isclose(manifold.normal, (vector_t){-1, 0}));
+  assert(has_point(&manifold, (vector_t){0.75, 1}));
+  assert(has_point(&manifold, (vector_t){0.75, -0.8}));
+
+  body_set_centroid(box2, (vector_t){3, 0});
+  assert(!find_body_manifold(box1, box2, NULL, &manifold).collided);
+  body_free(box1);
+  body_free(box2);
+}
+
+// A box standing on its corner touches at that corner only
+void test_corner_manifold() {
+  body_t *box1 = make_box_body(VEC_ZERO, 2, 2, 1);
+  body_t *box2 = make_box_body((vector_t){0, 1 + sqrt(2) - 0.1}, 2, 2, 1);
+  body_set_rotation(box2, M_PI / 4);
+  contact_manifold_t manifold;
+  assert(find_body_manifold(box1, box2, NULL, &manifold).collided);
+  assert(vec_isclose(manifold.normal, (vector_t){0, 1}));
+  assert(isclose(manifold.depth, 0.1));
+  assert(manifold.point_count == 1);
+  assert(vec_isclose(manifold.points[0], (vector_t){0, 0.95}));
+  assert(find_body_manifold(box1, box2, NULL, NULL).collided);
+  body_free(box1);
+  body_free(box2);
+}
+
+// Circles touch at the point furthest into the other shape
+void test_circle_manifold() {
+  body_t *circle1 =
+      body_init_circle(VEC_ZERO, 2, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_t *circle2 = body_init_circle((vector_t){3, 0}, 2, 1,
+                                     (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_t *box = make_box_body((vector_t){0, 2.5}, 2, 2, 1);
+  contact_manifold_t manifold;
+  assert(find_body_manifold(circle1, circle2, NULL, &manifold).collided);
+  assert(vec_isclose(manifold.normal, (vector_t){1, 0}));
+  assert(isclose(manifold.depth, 1));
+  assert(manifold.point_count == 1);
+  assert(vec_isclose(manifold.points[0], (vector_t){1.5, 0}));
+
+  assert(find_body_manifold(box, circle1, NULL, &manifold).collided);
+  assert(vec_isclose(manifold.normal, (vector_t){0, -1}));
+  assert(isclose(manifold.depth, 0.5));
+  assert(vec_isclose(manifold.points[0], (vector_t){0, 1.75}));
+  body_free(circle1);
+  body_free(circle2);
+  body_free(box);
+}
+
+body_t *make_round_body(vector_t center, size_t sides, double radius) {
+  polygon_t *shape = polygon_init(sides);
+  for (size_t i = 0; i < sides; i++) {
+    double angle = 2 * M_PI * i / sides;
+    polygon_add(shape, vec_add(center, (vector_t){radius * cos(angle),
+                                                  radius * sin(angle)}));
+  }
+  return body_init_from_polygon(shape, 1, (rgb_color_t){0, 0, 0}, NULL, NULL);
+}
+
+// Polygons with many edges go through GJK, which finds the same axis as SAT
+// and leaves a direction for the next test
+void test_complex_body_collision() {
+  body_t *body1 = make_round_body(VEC_ZERO, 20, 2);
+  body_t *body2 = make_round_body((vector_t){3.5, 0.5}, 15, 2);
+  vector_t direction = VEC_ZERO;
+  contact_manifold_t manifold;
+  collision_info_t info =
+      find_body_manifold(body1, body2, &direction, &manifold);
+  collision_info_t expected = find_collision_normals(
+      body_get_shape_view(body1), body_get_normals(body1),
+      body_get_shape_view(body2), body_get_normals(body2));
+  assert(info.collided && expected.collided);
+  assert(vec_isclose(info.axis, expected.axis));
+  assert(manifold.point_count >= 1);
+  assert(vec_dot(direction, (vector_t){3.5, 0.5}) > 0);
+
+  body_set_centroid(body2, (vector_t){6, 1});
+  assert(!find_body_manifold(body1, body2, &direction, &manifold).collided);
+  assert(!find_body_manifold(body1, body2, &direction, &manifold).collided);
+  body_free(body1);
+  body_free(body2);
+}
+
+// A moving body is swept back along its last tick's path to the moment it
+// first touched a thin wall, whatever its shape
+void test_time_of_impact() {
+  body_t *wall = make_box_body((vector_t){20, 0}, 2, 20, 1);
+  body_t *box = make_box_body(VEC_ZERO, 4, 2, 1);
+  body_t *circle = body_init_circle(VEC_ZERO, 1, 1, (rgb_color_t){0, 0, 0},
+                                    NULL, NULL);
+  body_t *target = body_init_circle((vector_t){20, 0}, 2, 1,
+                                    (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_set_velocity(box, (vector_t){100, 0});
+  body_set_velocity(circle, (vector_t){100, 0});
+  body_tick(box, 0.5);
+  body_tick(circle, 0.5);
+  assert(vec_isclose(body_get_motion(box), (vector_t){50, 0}));
+  assert(!find_body_collision(box, wall).collided);
+  assert(isclose(find_body_time_of_impact(box, wall), 0.34));
+  assert(isclose(find_body_time_of_impact(circle, wall), 0.36));
+  assert(isclose(find_body_time_of_impact(circle, target), 0.34));
+
+  body_set_centroid(wall, (vector_t){20, 30});
+  assert(find_body_time_of_impact(box, wall) == INFINITY);
+  assert(find_body_time_of_impact(circle, wall) == INFINITY);
+  body_set_centroid(box, (vector_t){50, 0});
+  assert(vec_isclose(body_get_motion(box), VEC_ZERO));
+  body_free(wall);
+  body_free(box);
+  body_free(circle);
+  body_free(target);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_circle_collision)
+  DO_TEST(test_circle_polygon_collision)
+  DO_TEST(test_body_collision)
+  DO_TEST(test_collision_box_from_body)
+  DO_TEST(test_collision_batch)
+  DO_TEST(test_box_manifold)
+  DO_TEST(test_corner_manifold)
+  DO_TEST(test_circle_manifold)
+  DO_TEST(test_complex_body_collision)
+  DO_TEST(test_time_of_impact)
+
+  puts("collision_test PASS");
+}
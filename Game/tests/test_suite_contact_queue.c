@@ -0,0 +1,43 @@
+#include "contact_queue.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+
+// Bodies move apart along the normal in inverse proportion to their masses,
+// and bodies of infinite mass stay put
+void test_resolve() {
+  contact_queue_t *queue = contact_queue_init();
+  body_t *light = make_box_body(VEC_ZERO, 2, 2, 1);
+  body_t *heavy = make_box_body((vector_t){1.5, 0}, 2, 2, 3);
+  body_t *wall = make_box_body((vector_t){0, -1.5}, 2, 2, INFINITY);
+  contact_manifold_t manifold = {.normal = {1, 0}, .depth = 0.4};
+  contact_queue_add(queue, light, heavy, &manifold);
+  manifold = (contact_manifold_t){.normal = {0, 1}, .depth = 0.5};
+  contact_queue_add(queue, wall, light, &manifold);
+  contact_queue_resolve(queue);
+  assert(vec_isclose(body_get_centroid(light), (vector_t){-0.3, 0.5}));
+  assert(vec_isclose(body_get_centroid(heavy), (vector_t){1.6, 0}));
+  assert(vec_isclose(body_get_centroid(wall), (vector_t){0, -1.5}));
+
+  // Resolving empties the queue
+  contact_queue_resolve(queue);
+  assert(vec_isclose(body_get_centroid(heavy), (vector_t){1.6, 0}));
+  body_free(light);
+  body_free(heavy);
+  body_free(wall);
+  contact_queue_free(queue);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_resolve)
+
+  puts("contact_queue_test PASS");
+}
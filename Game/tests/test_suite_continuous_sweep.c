@@ -0,0 +1,57 @@
+#include "continuous_sweep.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+
+body_t *make_bullet(size_t index, vector_t start, bool continuous) {
+  body_t *bullet = body_init_circle(start, 3, 1, (rgb_color_t){0, 0, 0},
+                                    NULL, NULL);
+  body_set_handle(bullet, (body_handle_t){.index = index, .generation = 1});
+  body_set_continuous(bullet, continuous);
+  body_set_velocity(bullet, (vector_t){1000, 0});
+  body_tick(bullet, 0.05);
+  return bullet;
+}
+
+// A continuous bullet that moved through a thin wall is moved back to just
+// past where it first touched it, and other bodies are left where they are
+void test_moves_back_to_impact() {
+  continuous_sweep_t *sweep = continuous_sweep_init();
+  body_t *wall = make_box_body((vector_t){25, 0}, 4, 100, INFINITY);
+  body_set_handle(wall, (body_handle_t){.index = 0, .generation = 1});
+  body_t *bullets[] = {make_bullet(40, VEC_ZERO, true),
+                       make_bullet(1, (vector_t){0, 10}, false),
+                       make_bullet(2, (vector_t){0, 100}, true)};
+  body_pair_t pairs[3];
+  for (size_t i = 0; i < 3; i++) {
+    pairs[i] = (body_pair_t){.body1 = wall, .body2 = bullets[i]};
+  }
+  continuous_sweep_run(sweep, (body_pair_view_t){.pairs = pairs, .size = 3});
+  assert(within(1e-6, body_get_centroid(bullets[0]).x, 20 + 1e-3));
+  assert(isclose(body_get_centroid(bullets[1]).x, 50));
+  assert(isclose(body_get_centroid(bullets[2]).x, 50));
+  assert(vec_isclose(body_get_centroid(wall), (vector_t){25, 0}));
+
+  // Each run starts over
+  continuous_sweep_run(sweep, (body_pair_view_t){.pairs = pairs, .size = 0});
+  assert(within(1e-6, body_get_centroid(bullets[0]).x, 20 + 1e-3));
+  for (size_t i = 0; i < 3; i++) {
+    body_free(bullets[i]);
+  }
+  body_free(wall);
+  continuous_sweep_free(sweep);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_moves_back_to_impact)
+
+  puts("continuous_sweep_test PASS");
+}
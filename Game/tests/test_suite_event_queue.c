@@ -0,0 +1,62 @@
+#include "event_queue.h"
+#include "test_util.h"
+#include <assert.h>
+#include <string.h>
+
+typedef struct {
+  event_queue_t *queue;
+  char order[32];
+  size_t count;
+} event_log_t;
+
+void log_a(body_t *body1, body_t *body2, vector_t axis, event_log_t *log) {
+  log->order[log->count++] = 'a';
+}
+
+void log_b(body_t *body1, body_t *body2, vector_t axis, event_log_t *log) {
+  log->order[log->count++] = 'b';
+}
+
+void log_c_and_queue_b(body_t *body1, body_t *body2, vector_t axis,
+                       event_log_t *log) {
+  log->order[log->count++] = 'c';
+  for (size_t i = 0; i < 10; i++) {
+    event_queue_add(log->queue, (event_handler_t)log_b, body1, body2, axis,
+                    log);
+  }
+}
+
+// Events run batched by handler, in the order the handlers were first
+// queued, and events queued by handlers run in a further round, even when
+// queueing them moves the queue
+void test_dispatch() {
+  event_log_t log = {.queue = event_queue_init(), .count = 0};
+  event_handler_t handlers[] = {
+      (event_handler_t)log_a, (event_handler_t)log_c_and_queue_b,
+      (event_handler_t)log_b, (event_handler_t)log_a};
+  for (size_t i = 0; i < sizeof(handlers) / sizeof(*handlers); i++) {
+    event_queue_add(log.queue, handlers[i], NULL, NULL, VEC_ZERO, &log);
+  }
+  event_queue_dispatch(log.queue);
+  log.order[log.count] = '\0';
+  assert(strcmp(log.order, "aacbbbbbbbbbbb") == 0);
+
+  // Dispatching empties the queue
+  event_queue_dispatch(log.queue);
+  assert(log.count == 14);
+  event_queue_free(log.queue);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_dispatch)
+
+  puts("event_queue_test PASS");
+}
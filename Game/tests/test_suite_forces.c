@@ -4,23 +4,6 @@
 #include <math.h>
 #include <stdlib.h>
 
-list_t *make_shape() {
-  list_t *shape = list_init(4, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){-1, -1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, -1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, +1};
-  list_add(shape, v);
-  return shape;
-}
-
 // Tests that a mass on a spring oscillates like A cos(sqrt(K / M) * t)
 void test_spring_sinusoid() {
   const double M = 10;
@@ -150,6 +133,134 @@ void test_forces_removed() {
   scene_free(scene);
 }
 
+void count_collision(body_t *body1, body_t *body2, vector_t axis,
+                     size_t *count) {
+  (*count)++;
+}
+
+// A layer collision's handler runs once each time a pair starts touching,
+// and the scene sees the pair separate even after it leaves the broadphase
+void test_layer_collision_states() {
+  scene_t *scene = scene_init();
+  body_t *body1 = make_triangle_body();
+  body_t *body2 = make_triangle_body();
+  body_set_collision_layer(body1, 1);
+  body_set_collision_layer(body2, 2);
+  body_set_centroid(body2, (vector_t){0.5, 0});
+  scene_add_body(scene, body1);
+  scene_add_body(scene, body2);
+  size_t *count = malloc(sizeof(size_t));
+  *count = 0;
+  create_layer_collision(scene, 1, 2, (collision_handler_t)count_collision,
+                         count, free);
+
+  for (int i = 0; i < 3; i++) {
+    scene_tick(scene, 0.1);
+    assert(*count == 1);
+    assert(pair_entry_get_state(scene_get_pair(scene, body1, body2)) ==
+           (i == 0 ? PAIR_ENTER : PAIR_STAY));
+  }
+  body_set_centroid(body2, (vector_t){100, 0});
+  scene_tick(scene, 0.1);
+  assert(pair_entry_get_state(scene_get_pair(scene, body1, body2)) ==
+         PAIR_EXIT);
+  body_set_centroid(body2, (vector_t){0.5, 0});
+  scene_tick(scene, 0.1);
+  assert(*count == 2);
+  scene_free(scene);
+}
+
+// A bullet moving 50 units a tick hits a 4 unit wall if it is continuous,
+// and stops where it first touched it, but passes through it otherwise
+void test_continuous_collision() {
+  scene_t *scene = scene_init();
+  body_t *wall = make_box_body((vector_t){125, 0}, 4, 100, INFINITY);
+  body_set_collision_layer(wall, 2);
+  scene_add_body(scene, wall);
+  body_t *bullets[2];
+  for (size_t i = 0; i < 2; i++) {
+    bullets[i] = body_init_circle((vector_t){0, 20.0 * i}, 3, 1,
+                                  (rgb_color_t){0, 0, 0}, NULL, NULL);
+    body_set_velocity(bullets[i], (vector_t){1000, 0});
+    body_set_collision_layer(bullets[i], 1);
+    scene_add_body(scene, bullets[i]);
+  }
+  body_set_continuous(bullets[0], true);
+  size_t *count = malloc(sizeof(size_t));
+  *count = 0;
+  create_layer_collision(scene, 1, 2, (collision_handler_t)count_collision,
+                         count, free);
+
+  for (int i = 0; i < 4; i++) {
+    scene_tick(scene, 0.05);
+  }
+  // The last tick found the hit, then moved the bullet on from there
+  assert(*count == 1);
+  assert(isclose(body_get_centroid(bullets[0]).x, 120 + 50));
+  assert(isclose(body_get_centroid(bullets[1]).x, 200));
+  scene_free(scene);
+}
+
+// A long bar across dozens of boxes whose bounding boxes all overlap its own
+// only touches the boxes along its length, however many there are
+void test_batched_layer_collisions() {
+  scene_t *scene = scene_init();
+  body_t *bar = make_box_body(VEC_ZERO, 100, 2, INFINITY);
+  body_set_rotation(bar, M_PI / 4);
+  body_set_collision_layer(bar, 1);
+  scene_add_body(scene, bar);
+  body_t *on_bar[29];
+  body_t *off_bar[29];
+  for (size_t i = 0; i < 29; i++) {
+    double t = -28 + 2.0 * i;
+    on_bar[i] = make_box_body((vector_t){t, t}, 2, 2, INFINITY);
+    off_bar[i] = make_box_body((vector_t){t + 6, t - 6}, 2, 2, INFINITY);
+    body_set_collision_layer(on_bar[i], 2);
+    body_set_collision_layer(off_bar[i], 2);
+    scene_add_body(scene, on_bar[i]);
+    scene_add_body(scene, off_bar[i]);
+  }
+  size_t *count = malloc(sizeof(size_t));
+  *count = 0;
+  create_layer_collision(scene, 1, 2, (collision_handler_t)count_collision,
+                         count, free);
+
+  scene_tick(scene, 0.01);
+  assert(*count == 29);
+  for (size_t i = 0; i < 29; i++) {
+    assert(pair_entry_get_state(scene_get_pair(scene, bar, on_bar[i])) ==
+           PAIR_ENTER);
+    assert(pair_entry_get_state(scene_get_pair(scene, bar, off_bar[i])) ==
+           PAIR_APART);
+  }
+  scene_free(scene);
+}
+
+// A body squeezed between two walls is pushed out of both by how far it
+// overlapped each before either moved it, whichever pair is tested first
+void test_contacts_resolved_after_detection() {
+  scene_t *scene = scene_init();
+  body_t *walls[2];
+  for (size_t i = 0; i < 2; i++) {
+    walls[i] =
+        make_box_body((vector_t){i == 0 ? -1.5 : 1.5, 0}, 2, 2, INFINITY);
+    body_set_collision_layer(walls[i], 2);
+    scene_add_body(scene, walls[i]);
+  }
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_collision_layer(body, 1);
+  scene_add_body(scene, body);
+  size_t *count = malloc(sizeof(size_t));
+  *count = 0;
+  create_layer_collision(scene, 1, 2, (collision_handler_t)count_collision,
+                         count, free);
+
+  scene_tick(scene, 0.01);
+  assert(*count == 2);
+  assert(vec_isclose(body_get_centroid(body), VEC_ZERO));
+  scene_free(scene);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -163,6 +274,10 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_energy_conservation)
   DO_TEST(test_collisions)
   DO_TEST(test_forces_removed)
+  DO_TEST(test_layer_collision_states)
+  DO_TEST(test_continuous_collision)
+  DO_TEST(test_batched_layer_collisions)
+  DO_TEST(test_contacts_resolved_after_detection)
 
   puts("forces_test PASS");
 }
@@ -0,0 +1,143 @@
+#include "gjk.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define MAX_VERTICES 24
+
+// A regular polygon, stretched and turned so that its edges are uneven
+size_t make_oval(vector_t *vertices, size_t sides, vector_t center,
+                 double radius, double angle) {
+  for (size_t i = 0; i < sides; i++) {
+    double theta = 2 * M_PI * i / sides;
+    vector_t point = {radius * cos(theta), radius * sin(theta) / 2};
+    vertices[i] = vec_add(center, vec_rotate(point, angle));
+  }
+  return sides;
+}
+
+// The shortest separation along any edge normal of either shape, which for
+// convex polygons is the true penetration
+bool brute_force_axis(polygon_view_t shape1, polygon_view_t shape2,
+                      vector_t *axis) {
+  double best = INFINITY;
+  polygon_view_t shapes[] = {shape1, shape2};
+  for (size_t s = 0; s < 2; s++) {
+    polygon_view_t shape = shapes[s];
+    for (size_t i = 0; i < shape.size; i++) {
+      vector_t edge = vec_subtract(shape.vertices[(i + 1) % shape.size],
+                                   shape.vertices[i]);
+      double length = sqrt(vec_dot(edge, edge));
+      vector_t normal = vec_multiply(1 / length, (vector_t){-edge.y, edge.x});
+      double min1 = INFINITY, max1 = -INFINITY;
+      double min2 = INFINITY, max2 = -INFINITY;
+      for (size_t j = 0; j < shape1.size; j++) {
+        double dot = vec_dot(normal, shape1.vertices[j]);
+        min1 = fmin(min1, dot);
+        max1 = fmax(max1, dot);
+      }
+      for (size_t j = 0; j < shape2.size; j++) {
+        double dot = vec_dot(normal, shape2.vertices[j]);
+        min2 = fmin(min2, dot);
+        max2 = fmax(max2, dot);
+      }
+      double forward = max1 - min2;
+      double backward = max2 - min1;
+      if (forward < 0 || backward < 0) {
+        return false;
+      }
+      if (fmin(forward, backward) < best) {
+        best = fmin(forward, backward);
+        *axis = vec_multiply(forward <= backward ? best : -best, normal);
+      }
+    }
+  }
+  return true;
+}
+
+// GJK agrees with testing every axis, and EPA finds the same axis
+void test_matches_brute_force() {
+  srand(11);
+  vector_t vertices1[MAX_VERTICES];
+  vector_t vertices2[MAX_VERTICES];
+  size_t hits = 0;
+  for (size_t i = 0; i < 500; i++) {
+    polygon_view_t shape1 = {
+        .vertices = vertices1,
+        .size = make_oval(vertices1, 3 + rand() % 18, VEC_ZERO,
+                          random_between(1, 4), random_between(0, M_PI))};
+    vector_t center = {random_between(-6, 6), random_between(-4, 4)};
+    polygon_view_t shape2 = {
+        .vertices = vertices2,
+        .size = make_oval(vertices2, 3 + rand() % 18, center,
+                          random_between(1, 4), random_between(0, M_PI))};
+    vector_t expected;
+    bool collided = brute_force_axis(shape1, shape2, &expected);
+    vector_t axis;
+    assert(gjk_find_collision(shape1, shape2, NULL, &axis) == collided);
+    if (collided) {
+      assert(vec_isclose(axis, expected));
+      hits++;
+    }
+  }
+  assert(hits > 50);
+}
+
+// A direction kept from a test that found the shapes apart separates them,
+// and one kept from a collision points along its axis
+void test_cached_direction() {
+  vector_t vertices1[MAX_VERTICES];
+  vector_t vertices2[MAX_VERTICES];
+  polygon_view_t shape1 = {
+      .vertices = vertices1,
+      .size = make_oval(vertices1, 20, VEC_ZERO, 2, 0.3)};
+  polygon_view_t shape2 = {
+      .vertices = vertices2,
+      .size = make_oval(vertices2, 20, (vector_t){5, 1}, 2, 0.1)};
+  vector_t direction = VEC_ZERO;
+  vector_t axis;
+  assert(!gjk_find_collision(shape1, shape2, &direction, &axis));
+  double max1 = -INFINITY;
+  double min2 = INFINITY;
+  for (size_t i = 0; i < 20; i++) {
+    max1 = fmax(max1, vec_dot(direction, vertices1[i]));
+    min2 = fmin(min2, vec_dot(direction, vertices2[i]));
+  }
+  assert(max1 < min2);
+  assert(!gjk_find_collision(shape1, shape2, &direction, &axis));
+
+  make_oval(vertices2, 20, (vector_t){2, 0}, 2, 0.1);
+  assert(gjk_find_collision(shape1, shape2, &direction, &axis));
+  assert(vec_isclose(direction, axis));
+  assert(axis.x > 0);
+}
+
+// Concentric shapes, where every support point passes through the origin,
+// still get a penetration axis
+void test_concentric() {
+  vector_t square1[] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+  vector_t square2[] = {{-2, -1}, {2, -1}, {2, 1}, {-2, 1}};
+  polygon_view_t shape1 = {.vertices = square1, .size = 4};
+  polygon_view_t shape2 = {.vertices = square2, .size = 4};
+  vector_t axis;
+  assert(gjk_find_collision(shape1, shape2, NULL, &axis));
+  assert(isclose(sqrt(vec_dot(axis, axis)), 2));
+  assert(isclose(axis.x, 0));
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_matches_brute_force)
+  DO_TEST(test_cached_direction)
+  DO_TEST(test_concentric)
+
+  puts("gjk_test PASS");
+}
@@ -0,0 +1,71 @@
+#include "layer_batch.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+
+#define BOXES 12
+
+body_t *add_box(body_pair_t *pair, body_t *bar, size_t index,
+                vector_t center) {
+  body_t *box = make_box_body(center, 2, 2, 1);
+  body_set_handle(box, (body_handle_t){.index = index, .generation = 1});
+  *pair = (body_pair_t){.body1 = bar, .body2 = box};
+  return box;
+}
+
+// A bar paired with more rectangles than fit in one batch marks only the
+// ones it misses as checked and apart, and a lone pair is left alone
+void test_marks_misses() {
+  layer_batch_t *batch = layer_batch_init();
+  pair_cache_t *cache = pair_cache_init();
+  body_t *bar = make_box_body(VEC_ZERO, 100, 2, 1);
+  body_set_rotation(bar, M_PI / 4);
+  body_set_handle(bar, (body_handle_t){.index = 0, .generation = 1});
+  body_pair_t pairs[BOXES + 1];
+  body_t *boxes[BOXES + 1];
+  for (size_t i = 0; i < BOXES; i++) {
+    double t = -20 + 4.0 * i;
+    vector_t center = i % 2 == 0 ? (vector_t){t, t} : (vector_t){t + 6, t - 6};
+    boxes[i] = add_box(&pairs[i], bar, 30 + i, center);
+  }
+  // A circle cannot be batched, so the lone box it is paired with is not
+  body_t *circle = body_init_circle((vector_t){100, 100}, 1, 1,
+                                    (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_set_handle(circle, (body_handle_t){.index = 1, .generation = 1});
+  boxes[BOXES] = add_box(&pairs[BOXES], circle, 2, (vector_t){200, 0});
+
+  layer_batch_run(batch, (body_pair_view_t){.pairs = pairs, .size = BOXES + 1},
+                  cache, 1);
+  for (size_t i = 0; i < BOXES; i++) {
+    pair_entry_t *entry = pair_cache_find(cache, body_get_handle(bar),
+                                          body_get_handle(boxes[i]));
+    if (i % 2 == 0) {
+      assert(entry == NULL);
+    } else {
+      assert(entry != NULL && entry->checked && !entry->touching);
+    }
+  }
+  assert(pair_cache_size(cache) == BOXES / 2);
+
+  for (size_t i = 0; i <= BOXES; i++) {
+    body_free(boxes[i]);
+  }
+  body_free(bar);
+  body_free(circle);
+  pair_cache_free(cache);
+  layer_batch_free(batch);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_marks_misses)
+
+  puts("layer_batch_test PASS");
+}
@@ -0,0 +1,82 @@
+#include "layer_table.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+body_t *make_layer_body(size_t layer) {
+  body_t *body = make_box_body(VEC_ZERO, 2, 2, 1);
+  body_set_collision_layer(body, layer);
+  return body;
+}
+
+typedef struct {
+  body_t *firsts[4];
+  size_t count;
+} call_log_t;
+
+void log_first(body_t *body1, body_t *body2, call_log_t *log) {
+  log->firsts[log->count++] = body1;
+}
+
+// Masks pair layers both ways, and only the layers that were added
+void test_masks() {
+  layer_table_t *table = layer_table_init();
+  layer_table_add_force(table, 1, 3, (layer_force_creator_t)log_first, NULL,
+                        NULL);
+  assert(layer_table_has_layer(table, 1));
+  assert(layer_table_has_layer(table, 3));
+  assert(!layer_table_has_layer(table, 2));
+  body_t *body1 = make_layer_body(1);
+  body_t *body2 = make_layer_body(2);
+  body_t *body3 = make_layer_body(3);
+  assert(layer_table_pairs_bodies(table, body1, body3));
+  assert(layer_table_pairs_bodies(table, body3, body1));
+  assert(!layer_table_pairs_bodies(table, body1, body2));
+  assert(!layer_table_pairs_bodies(table, body1, body1));
+  body_free(body1);
+  body_free(body2);
+  body_free(body3);
+  layer_table_free(table);
+}
+
+// Force creators see the body on their first layer first, whichever order
+// the pair was added in, and pairs are dropped when cleared
+void test_run() {
+  layer_table_t *table = layer_table_init();
+  call_log_t *log = malloc(sizeof(call_log_t));
+  log->count = 0;
+  layer_table_add_force(table, 1, 2, (layer_force_creator_t)log_first, log,
+                        free);
+  body_t *body1 = make_layer_body(1);
+  body_t *body2 = make_layer_body(2);
+  layer_table_add_pair(table, body1, body2);
+  layer_table_add_pair(table, body2, body1);
+  assert(layer_table_get_pairs(table).size == 2);
+  assert(layer_table_get_pairs(table).pairs[1].body1 == body2);
+  layer_table_run(table);
+  assert(log->count == 2);
+  assert(log->firsts[0] == body1 && log->firsts[1] == body1);
+
+  layer_table_clear_pairs(table);
+  assert(layer_table_get_pairs(table).size == 0);
+  layer_table_run(table);
+  assert(log->count == 2);
+  body_free(body1);
+  body_free(body2);
+  layer_table_free(table);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_masks)
+  DO_TEST(test_run)
+
+  puts("layer_table_test PASS");
+}
@@ -0,0 +1,141 @@
+#include "pair_cache.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define PAIRS 500
+
+body_handle_t make_handle(size_t index) {
+  return (body_handle_t){.index = index, .generation = 1 + index % 3};
+}
+
+void count_entry(pair_entry_t *entry, size_t *count) { (*count)++; }
+
+// Pairs are found in either order, and only once
+void test_insert_and_find() {
+  pair_cache_t *cache = pair_cache_init();
+  for (size_t i = 0; i < PAIRS; i++) {
+    pair_entry_t *entry =
+        pair_cache_visit(cache, make_handle(i), make_handle(i + 7), 1);
+    assert(entry->handle1.index == i);
+    assert(pair_entry_get_state(entry) == PAIR_APART);
+  }
+  assert(pair_cache_size(cache) == PAIRS);
+  for (size_t i = 0; i < PAIRS; i++) {
+    pair_entry_t *entry =
+        pair_cache_find(cache, make_handle(i + 7), make_handle(i));
+    assert(entry != NULL);
+    assert(entry->handle1.index == i);
+    assert(pair_cache_visit(cache, make_handle(i + 7), make_handle(i), 1) ==
+           entry);
+  }
+  assert(pair_cache_size(cache) == PAIRS);
+  assert(pair_cache_find(cache, make_handle(0), make_handle(1)) == NULL);
+  // A handle to a slot's next body is a different pair
+  body_handle_t reused = {.index = 7, .generation = 5};
+  assert(pair_cache_find(cache, make_handle(0), reused) == NULL);
+
+  size_t count = 0;
+  pair_cache_for_each(cache, (pair_visitor_t)count_entry, &count);
+  assert(count == PAIRS);
+  pair_cache_free(cache);
+}
+
+// Pairs enter, stay and exit as their touching state changes from tick to
+// tick, and a pair skipping a tick starts over
+void test_states() {
+  pair_cache_t *cache = pair_cache_init();
+  body_handle_t handle1 = make_handle(1);
+  body_handle_t handle2 = make_handle(2);
+  pair_entry_t *entry = pair_cache_visit(cache, handle1, handle2, 1);
+  entry->touching = true;
+  entry->checked = true;
+  assert(pair_entry_get_state(entry) == PAIR_ENTER);
+
+  entry = pair_cache_visit(cache, handle1, handle2, 2);
+  assert(!entry->checked);
+  entry->touching = true;
+  assert(pair_entry_get_state(entry) == PAIR_STAY);
+
+  entry = pair_cache_visit(cache, handle2, handle1, 3);
+  assert(pair_entry_get_state(entry) == PAIR_EXIT);
+  entry = pair_cache_visit(cache, handle1, handle2, 4);
+  entry->touching = true;
+  assert(pair_entry_get_state(entry) == PAIR_ENTER);
+
+  entry = pair_cache_visit(cache, handle1, handle2, 6);
+  entry->touching = true;
+  assert(pair_entry_get_state(entry) == PAIR_ENTER);
+  pair_cache_free(cache);
+}
+
+// Only pairs visited on the current tick survive, and they keep their data
+void test_remove_stale() {
+  pair_cache_t *cache = pair_cache_init();
+  for (size_t i = 0; i < PAIRS; i++) {
+    pair_entry_t *entry =
+        pair_cache_visit(cache, make_handle(i), make_handle(i + 1), 1);
+    entry->direction = (vector_t){i, 0};
+  }
+  for (size_t i = 0; i < PAIRS; i += 2) {
+    pair_cache_visit(cache, make_handle(i), make_handle(i + 1), 2);
+  }
+  pair_cache_remove_stale(cache, 2);
+  assert(pair_cache_size(cache) == PAIRS / 2);
+  for (size_t i = 0; i < PAIRS; i++) {
+    pair_entry_t *entry =
+        pair_cache_find(cache, make_handle(i), make_handle(i + 1));
+    if (i % 2 == 0) {
+      assert(entry != NULL);
+      assert(vec_isclose(entry->direction, (vector_t){i, 0}));
+    } else {
+      assert(entry == NULL);
+    }
+  }
+  pair_cache_remove_stale(cache, 3);
+  assert(pair_cache_size(cache) == 0);
+  pair_cache_free(cache);
+}
+
+void touch_entry(pair_entry_t *entry, pair_cache_t *cache) {
+  pair_cache_touch(cache, entry, 2);
+}
+
+// Touching entries while iterating brings each one up to the tick in place,
+// just like visiting it would
+void test_touch() {
+  pair_cache_t *cache = pair_cache_init();
+  for (size_t i = 0; i < PAIRS; i++) {
+    pair_entry_t *entry =
+        pair_cache_visit(cache, make_handle(i), make_handle(i + 7), 1);
+    entry->checked = true;
+    entry->touching = i % 2 == 0;
+  }
+  pair_cache_for_each(cache, (pair_visitor_t)touch_entry, cache);
+  assert(pair_cache_size(cache) == PAIRS);
+  for (size_t i = 0; i < PAIRS; i++) {
+    pair_entry_t *entry =
+        pair_cache_find(cache, make_handle(i), make_handle(i + 7));
+    assert(entry->tick == 2);
+    assert(!entry->checked && !entry->touching);
+    assert(entry->was_touching == (i % 2 == 0));
+  }
+  pair_cache_free(cache);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_insert_and_find)
+  DO_TEST(test_states)
+  DO_TEST(test_remove_stale)
+  DO_TEST(test_touch)
+
+  puts("pair_cache_test PASS");
+}
@@ -222,6 +222,48 @@ void test_weird_rotate() {
   list_free(w);
 }
 
+// The contiguous polygon_t should agree with the list-based functions
+void test_polygon_matches_list() {
+  list_t *w = make_weird();
+  polygon_t *p = polygon_from_list(w);
+  assert(polygon_size(p) == list_size(w));
+  assert(isclose(polygon_get_area(p), polygon_area(w)));
+  assert(vec_isclose(polygon_get_centroid(p), polygon_centroid(w)));
+
+  polygon_rotate(w, M_PI / 2, (vector_t){0, 2});
+  polygon_rotate_vertices(p, M_PI / 2, (vector_t){0, 2});
+  polygon_translate(w, (vector_t){3, -4});
+  polygon_translate_vertices(p, (vector_t){3, -4});
+  for (size_t i = 0; i < polygon_size(p); i++) {
+    assert(vec_isclose(polygon_vertices(p)[i], *void_pointer_to_vector(w, i)));
+  }
+
+  list_t *copy = polygon_to_list(p);
+  assert(list_size(copy) == polygon_size(p));
+  assert(vec_equal(*void_pointer_to_vector(copy, 2), polygon_get(p, 2)));
+  list_free(copy);
+  polygon_free(p);
+  list_free(w);
+}
+
+// Polygons must keep their vertices when they outgrow the inline buffer
+void test_polygon_growth() {
+  polygon_t *p = polygon_init(0);
+  for (size_t i = 0; i < 3 * POLYGON_INLINE_CAPACITY; i++) {
+    polygon_add(p, (vector_t){i, -(double)i});
+  }
+  assert(polygon_size(p) == 3 * POLYGON_INLINE_CAPACITY);
+  for (size_t i = 0; i < polygon_size(p); i++) {
+    assert(vec_equal(polygon_get(p, i), (vector_t){i, -(double)i}));
+  }
+  polygon_t *copy = polygon_copy(p);
+  assert(polygon_size(copy) == polygon_size(p));
+  assert(polygon_vertices(copy) != polygon_vertices(p));
+  assert(vec_equal(polygon_get(copy, 17), polygon_get(p, 17)));
+  polygon_free(copy);
+  polygon_free(p);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests? True if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -243,6 +285,8 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_weird_area_centroid)
   DO_TEST(test_weird_translate)
   DO_TEST(test_weird_rotate)
+  DO_TEST(test_polygon_matches_list)
+  DO_TEST(test_polygon_growth)
 
   puts("polygon_test PASS");
 }
@@ -0,0 +1,129 @@
+#include "forces.h"
+#include "pool.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct {
+  double x;
+  double y;
+  double z;
+} small_object_t;
+
+typedef struct {
+  char bytes[100];
+} large_object_t;
+
+// Objects are reused in LIFO order and never straddle a cache line
+void test_alloc_release() {
+  pool_t *pool = pool_init(sizeof(small_object_t), 8);
+  small_object_t *objects[8];
+  for (size_t i = 0; i < 8; i++) {
+    objects[i] = pool_alloc(pool);
+    uintptr_t start = (uintptr_t)objects[i];
+    uintptr_t end = start + sizeof(small_object_t) - 1;
+    assert(start / POOL_CACHE_LINE == end / POOL_CACHE_LINE);
+    for (size_t j = 0; j < i; j++) {
+      assert(objects[i] != objects[j]);
+    }
+  }
+  pool_release(pool, objects[3]);
+  assert(pool_alloc(pool) == objects[3]);
+  for (size_t i = 0; i < 8; i++) {
+    pool_release(pool, objects[i]);
+  }
+  pool_free(pool);
+}
+
+void test_large_objects() {
+  pool_t *pool = pool_init(sizeof(large_object_t), 3);
+  large_object_t *first = pool_alloc(pool);
+  large_object_t *second = pool_alloc(pool);
+  assert((uintptr_t)first % POOL_CACHE_LINE == 0);
+  assert((uintptr_t)second % POOL_CACHE_LINE == 0);
+  first->bytes[99] = 1;
+  second->bytes[0] = 2;
+  assert(first->bytes[99] == 1);
+  pool_release(pool, first);
+  pool_release(pool, second);
+  pool_free(pool);
+}
+
+void test_stats() {
+  pool_t *pool = pool_init(sizeof(int), 4);
+  pool_stats_t stats = pool_get_stats(pool);
+  assert(stats.live == 0 && stats.peak == 0);
+  assert(stats.capacity == 0 && stats.slabs == 0);
+
+  int *objects[6];
+  for (size_t i = 0; i < 6; i++) {
+    objects[i] = pool_alloc(pool);
+  }
+  stats = pool_get_stats(pool);
+  assert(stats.live == 6 && stats.peak == 6);
+  assert(stats.capacity == 8 && stats.slabs == 2);
+
+  for (size_t i = 0; i < 6; i++) {
+    pool_release(pool, objects[i]);
+  }
+  objects[0] = pool_alloc(pool);
+  stats = pool_get_stats(pool);
+  assert(stats.live == 1 && stats.peak == 6);
+  assert(stats.capacity == 8 && stats.slabs == 2);
+  pool_release(pool, objects[0]);
+  pool_free(pool);
+}
+
+// Spawns a short-lived body with the forces a bullet gets
+void spawn_bullet(scene_t *scene, body_t *target) {
+  body_t *bullet = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, bullet);
+  create_drag(scene, 1, bullet);
+  create_physics_collision(scene, 1, target, bullet);
+  create_solo_destructive_collision(scene, target, bullet);
+  body_remove(bullet);
+}
+
+// Once the pools have grown, creating and removing bodies and forces
+// reuses their objects instead of growing the pools
+void test_steady_state() {
+  scene_t *scene = scene_init();
+  body_t *target = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, target);
+  spawn_bullet(scene, target);
+  scene_tick(scene, 0);
+
+  pool_stats_t bodies = body_get_pool_stats();
+  pool_stats_t forces = scene_get_force_pool_stats();
+  pool_stats_t auxes = forces_get_aux_pool_stats();
+  for (int i = 0; i < 1000; i++) {
+    spawn_bullet(scene, target);
+    scene_tick(scene, 0);
+  }
+  assert(body_get_pool_stats().capacity == bodies.capacity);
+  assert(body_get_pool_stats().live == bodies.live);
+  assert(scene_get_force_pool_stats().capacity == forces.capacity);
+  assert(scene_get_force_pool_stats().live == forces.live);
+  assert(forces_get_aux_pool_stats().capacity == auxes.capacity);
+  assert(forces_get_aux_pool_stats().live == auxes.live);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_alloc_release)
+  DO_TEST(test_large_objects)
+  DO_TEST(test_stats)
+  DO_TEST(test_steady_state)
+
+  puts("pool_test PASS");
+}
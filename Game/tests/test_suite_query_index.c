@@ -0,0 +1,111 @@
+#include "query_index.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+
+/**
+ * A static wall the lookup reports until it is gone.
+ */
+typedef struct wall {
+  body_t *body;
+  bool gone;
+} wall_t;
+
+body_t *lookup_wall(size_t id, wall_t *wall) {
+  assert(id == 0);
+  return wall->gone ? NULL : wall->body;
+}
+
+body_t *make_indexed_box(vector_t center, size_t index, size_t layer) {
+  body_t *box = make_box_body(center, 2, 2, 1);
+  body_set_handle(box, (body_handle_t){.index = index, .generation = 1});
+  body_set_collision_layer(box, layer);
+  return box;
+}
+
+void count_visit(body_t *body, size_t *count) { (*count)++; }
+
+// Segment and region queries find moving bodies through the index and
+// static bodies through the tree, on either broadphase
+void test_finds_moving_and_static(broadphase_t broadphase) {
+  query_index_t *index = query_index_init(broadphase);
+  wall_t wall = {.body = make_box_body((vector_t){50, 0}, 4, 100, INFINITY),
+                 .gone = false};
+  bvh_t *tree = bvh_init();
+  bvh_insert(tree, 0, body_get_aabb(wall.body));
+  bvh_build(tree);
+  query_index_set_statics(index, tree, (static_lookup_t)lookup_wall, &wall);
+  body_t *near = make_indexed_box((vector_t){20, 0}, 7, 1);
+  body_t *far = make_indexed_box((vector_t){80, 0}, 3, 0);
+  assert(query_index_is_stale(index));
+  query_index_clear(index);
+  query_index_insert(index, near);
+  query_index_insert(index, far);
+  query_index_commit(index);
+  assert(!query_index_is_stale(index));
+
+  ray_hit_t hit;
+  assert(query_index_segment(index, VEC_ZERO, (vector_t){100, 0}, UINT32_MAX,
+                             &hit));
+  assert(hit.body == near);
+  assert(isclose(hit.distance, 19));
+  assert(query_index_segment(index, VEC_ZERO, (vector_t){100, 0}, 1, &hit));
+  assert(hit.body == wall.body);
+  assert(isclose(hit.distance, 48));
+
+  size_t count = 0;
+  aabb_t box = {.min = {10, -40}, .max = {90, 40}};
+  assert(query_index_region(index, box, (vector_t){50, 0}, 40, UINT32_MAX,
+                            (body_visitor_t)count_visit, &count) == 3);
+  assert(count == 3);
+  box = (aabb_t){.min = {30, -20}, .max = {70, 20}};
+  assert(query_index_region(index, box, (vector_t){50, 0}, 20, UINT32_MAX,
+                            (body_visitor_t)count_visit, &count) == 1);
+
+  // Gone and removed bodies are skipped
+  wall.gone = true;
+  body_remove(near);
+  assert(!query_index_segment(index, VEC_ZERO, (vector_t){70, 0}, UINT32_MAX,
+                              &hit));
+  assert(hit.body == NULL);
+  assert(hit.distance == INFINITY);
+  box = (aabb_t){.min = {0, -50}, .max = {100, 50}};
+  assert(query_index_region(index, box, VEC_ZERO, 0, UINT32_MAX,
+                            (body_visitor_t)count_visit, &count) == 1);
+
+  // A refill drops the bodies not inserted again
+  query_index_mark_stale(index);
+  assert(query_index_is_stale(index));
+  query_index_clear(index);
+  query_index_insert(index, near);
+  query_index_commit(index);
+  assert(query_index_region(index, box, VEC_ZERO, 0, UINT32_MAX,
+                            (body_visitor_t)count_visit, &count) == 0);
+
+  query_index_free(index);
+  bvh_free(tree);
+  body_free(near);
+  body_free(far);
+  body_free(wall.body);
+}
+
+void test_grid() { test_finds_moving_and_static(BROADPHASE_GRID); }
+
+void test_sweep_and_prune() {
+  test_finds_moving_and_static(BROADPHASE_SWEEP_AND_PRUNE);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_grid)
+  DO_TEST(test_sweep_and_prune)
+
+  puts("query_index_test PASS");
+}
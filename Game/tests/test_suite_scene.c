@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 void scene_get_first(void *scene) { scene_get_body(scene, 0); }
 void scene_remove_first(void *scene) { scene_remove_body(scene, 0); }
@@ -17,23 +18,6 @@ void test_empty_scene() {
   scene_free(scene);
 }
 
-list_t *make_shape() {
-  list_t *shape = list_init(4, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){-1, -1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, -1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+1, +1};
-  list_add(shape, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-1, +1};
-  list_add(shape, v);
-  return shape;
-}
-
 void test_scene() {
   // Build a scene with 3 bodies
   scene_t *scene = scene_init();
@@ -228,6 +212,464 @@ void test_reaping() {
   scene_free(scene);
 }
 
+int freed_forces = 0;
+
+void count_force_calls(int *calls) { (*calls)++; }
+
+void free_force_calls(int *calls) {
+  freed_forces++;
+  free(calls);
+}
+
+int *add_pair_force(scene_t *scene, body_t *body1, body_t *body2) {
+  int *calls = malloc(sizeof(*calls));
+  *calls = 0;
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, body1);
+  list_add(bodies, body2);
+  scene_add_bodies_force_creator(scene, (force_creator_t)count_force_calls,
+                                 calls, bodies, (free_func_t)free_force_calls);
+  return calls;
+}
+
+// Removing a body frees exactly the forces attached to it,
+// including forces added before the body joined the scene
+void test_force_cleanup() {
+  scene_t *scene = scene_init();
+  body_t *bodies[4];
+  for (int i = 0; i < 4; i++) {
+    bodies[i] = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  }
+  for (int i = 0; i < 3; i++) {
+    scene_add_body(scene, bodies[i]);
+  }
+  add_pair_force(scene, bodies[0], bodies[1]);
+  add_pair_force(scene, bodies[1], bodies[2]);
+  int *survivor = add_pair_force(scene, bodies[0], bodies[2]);
+  add_pair_force(scene, bodies[2], bodies[3]);
+  scene_add_body(scene, bodies[3]);
+
+  freed_forces = 0;
+  scene_tick(scene, 0);
+  assert(freed_forces == 0);
+  assert(*survivor == 1);
+
+  body_remove(bodies[1]);
+  scene_tick(scene, 0);
+  assert(freed_forces == 2);
+  assert(*survivor == 2);
+
+  body_remove(bodies[3]);
+  scene_tick(scene, 0);
+  assert(freed_forces == 3);
+  assert(*survivor == 3);
+
+  scene_free(scene);
+  assert(freed_forces == 4);
+}
+
+body_t *make_body_at(vector_t centroid) {
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body, centroid);
+  return body;
+}
+
+// Pair force creators only run while their bodies are close,
+// plus one tick after they separate
+void check_pair_force_creator(scene_t *scene) {
+  body_t *body1 = make_body_at((vector_t){0, 0});
+  body_t *body2 = make_body_at((vector_t){1000, 0});
+  scene_add_body(scene, body1);
+  scene_add_body(scene, body2);
+  int *calls = malloc(sizeof(*calls));
+  *calls = 0;
+  scene_add_pair_force_creator(scene, (force_creator_t)count_force_calls,
+                               calls, body1, body2, NULL);
+
+  scene_tick(scene, 0);
+  assert(*calls == 0);
+  body_set_centroid(body2, (vector_t){1, 0});
+  scene_tick(scene, 0);
+  scene_tick(scene, 0);
+  assert(*calls == 2);
+  body_set_centroid(body2, (vector_t){1000, 0});
+  scene_tick(scene, 0);
+  assert(*calls == 3);
+  scene_tick(scene, 0);
+  scene_tick(scene, 0);
+  assert(*calls == 3);
+
+  body_set_centroid(body2, (vector_t){1, 0});
+  scene_tick(scene, 0);
+  assert(*calls == 4);
+  body_remove(body1);
+  scene_tick(scene, 0);
+  assert(*calls == 5);
+  scene_tick(scene, 0);
+  assert(*calls == 5);
+  free(calls);
+  scene_free(scene);
+}
+
+void test_pair_force_creator() { check_pair_force_creator(scene_init()); }
+
+void test_sweep_and_prune_broadphase() {
+  check_pair_force_creator(
+      scene_init_with_broadphase(BROADPHASE_SWEEP_AND_PRUNE));
+}
+
+void count_layer_calls(body_t *body1, body_t *body2, int *calls) {
+  assert(body_get_collision_layer(body1) == 1);
+  assert(body_get_collision_layer(body2) == 2);
+  (*calls)++;
+}
+
+// Layer force creators run on every nearby pair of bodies on their layers,
+// including bodies added after they were registered
+void test_layer_force_creator() {
+  scene_t *scene = scene_init();
+  int *calls = malloc(sizeof(*calls));
+  *calls = 0;
+  scene_add_layer_force_creator(scene, 1, 2,
+                                (layer_force_creator_t)count_layer_calls,
+                                calls, free);
+  body_t *body1 = make_body_at((vector_t){0, 0});
+  body_t *body2 = make_body_at((vector_t){1, 0});
+  body_t *body3 = make_body_at((vector_t){0, 1});
+  body_set_collision_layer(body1, 1);
+  body_set_collision_layer(body2, 2);
+  body_set_collision_layer(body3, 3);
+  scene_add_body(scene, body2);
+  scene_add_body(scene, body1);
+  scene_add_body(scene, body3);
+  assert(scene_get_ticks(scene) == 0);
+  scene_tick(scene, 0);
+  assert(scene_get_ticks(scene) == 1);
+  assert(*calls == 1);
+
+  body_t *body4 = make_body_at((vector_t){1, 1});
+  body_set_collision_layer(body4, 2);
+  scene_add_body(scene, body4);
+  scene_tick(scene, 0);
+  assert(*calls == 3);
+  body_set_centroid(body1, (vector_t){1000, 0});
+  scene_tick(scene, 0);
+  assert(*calls == 3);
+  scene_free(scene);
+}
+
+// Bodies moved into the static tree still pair with moving bodies, and
+// bodies reusing a removed static body's slot are not static
+void test_static_tree() {
+  scene_t *scene = scene_init();
+  int *calls = malloc(sizeof(*calls));
+  *calls = 0;
+  scene_add_layer_force_creator(scene, 1, 2,
+                                (layer_force_creator_t)count_layer_calls,
+                                calls, free);
+  body_t *moving = make_body_at((vector_t){0, 0});
+  body_t *wall = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_t *far_wall = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_set_centroid(wall, (vector_t){1, 0});
+  body_set_centroid(far_wall, (vector_t){1000, 0});
+  body_set_collision_layer(moving, 1);
+  body_set_collision_layer(wall, 2);
+  body_set_collision_layer(far_wall, 2);
+  scene_add_body(scene, moving);
+  scene_add_body(scene, wall);
+  scene_add_body(scene, far_wall);
+  scene_build_static_tree(scene);
+  scene_tick(scene, 0);
+  assert(*calls == 1);
+
+  body_remove(wall);
+  scene_tick(scene, 0);
+  assert(*calls == 2);
+  body_t *replacement = make_body_at((vector_t){0, 1});
+  body_set_collision_layer(replacement, 2);
+  scene_add_body(scene, replacement);
+  body_set_velocity(replacement, (vector_t){1000, 0});
+  scene_tick(scene, 1);
+  assert(*calls == 3);
+  // The wall's old box in the tree must not stand in for the replacement
+  scene_tick(scene, 0);
+  assert(*calls == 3);
+  scene_free(scene);
+}
+
+// Handles keep resolving while other bodies come and go,
+// and stop resolving once their own body is freed
+void test_body_handles() {
+  scene_t *scene = scene_init();
+  body_t *bodies[5];
+  body_handle_t handles[5];
+  for (int i = 0; i < 5; i++) {
+    bodies[i] = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, bodies[i]);
+    handles[i] = body_get_handle(bodies[i]);
+    assert(scene_get_body_by_handle(scene, handles[i]) == bodies[i]);
+  }
+  assert(scene_get_body_by_handle(scene, BODY_HANDLE_NONE) == NULL);
+
+  body_remove(bodies[1]);
+  scene_tick(scene, 0);
+  assert(scene_bodies(scene) == 4);
+  assert(scene_get_body_by_handle(scene, handles[1]) == NULL);
+  for (int i = 0; i < 5; i++) {
+    if (i != 1) {
+      assert(scene_get_body_by_handle(scene, handles[i]) == bodies[i]);
+    }
+  }
+
+  // The freed slot is reused, but the old handle must not see the new body
+  body_t *replacement = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, replacement);
+  body_handle_t new_handle = body_get_handle(replacement);
+  assert(new_handle.index == handles[1].index);
+  assert(scene_get_body_by_handle(scene, handles[1]) == NULL);
+  assert(scene_get_body_by_handle(scene, new_handle) == replacement);
+  scene_free(scene);
+}
+
+typedef struct {
+  scene_t *scene;
+  body_t *body;
+  char order[16];
+  size_t count;
+} event_log_t;
+
+void log_a(body_t *body1, body_t *body2, vector_t axis, event_log_t *log) {
+  log->order[log->count++] = 'a';
+}
+
+void log_b(body_t *body1, body_t *body2, vector_t axis, event_log_t *log) {
+  log->order[log->count++] = 'b';
+}
+
+void log_c_and_queue_a(body_t *body1, body_t *body2, vector_t axis,
+                       event_log_t *log) {
+  log->order[log->count++] = 'c';
+  scene_queue_event(log->scene, (event_handler_t)log_a, body1, body2, axis,
+                    log);
+}
+
+void queue_events(event_log_t *log) {
+  event_handler_t handlers[] = {
+      (event_handler_t)log_b, (event_handler_t)log_a,
+      (event_handler_t)log_c_and_queue_a, (event_handler_t)log_b,
+      (event_handler_t)log_a};
+  for (size_t i = 0; i < sizeof(handlers) / sizeof(*handlers); i++) {
+    scene_queue_event(log->scene, handlers[i], log->body, log->body,
+                      VEC_ZERO, log);
+  }
+}
+
+// Events run after every force creator, batched by handler in the order
+// the handlers were first queued, with events queued by handlers last
+void test_event_queue() {
+  scene_t *scene = scene_init();
+  body_t *body = make_body_at(VEC_ZERO);
+  scene_add_body(scene, body);
+  event_log_t log = {.scene = scene, .body = body, .count = 0};
+  scene_add_force_creator(scene, (force_creator_t)queue_events, &log, NULL);
+  scene_tick(scene, 1);
+  log.order[log.count] = '\0';
+  assert(strcmp(log.order, "bbaaca") == 0);
+  scene_free(scene);
+}
+
+body_t *add_layer_body(scene_t *scene, vector_t centroid, double mass,
+                       size_t layer) {
+  body_t *body = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body, centroid);
+  body_set_collision_layer(body, layer);
+  scene_add_body(scene, body);
+  return body;
+}
+
+// Rays stop at the first body on their layers, whether it is in the static
+// tree or not, and ignore the body they start in
+void test_raycast() {
+  scene_t *scene = scene_init();
+  body_t *wall = add_layer_body(scene, (vector_t){10, 0}, INFINITY, 2);
+  body_t *far_wall = add_layer_body(scene, (vector_t){20, 0}, INFINITY, 3);
+  body_t *moving = add_layer_body(scene, (vector_t){15, 0}, 1, 1);
+  body_t *ball =
+      body_init_circle((vector_t){0, 10}, 2, 1, (rgb_color_t){0, 0, 0},
+                       NULL, NULL);
+  body_set_collision_layer(ball, 4);
+  scene_add_body(scene, ball);
+  scene_build_static_tree(scene);
+
+  ray_hit_t hit;
+  vector_t right = {2, 0};
+  assert(scene_raycast(scene, VEC_ZERO, right, 100, UINT32_MAX, &hit));
+  assert(hit.body == wall);
+  assert(isclose(hit.distance, 9));
+  assert(vec_isclose(hit.point, (vector_t){9, 0}));
+  assert(vec_isclose(hit.normal, (vector_t){-1, 0}));
+  assert(scene_raycast(scene, VEC_ZERO, right, 100, 1 << 1 | 1 << 3, &hit));
+  assert(hit.body == moving && isclose(hit.distance, 14));
+  assert(scene_raycast(scene, VEC_ZERO, right, 100, 1 << 3, &hit));
+  assert(hit.body == far_wall && isclose(hit.distance, 19));
+  assert(!scene_raycast(scene, VEC_ZERO, right, 8, UINT32_MAX, &hit));
+  assert(hit.body == NULL);
+
+  assert(scene_segment_query(scene, (vector_t){10, 0}, (vector_t){30, 0},
+                             UINT32_MAX, &hit));
+  assert(hit.body == moving && isclose(hit.distance, 4));
+  assert(scene_raycast(scene, VEC_ZERO, (vector_t){0, 1}, 100, UINT32_MAX,
+                       &hit));
+  assert(hit.body == ball && isclose(hit.distance, 8));
+  assert(vec_isclose(hit.normal, (vector_t){0, -1}));
+
+  body_remove(wall);
+  assert(scene_raycast(scene, VEC_ZERO, right, 100, UINT32_MAX, &hit));
+  assert(hit.body == moving);
+  scene_free(scene);
+}
+
+typedef struct {
+  body_t *bodies[4];
+  size_t count;
+} found_bodies_t;
+
+void collect_body(body_t *body, found_bodies_t *found) {
+  assert(found->count < 4);
+  found->bodies[found->count++] = body;
+}
+
+bool was_found(found_bodies_t *found, body_t *body) {
+  for (size_t i = 0; i < found->count; i++) {
+    if (found->bodies[i] == body) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Radius queries find bodies whose shapes reach into the circle, not just
+// their boxes, and box queries find bodies whose boxes overlap the box
+void test_region_queries() {
+  scene_t *scene = scene_init();
+  body_t *wall = add_layer_body(scene, (vector_t){10, 0}, INFINITY, 2);
+  body_t *moving = add_layer_body(scene, VEC_ZERO, 1, 1);
+  add_layer_body(scene, (vector_t){100, 100}, 1, 1);
+  body_t *ball =
+      body_init_circle((vector_t){0, 5}, 1, 1, (rgb_color_t){0, 0, 0}, NULL,
+                       NULL);
+  body_set_collision_layer(ball, 4);
+  scene_add_body(scene, ball);
+  scene_build_static_tree(scene);
+  body_visitor_t collect = (body_visitor_t)collect_body;
+
+  found_bodies_t found = {.count = 0};
+  assert(scene_query_radius(scene, VEC_ZERO, 3, UINT32_MAX, collect,
+                            &found) == 1);
+  assert(found.bodies[0] == moving);
+  found.count = 0;
+  assert(scene_query_radius(scene, VEC_ZERO, 8.5, UINT32_MAX, collect,
+                            &found) == 2);
+  assert(was_found(&found, moving) && was_found(&found, ball));
+  found.count = 0;
+  assert(scene_query_radius(scene, VEC_ZERO, 8.5, 1 << 4, collect, &found) ==
+         1);
+  assert(found.bodies[0] == ball);
+  // The circle's box reaches the wall, but the circle misses its corner
+  found.count = 0;
+  assert(scene_query_radius(scene, (vector_t){6, 3}, 3.2, UINT32_MAX, collect,
+                            &found) == 0);
+  aabb_t box = {.min = {2.8, -0.2}, .max = {9.2, 6.2}};
+  assert(scene_query_aabb(scene, box, UINT32_MAX, collect, &found) == 1);
+  assert(found.bodies[0] == wall);
+
+  body_remove(wall);
+  found.count = 0;
+  assert(scene_query_aabb(scene, box, UINT32_MAX, collect, &found) == 0);
+  scene_free(scene);
+}
+
+// Queries and rays find moving bodies where they are now with either
+// broadphase, after they move and as soon as they are added
+void test_region_queries_follow_bodies() {
+  broadphase_t broadphases[] = {BROADPHASE_GRID, BROADPHASE_SWEEP_AND_PRUNE};
+  for (size_t i = 0; i < 2; i++) {
+    scene_t *scene = scene_init_with_broadphase(broadphases[i]);
+    body_t *moving = add_layer_body(scene, VEC_ZERO, 1, 1);
+    body_set_velocity(moving, (vector_t){500, 0});
+    body_visitor_t collect = (body_visitor_t)collect_body;
+    found_bodies_t found = {.count = 0};
+    assert(scene_query_radius(scene, VEC_ZERO, 2, UINT32_MAX, collect,
+                              &found) == 1);
+
+    scene_tick(scene, 1);
+    found.count = 0;
+    assert(scene_query_radius(scene, VEC_ZERO, 2, UINT32_MAX, collect,
+                              &found) == 0);
+    assert(scene_query_radius(scene, (vector_t){500, 0}, 2, UINT32_MAX,
+                              collect, &found) == 1);
+    assert(found.bodies[0] == moving);
+    ray_hit_t hit;
+    assert(scene_raycast(scene, (vector_t){-100, 0}, (vector_t){1, 0}, 1000,
+                         UINT32_MAX, &hit));
+    assert(hit.body == moving && isclose(hit.distance, 599));
+    body_t *added = add_layer_body(scene, VEC_ZERO, 1, 1);
+    found.count = 0;
+    assert(scene_query_radius(scene, VEC_ZERO, 2, UINT32_MAX, collect,
+                              &found) == 1);
+    assert(found.bodies[0] == added);
+    scene_free(scene);
+  }
+}
+
+body_t *add_tagged_body(scene_t *scene, body_tag_t tag) {
+  body_t *body = make_body_at(VEC_ZERO);
+  body_set_tag(body, tag);
+  scene_add_body(scene, body);
+  return body;
+}
+
+bool view_contains(body_view_t view, body_t *body) {
+  for (size_t i = 0; i < view.size; i++) {
+    if (view.bodies[i] == body) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Tag buckets follow bodies as they are added and released, without
+// rescanning the scene
+void test_tag_buckets() {
+  scene_t *scene = scene_init();
+  body_t *enemies[3];
+  for (size_t i = 0; i < 3; i++) {
+    enemies[i] = add_tagged_body(scene, comp_info_tag(ENEMY));
+  }
+  body_t *bullet = add_tagged_body(scene, bullet_info_tag(PISTOL_BULLET));
+  // Tags of different kinds do not mix even when their subtypes match
+  add_tagged_body(scene, (body_tag_t){.kind = BULLET_TAG, .subtype = ENEMY});
+  scene_add_body(scene, make_body_at(VEC_ZERO));
+  assert(scene_bodies_with_comp_info(scene, ENEMY).size == 3);
+  assert(scene_bodies_with_bullet_info(scene, PISTOL_BULLET).size == 1);
+  assert(scene_bodies_with_bullet_info(scene, PISTOL_BULLET).bodies[0] ==
+         bullet);
+  body_view_t shields = scene_bodies_with_comp_info(scene, SHIELD);
+  assert(shields.size == 0 && shields.bodies == NULL);
+
+  body_remove(enemies[0]);
+  body_remove(bullet);
+  scene_tick(scene, 0);
+  body_t *enemy = add_tagged_body(scene, comp_info_tag(ENEMY));
+  body_view_t view = scene_bodies_with_comp_info(scene, ENEMY);
+  assert(view.size == 3);
+  assert(view_contains(view, enemies[1]) && view_contains(view, enemies[2]));
+  assert(view_contains(view, enemy));
+  assert(scene_bodies_with_bullet_info(scene, PISTOL_BULLET).size == 0);
+  assert(scene_bodies(scene) == 5);
+  scene_free(scene);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -242,6 +684,17 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_force_creator)
   DO_TEST(test_force_creator_aux)
   DO_TEST(test_reaping)
+  DO_TEST(test_body_handles)
+  DO_TEST(test_force_cleanup)
+  DO_TEST(test_pair_force_creator)
+  DO_TEST(test_sweep_and_prune_broadphase)
+  DO_TEST(test_layer_force_creator)
+  DO_TEST(test_static_tree)
+  DO_TEST(test_event_queue)
+  DO_TEST(test_raycast)
+  DO_TEST(test_region_queries)
+  DO_TEST(test_region_queries_follow_bodies)
+  DO_TEST(test_tag_buckets)
 
   puts("scene_test PASS");
 }
@@ -0,0 +1,85 @@
+#include "spatial_grid.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define BOXES 200
+
+const aabb_t BOX_AREA = {.min = {-1000, -500}, .max = {1000, 500}};
+const aabb_t QUERY_AREA = {.min = {-1200, -600}, .max = {1200, 600}};
+
+// The grid reports exactly the overlapping pairs, each one once,
+// including boxes spanning several cells and boxes too large for the grid
+void test_matches_brute_force() {
+  srand(3);
+  aabb_t boxes[BOXES];
+  random_boxes(boxes, BOXES, BOX_AREA, 120);
+
+  spatial_grid_t *grid = spatial_grid_init(50);
+  for (int round = 0; round < 2; round++) {
+    spatial_grid_clear(grid);
+    for (size_t i = 0; i < BOXES; i++) {
+      spatial_grid_insert(grid, i, boxes[i]);
+    }
+    pair_counts_t *counts = calloc(1, sizeof(pair_counts_t));
+    spatial_grid_find_pairs(grid, (grid_pair_handler_t)count_pair, counts);
+    check_pair_counts(counts, boxes, NULL, BOXES);
+    free(counts);
+  }
+  spatial_grid_free(grid);
+}
+
+void query_grid(spatial_grid_t *grid, aabb_t box, hit_counts_t *counts) {
+  spatial_grid_query(grid, box, (grid_hit_handler_t)count_hit, counts);
+}
+
+void query_grid_segment(spatial_grid_t *grid, vector_t start, vector_t end,
+                        segment_hits_t *hits) {
+  spatial_grid_query_segment(grid, start, end,
+                             (grid_segment_handler_t)count_segment_hit, hits);
+}
+
+// Box queries report each overlapping box once, whether the query covers a
+// few cells, more cells than the grid has occupied, or misses every cell,
+// and segment queries find the boxes along them across any number of cells
+void test_queries_match_brute_force() {
+  srand(5);
+  aabb_t boxes[BOXES];
+  random_boxes(boxes, BOXES, BOX_AREA, 120);
+  spatial_grid_t *grid = spatial_grid_init(50);
+  for (size_t i = 0; i < BOXES; i++) {
+    spatial_grid_insert(grid, i, boxes[i]);
+  }
+  check_box_queries(grid, (box_query_t)query_grid, boxes, BOXES, QUERY_AREA,
+                    100);
+  check_segment_queries(grid, (segment_query_t)query_grid_segment, boxes,
+                        BOXES, QUERY_AREA, 200);
+  spatial_grid_free(grid);
+}
+
+void test_empty_grid() {
+  spatial_grid_t *grid = spatial_grid_init(10);
+  pair_counts_t *counts = calloc(1, sizeof(pair_counts_t));
+  spatial_grid_find_pairs(grid, (grid_pair_handler_t)count_pair, counts);
+  spatial_grid_insert(grid, 0, (aabb_t){.min = {0, 0}, .max = {1, 1}});
+  spatial_grid_find_pairs(grid, (grid_pair_handler_t)count_pair, counts);
+  assert(counts->counts[0][0] == 0);
+  free(counts);
+  spatial_grid_free(grid);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_matches_brute_force)
+  DO_TEST(test_queries_match_brute_force)
+  DO_TEST(test_empty_grid)
+
+  puts("spatial_grid_test PASS");
+}
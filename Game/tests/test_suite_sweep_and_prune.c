@@ -0,0 +1,94 @@
+#include "sweep_and_prune.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define BOXES 200
+
+const aabb_t BOX_AREA = {.min = {0, 0}, .max = {2000, 1000}};
+const aabb_t QUERY_AREA = {.min = {-100, -100}, .max = {2100, 1100}};
+
+// Each round reports exactly the overlapping pairs among the boxes inserted
+// that round, as boxes move, leave and come back
+void test_matches_brute_force() {
+  srand(7);
+  aabb_t boxes[BOXES];
+  bool present[BOXES];
+  random_boxes(boxes, BOXES, BOX_AREA, 100);
+
+  sweep_and_prune_t *sap = sweep_and_prune_init();
+  for (int round = 0; round < 10; round++) {
+    for (size_t i = 0; i < BOXES; i++) {
+      vector_t move = {random_between(-20, 20), random_between(-20, 20)};
+      boxes[i].min = vec_add(boxes[i].min, move);
+      boxes[i].max = vec_add(boxes[i].max, move);
+      present[i] = (i + round) % 7 != 0;
+      if (present[i]) {
+        sweep_and_prune_insert(sap, i, boxes[i]);
+      }
+    }
+    pair_counts_t *counts = calloc(1, sizeof(pair_counts_t));
+    sweep_and_prune_find_pairs(sap, (sweep_pair_handler_t)count_pair, counts);
+    check_pair_counts(counts, boxes, present, BOXES);
+    free(counts);
+  }
+  sweep_and_prune_free(sap);
+}
+
+void query_sap(sweep_and_prune_t *sap, aabb_t box, hit_counts_t *counts) {
+  sweep_and_prune_query(sap, box, (sweep_hit_handler_t)count_hit, counts);
+}
+
+void query_sap_segment(sweep_and_prune_t *sap, vector_t start, vector_t end,
+                       segment_hits_t *hits) {
+  sweep_and_prune_query_segment(
+      sap, start, end, (sweep_segment_handler_t)count_segment_hit, hits);
+}
+
+// Box and segment queries see the boxes as of the last round
+void test_queries_match_brute_force() {
+  srand(11);
+  aabb_t boxes[BOXES];
+  random_boxes(boxes, BOXES, BOX_AREA, 100);
+  sweep_and_prune_t *sap = sweep_and_prune_init();
+  for (size_t i = 0; i < BOXES; i++) {
+    sweep_and_prune_insert(sap, i, boxes[i]);
+  }
+  sweep_and_prune_commit(sap);
+  check_box_queries(sap, (box_query_t)query_sap, boxes, BOXES, QUERY_AREA,
+                    100);
+  check_segment_queries(sap, (segment_query_t)query_sap_segment, boxes, BOXES,
+                        QUERY_AREA, 200);
+  sweep_and_prune_free(sap);
+}
+
+// Boxes are only reported in rounds they were inserted in
+void test_empty_round() {
+  sweep_and_prune_t *sap = sweep_and_prune_init();
+  pair_counts_t *counts = calloc(1, sizeof(pair_counts_t));
+  sweep_and_prune_find_pairs(sap, (sweep_pair_handler_t)count_pair, counts);
+  sweep_and_prune_insert(sap, 0, (aabb_t){.min = {0, 0}, .max = {1, 1}});
+  sweep_and_prune_insert(sap, 1, (aabb_t){.min = {0, 0}, .max = {1, 1}});
+  sweep_and_prune_find_pairs(sap, (sweep_pair_handler_t)count_pair, counts);
+  assert(counts->counts[0][1] == 1);
+  sweep_and_prune_find_pairs(sap, (sweep_pair_handler_t)count_pair, counts);
+  assert(counts->counts[0][1] == 1);
+  free(counts);
+  sweep_and_prune_free(sap);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_matches_brute_force)
+  DO_TEST(test_queries_match_brute_force)
+  DO_TEST(test_empty_round)
+
+  puts("sweep_and_prune_test PASS");
+}
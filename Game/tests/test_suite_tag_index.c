@@ -0,0 +1,72 @@
+#include "tag_index.h"
+#include "test_util.h"
+#include <assert.h>
+
+#define BODIES 6
+
+const body_tag_t RED_TAG = {.kind = 1, .subtype = 0};
+const body_tag_t BLUE_TAG = {.kind = 1, .subtype = 1};
+
+bool view_contains(body_view_t view, body_t *body) {
+  for (size_t i = 0; i < view.size; i++) {
+    if (view.bodies[i] == body) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Bodies are grouped by tag, untagged bodies are left out, and removing a
+// body keeps the rest of its bucket findable
+void test_buckets_by_tag() {
+  tag_index_t *index = tag_index_init();
+  body_t *bodies[BODIES];
+  for (size_t i = 0; i < BODIES; i++) {
+    bodies[i] = make_box_body((vector_t){10.0 * i, 0}, 2, 2, 1);
+    body_set_handle(bodies[i],
+                    (body_handle_t){.index = 20 - 3 * i, .generation = 1});
+    if (i < 4) {
+      body_set_tag(bodies[i], i % 2 == 0 ? RED_TAG : BLUE_TAG);
+    }
+    tag_index_add(index, bodies[i]);
+  }
+  assert(tag_index_get(index, RED_TAG).size == 2);
+  assert(tag_index_get(index, BLUE_TAG).size == 2);
+  assert(tag_index_get(index, (body_tag_t){.kind = 2, .subtype = 0}).size ==
+         0);
+
+  // Removing the first body moves the last one into its place
+  body_set_tag(bodies[4], RED_TAG);
+  tag_index_add(index, bodies[4]);
+  tag_index_remove(index, bodies[0]);
+  body_view_t red = tag_index_get(index, RED_TAG);
+  assert(red.size == 2);
+  assert(red.bodies[0] == bodies[4]);
+  assert(view_contains(red, bodies[2]));
+  tag_index_remove(index, bodies[4]);
+  tag_index_remove(index, bodies[5]);
+  red = tag_index_get(index, RED_TAG);
+  assert(red.size == 1 && red.bodies[0] == bodies[2]);
+  tag_index_remove(index, bodies[2]);
+  assert(tag_index_get(index, RED_TAG).size == 0);
+  assert(view_contains(tag_index_get(index, BLUE_TAG), bodies[3]));
+
+  tag_index_free(index);
+  for (size_t i = 0; i < BODIES; i++) {
+    body_free(bodies[i]);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests? True if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_buckets_by_tag)
+
+  puts("tag_index_test PASS");
+}